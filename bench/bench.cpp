@@ -0,0 +1,144 @@
+#include "bench.hpp"
+#include "definitions/packet_key.hpp"
+#include <arpa/inet.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <new>
+
+namespace {
+
+std::atomic<uint64_t> alloc_count{0};
+std::atomic<uint64_t> alloc_bytes{0};
+
+void* counted_alloc(size_t size) {
+    alloc_count.fetch_add(1, std::memory_order_relaxed);
+    alloc_bytes.fetch_add(size, std::memory_order_relaxed);
+    if (void* ptr = std::malloc(size ? size : 1)) return ptr;
+    throw std::bad_alloc();
+}
+
+constexpr size_t ETHER_HEADER_LEN = 14;
+
+} // namespace
+
+void* operator new(size_t size) { return counted_alloc(size); }
+void* operator new[](size_t size) { return counted_alloc(size); }
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { std::free(ptr); }
+
+BenchAllocStats bench_alloc_stats() {
+    return {alloc_count.load(std::memory_order_relaxed), alloc_bytes.load(std::memory_order_relaxed)};
+}
+
+bool Bench::wants(const std::string& name) const {
+    return options_.filter.empty() || name.find(options_.filter) != std::string::npos;
+}
+
+void Bench::print_header() const {
+    if (options_.csv) {
+        std::printf("name,ns_per_op,allocs_per_op,alloc_bytes_per_op,ops_per_sec,mb_per_sec\n");
+    } else {
+        std::printf("%-36s %12s %11s %11s %12s %10s\n",
+                    "benchmark", "ns/op", "allocs/op", "B/op", "ops/s", "MB/s");
+    }
+}
+
+void Bench::run(const std::string& name, uint64_t ops, uint64_t bytes,
+                const std::function<void()>& body, const std::function<void()>& between) {
+    if (!wants(name)) return;
+
+    // Warm caches and lazily built state
+    body();
+    if (between) between();
+
+    using Clock = std::chrono::steady_clock;
+    const auto min_time = std::chrono::milliseconds(options_.min_time_ms);
+    Clock::duration elapsed{0};
+    uint64_t batches = 0;
+    uint64_t allocs = 0;
+    uint64_t allocated = 0;
+    while (batches == 0 || elapsed < min_time) {
+        BenchAllocStats before = bench_alloc_stats();
+        auto start = Clock::now();
+        body();
+        elapsed += Clock::now() - start;
+        BenchAllocStats after = bench_alloc_stats();
+        allocs += after.count - before.count;
+        allocated += after.bytes - before.bytes;
+        if (between) between();
+        ++batches;
+    }
+
+    double total_ops = static_cast<double>(batches * ops);
+    double seconds = std::chrono::duration<double>(elapsed).count();
+    double ns_per_op = seconds * 1e9 / total_ops;
+    double ops_per_sec = total_ops / seconds;
+    double mb_per_sec = bytes ? batches * bytes / seconds / 1e6 : 0.0;
+    const char* format = options_.csv ? "%s,%.1f,%.2f,%.0f,%.0f,%.1f\n"
+                                      : "%-36s %12.1f %11.2f %11.0f %12.0f %10.1f\n";
+    std::printf(format, name.c_str(), ns_per_op, allocs / total_ops, allocated / total_ops,
+                ops_per_sec, mb_per_sec);
+    std::fflush(stdout);
+}
+
+std::vector<uint8_t> make_tcp_frame(uint32_t src_ip, uint16_t src_port, uint32_t dst_ip, uint16_t dst_port,
+                                    uint32_t seq, uint8_t flags, size_t payload_len) {
+    std::vector<uint8_t> frame(ETHER_HEADER_LEN + sizeof(IPHeader) + sizeof(TCPHeader) + payload_len);
+    frame[12] = 0x08;  // EtherType IPv4
+
+    auto* ip = reinterpret_cast<IPHeader*>(frame.data() + ETHER_HEADER_LEN);
+    ip->iph_ver = 4;
+    ip->iph_ihl = sizeof(IPHeader) / 4;
+    ip->iph_len = htons(static_cast<uint16_t>(sizeof(IPHeader) + sizeof(TCPHeader) + payload_len));
+    ip->iph_ttl = 64;
+    ip->iph_protocol = IPPROTO_TCP;
+    ip->iph_source = htonl(src_ip);
+    ip->iph_dest = htonl(dst_ip);
+
+    auto* tcp = reinterpret_cast<TCPHeader*>(frame.data() + ETHER_HEADER_LEN + sizeof(IPHeader));
+    tcp->th_sport = htons(src_port);
+    tcp->th_dport = htons(dst_port);
+    tcp->th_seq = htonl(seq);
+    tcp->th_off = sizeof(TCPHeader) / 4;
+    tcp->th_flags = flags;
+    tcp->th_win = htons(65535);
+
+    std::memset(frame.data() + frame.size() - payload_len, 'x', payload_len);
+    return frame;
+}
+
+static void print_usage(const char* program) {
+    std::cerr << "Usage: " << program << " [-f FILTER] [-t MIN_TIME_MS] [-n MAX_FLOWS] [--csv]" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    Bench::Options options;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "-f") == 0 && i + 1 < argc) {
+            options.filter = argv[++i];
+        } else if (std::strcmp(argv[i], "-t") == 0 && i + 1 < argc) {
+            options.min_time_ms = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            options.max_flows = std::strtoul(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--csv") == 0) {
+            options.csv = true;
+        } else {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+
+    Bench bench(options);
+    bench.print_header();
+    run_conn_benches(bench);
+    run_reassm_benches(bench);
+    run_tls_benches(bench);
+    run_log_benches(bench);
+    return 0;
+}
@@ -0,0 +1,61 @@
+#ifndef BENCH_HPP
+#define BENCH_HPP
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Microbenchmark harness of tcp_tracker_bench. A case runs a batch body
+// repeatedly until a minimum time has passed and reports ns/op, heap
+// allocations/op and throughput. Allocations are counted by the global
+// operator new of the bench binary, on every thread.
+class Bench {
+public:
+    struct Options {
+        std::string filter;        // Run only cases whose name contains it
+        int min_time_ms = 200;     // Per case
+        size_t max_flows = 1000000;
+        bool csv = false;
+    };
+
+    explicit Bench(const Options& options) : options_(options) {}
+
+    bool wants(const std::string& name) const;
+    size_t max_flows() const { return options_.max_flows; }
+
+    // body performs ops operations covering bytes payload bytes (0 if the
+    // case has no byte throughput); between runs untimed after each batch
+    void run(const std::string& name, uint64_t ops, uint64_t bytes,
+             const std::function<void()>& body, const std::function<void()>& between = nullptr);
+
+    void print_header() const;
+
+private:
+    Options options_;
+};
+
+// Heap allocations made so far by the process
+struct BenchAllocStats {
+    uint64_t count;
+    uint64_t bytes;
+};
+BenchAllocStats bench_alloc_stats();
+
+// Keeps the compiler from discarding a computed value
+template <typename T>
+inline void bench_keep(const T& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+// Ethernet + IPv4 + TCP frame without options; addresses in host order
+std::vector<uint8_t> make_tcp_frame(uint32_t src_ip, uint16_t src_port, uint32_t dst_ip, uint16_t dst_port,
+                                    uint32_t seq, uint8_t flags, size_t payload_len);
+
+// Suites, one per component
+void run_conn_benches(Bench& bench);
+void run_reassm_benches(Bench& bench);
+void run_tls_benches(Bench& bench);
+void run_log_benches(Bench& bench);
+
+#endif // BENCH_HPP
@@ -0,0 +1,128 @@
+#include "bench.hpp"
+#include "conn/connection_manager.hpp"
+#include "conn/packet_processor.hpp"
+#include <netinet/tcp.h>
+#include <pcap.h>
+#include <algorithm>
+#include <numeric>
+#include <random>
+
+namespace {
+
+constexpr uint32_t CLIENT_NET = 0x0a000000;  // 10.0.0.0/8
+constexpr uint32_t SERVER_IP = 0xc0a80001;   // 192.168.0.1
+constexpr uint16_t SERVER_PORT = 443;
+constexpr size_t BATCH = 1024;
+
+// Flow i: a distinct client address and port towards one server
+uint32_t client_ip(size_t i) { return CLIENT_NET + 1 + static_cast<uint32_t>(i / 50000); }
+uint16_t client_port(size_t i) { return static_cast<uint16_t>(10000 + i % 50000); }
+
+std::vector<std::vector<uint8_t>> make_frames(size_t flows, uint8_t flags, size_t payload_len) {
+    std::vector<std::vector<uint8_t>> frames;
+    frames.reserve(flows);
+    for (size_t i = 0; i < flows; ++i) {
+        frames.push_back(make_tcp_frame(client_ip(i), client_port(i), SERVER_IP, SERVER_PORT,
+                                        1000, flags, payload_len));
+    }
+    return frames;
+}
+
+void bench_decode(Bench& bench, ConnectionManager& conn_manager) {
+    PacketProcessor processor(conn_manager);
+    auto frames = make_frames(BATCH, TH_ACK, 512);
+    uint64_t bytes = 0;
+    for (const auto& frame : frames) bytes += frame.size();
+
+    bench.run("decode/validate+extract_packet", BATCH, bytes, [&] {
+        ConnectionKey key;
+        PacketKey pkey;
+        for (const auto& frame : frames) {
+            pcap_pkthdr header{};
+            header.caplen = header.len = static_cast<bpf_u_int32>(frame.size());
+            bool ok = processor.validate_packet(&header, frame.data()) &&
+                      processor.extract_packet(frame.data(), frame.size(), key, pkey);
+            bench_keep(ok);
+        }
+    });
+}
+
+void bench_key(Bench& bench) {
+    std::vector<ConnectionKey> keys;
+    for (size_t i = 0; i < BATCH; ++i) {
+        keys.emplace_back("10.0.0." + std::to_string(1 + i % 250), client_port(i), "192.168.0.1", SERVER_PORT);
+    }
+    std::vector<ConnectionKey> reversed;
+    for (const auto& key : keys) reversed.push_back(!key);
+
+    std::hash<ConnectionKey> hasher;
+    bench.run("key/hash", BATCH, 0, [&] {
+        for (const auto& key : keys) bench_keep(hasher(key));
+    });
+    bench.run("key/equal_direct", BATCH, 0, [&] {
+        for (const auto& key : keys) bench_keep(key == key);
+    });
+    bench.run("key/equal_reverse", BATCH, 0, [&] {
+        for (size_t i = 0; i < BATCH; ++i) bench_keep(keys[i] == reversed[i]);
+    });
+    bench.run("key/equal_mismatch", BATCH, 0, [&] {
+        for (size_t i = 0; i < BATCH; ++i) bench_keep(keys[i] == keys[(i + 1) % BATCH]);
+    });
+}
+
+// Steady-state lookups: every flow is opened with a SYN and acknowledged
+// once up front, then the timed batches send pure ACKs in random order
+void bench_process_packet(Bench& bench, size_t flows) {
+    std::string name = "conn/process_packet/" + std::to_string(flows / 1000) + "K";
+    if (!bench.wants(name) || flows > bench.max_flows()) return;
+
+    ConnectionManager conn_manager(1);
+    PacketProcessor decoder(conn_manager);
+    struct Decoded {
+        std::vector<uint8_t> frame;
+        ConnectionKey key;
+        PacketKey pkey;
+    };
+    auto decode = [&](std::vector<std::vector<uint8_t>> frames) {
+        std::vector<Decoded> decoded(frames.size());
+        for (size_t i = 0; i < frames.size(); ++i) {
+            decoded[i].frame = std::move(frames[i]);
+            decoder.extract_packet(decoded[i].frame.data(), decoded[i].frame.size(),
+                                   decoded[i].key, decoded[i].pkey);
+        }
+        return decoded;
+    };
+
+    for (const auto& syn : decode(make_frames(flows, TH_SYN, 0))) {
+        conn_manager.process_packet(syn.key, syn.pkey);
+    }
+    auto acks = decode(make_frames(flows, TH_ACK, 0));
+    for (const auto& ack : acks) {
+        conn_manager.process_packet(ack.key, ack.pkey);
+    }
+    std::vector<size_t> order(flows);
+    std::iota(order.begin(), order.end(), 0);
+    std::shuffle(order.begin(), order.end(), std::mt19937(42));
+
+    size_t next = 0;
+    bench.run(name, BATCH, 0, [&] {
+        for (size_t i = 0; i < BATCH; ++i) {
+            const Decoded& ack = acks[order[next]];
+            conn_manager.process_packet(ack.key, ack.pkey);
+            next = next + 1 < flows ? next + 1 : 0;
+        }
+    });
+}
+
+} // namespace
+
+void run_conn_benches(Bench& bench) {
+    {
+        ConnectionManager conn_manager(1);
+        bench_decode(bench, conn_manager);
+    }
+    bench_key(bench);
+    for (size_t flows : {10000, 100000, 1000000}) {
+        bench_process_packet(bench, flows);
+    }
+}
@@ -0,0 +1,62 @@
+#include "bench.hpp"
+#include "conn/packet_processor.hpp"
+#include "log/log.hpp"
+#include "log/packet_log_entry.hpp"
+#include <climits>
+#include <cstdio>
+
+namespace {
+
+constexpr size_t BATCH = 1000;
+constexpr const char* LOG_FILE = "tcp_tracker_bench.log";
+
+} // namespace
+
+void run_log_benches(Bench& bench) {
+    if (!bench.wants("log/")) return;
+
+    auto frame = make_tcp_frame(0x0a000001, 40000, 0xc0a80001, 443, 1000, 0x10, 0);
+    ConnectionKey key("10.0.0.1", 40000, "192.168.0.1", 443);
+    PacketKey pkey;
+    {
+        ConnectionManager conn_manager(1);
+        PacketProcessor(conn_manager).extract_packet(frame.data(), frame.size(), key, pkey);
+    }
+
+    {
+        // Buffering only; the flush between batches is not timed
+        FlushPolicy policy;
+        policy.max_updates = INT_MAX;
+        Log log(LOG_FILE, true, false, policy);
+        bench.run("log/log", BATCH, 0, [&] {
+            for (size_t i = 0; i < BATCH; ++i) {
+                log.log(std::make_shared<PacketLogEntry>(key, pkey));
+            }
+        }, [&] { log.flush(); });
+    }
+
+    {
+        // Formatting and writing BATCH buffered entries
+        FlushPolicy policy;
+        policy.max_updates = INT_MAX;
+        Log log(LOG_FILE, true, false, policy);
+        auto fill = [&] {
+            for (size_t i = 0; i < BATCH; ++i) {
+                log.log(std::make_shared<PacketLogEntry>(key, pkey));
+            }
+        };
+        fill();
+        bench.run("log/flush", BATCH, 0, [&] { log.flush(); }, fill);
+    }
+
+    {
+        // The default policy, flushing every 1000 updates inline
+        Log log(LOG_FILE, true, false);
+        bench.run("log/log_with_flush", BATCH, 0, [&] {
+            for (size_t i = 0; i < BATCH; ++i) {
+                log.log(std::make_shared<PacketLogEntry>(key, pkey));
+            }
+        });
+    }
+    std::remove(LOG_FILE);
+}
@@ -0,0 +1,74 @@
+#include "bench.hpp"
+#include "reassm/reassembly.hpp"
+
+namespace {
+
+constexpr size_t BATCH = 1024;
+constexpr size_t MSS = 1460;
+
+// Takes everything, so reassembly never goes idle
+class SinkAnalyzer : public IProtocolAnalyzer {
+public:
+    ParseHint on_data(Direction, const uint8_t* data, size_t len) override {
+        bench_keep(data);
+        bytes_ += len;
+        return ParseHint::more();
+    }
+
+private:
+    uint64_t bytes_ = 0;
+};
+
+// Each batch continues the stream where the previous one stopped
+struct Stream {
+    ConnectionKey key{"10.0.0.1", 40000, "192.168.0.1", 443};
+    ConnInfo info;
+    ConnSummary summary;
+    ProtocolHandler handler{info, summary};
+    Reassembly reassembly{key, Direction::CLIENT_TO_SERVER, handler};
+    std::vector<uint8_t> payload = std::vector<uint8_t>(2 * MSS, 'x');
+    uint32_t next = 1;
+
+    Stream() {
+        info.key = &key;
+        handler.add_analyzer(std::make_shared<SinkAnalyzer>());
+        reassembly.set_initial_seq(next);
+    }
+
+    void send(uint32_t seq, size_t len) {
+        reassembly.process(seq, payload.data(), len, false, false);
+    }
+};
+
+} // namespace
+
+void run_reassm_benches(Bench& bench) {
+    const uint64_t bytes = BATCH * MSS;
+
+    Stream in_order;
+    bench.run("reassm/process_in_order", BATCH, bytes, [&] {
+        for (size_t i = 0; i < BATCH; ++i) {
+            in_order.send(in_order.next, MSS);
+            in_order.next += MSS;
+        }
+    });
+
+    // Every second segment arrives one early and is buffered
+    Stream reordered;
+    bench.run("reassm/process_reordered", BATCH, bytes, [&] {
+        for (size_t i = 0; i < BATCH; i += 2) {
+            reordered.send(reordered.next + MSS, MSS);
+            reordered.send(reordered.next, MSS);
+            reordered.next += 2 * MSS;
+        }
+    });
+
+    // Each segment repeats the second half of the one before it
+    Stream overlapping;
+    bench.run("reassm/process_overlapping", BATCH, bytes, [&] {
+        for (size_t i = 0; i < BATCH; ++i) {
+            overlapping.send(overlapping.next - MSS / 2, MSS + MSS / 2);
+            overlapping.next += MSS;
+        }
+    });
+}
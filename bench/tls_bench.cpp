@@ -0,0 +1,51 @@
+#include "bench.hpp"
+#include "tls/tls_event_sink.hpp"
+#include "tls/tls_recorder.hpp"
+
+namespace {
+
+constexpr size_t RECORDS = 64;
+constexpr size_t TLS_HEADER_LEN = 5;
+
+// RECORDS application data records of fragment_len bytes, back to back
+std::vector<uint8_t> make_records(size_t fragment_len) {
+    std::vector<uint8_t> data;
+    for (size_t i = 0; i < RECORDS; ++i) {
+        data.push_back(static_cast<uint8_t>(TLSContentType::APPLICATION_DATA));
+        data.push_back(0x03);
+        data.push_back(0x03);
+        data.push_back(static_cast<uint8_t>(fragment_len >> 8));
+        data.push_back(static_cast<uint8_t>(fragment_len & 0xff));
+        data.insert(data.end(), fragment_len, 0x17);
+    }
+    return data;
+}
+
+void bench_records(Bench& bench, size_t fragment_len, size_t chunk_len) {
+    auto data = make_records(fragment_len);
+    TLSRecorder<NullTLSSink> recorder{NullTLSSink()};
+    TLSContentType type;
+    const uint8_t* fragment;
+    size_t len;
+
+    std::string name = "tls/try_extract_record/" + std::to_string(fragment_len) + "B" +
+                       (chunk_len < data.size() ? "/chunked" : "");
+    bench.run(name, RECORDS, RECORDS * (TLS_HEADER_LEN + fragment_len), [&] {
+        // Data arrives in chunks the size of TCP segments, records are
+        // pulled after each one as the analyzer does
+        size_t extracted = 0;
+        for (size_t offset = 0; offset < data.size(); offset += chunk_len) {
+            recorder.add_data(data.data() + offset, std::min(chunk_len, data.size() - offset));
+            while (recorder.try_extract_record(type, fragment, len)) ++extracted;
+        }
+        bench_keep(extracted);
+    });
+}
+
+} // namespace
+
+void run_tls_benches(Bench& bench) {
+    bench_records(bench, 256, SIZE_MAX);
+    bench_records(bench, 16384, SIZE_MAX);
+    bench_records(bench, 16384, 1460);
+}
@@ -0,0 +1,27 @@
+#ifndef STREAM_CAPTURE_ANALYZER_HPP
+#define STREAM_CAPTURE_ANALYZER_HPP
+
+#include "interfaces/protocol_analyzer.hpp"
+#include "capture/stream_writer.hpp"
+#include <array>
+
+// Writes the raw reassembled bytes of each direction through StreamWriter,
+// for forensic capture of the flows the port policy selects. Finishes at
+// once when StreamWriter is not running.
+class StreamCaptureAnalyzer : public IProtocolAnalyzer {
+public:
+    // Closes streams that never saw on_close
+    ~StreamCaptureAnalyzer() override;
+
+    void on_open(const ConnInfo& info) override { info_ = &info; }
+    ParseHint on_data(Direction dir, const uint8_t* data, size_t len) override;
+    void on_close(const ConnSummary& summary) override;
+
+private:
+    void close_streams();
+
+    const ConnInfo* info_ = nullptr;
+    std::array<StreamWriter::Stream, 2> streams_;  // Indexed by Direction, opened on first data
+};
+
+#endif // STREAM_CAPTURE_ANALYZER_HPP
@@ -0,0 +1,143 @@
+#ifndef STREAM_WRITER_HPP
+#define STREAM_WRITER_HPP
+
+#include "definitions/conn_info.hpp"
+#include "definitions/direction.hpp"
+#include <sys/uio.h>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <list>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// One record of STREAM_INDEX_FILE per captured direction of a connection,
+// written when the stream closes. A 4-tuple seen again later appends to the
+// same file, so offset and length locate this connection's bytes in it.
+struct StreamIndexRecord {
+    uint32_t conn_id;
+    FlowKey flow;           // Client side first, whatever the direction
+    uint64_t offset;        // In the direction's stream file
+    uint64_t length;
+    int64_t first_seen_us;  // PacketClock
+    uint8_t dir;            // Direction
+    uint8_t reserved[7];
+};
+static_assert(sizeof(StreamIndexRecord) == 48, "StreamIndexRecord is an on-disk format");
+
+inline constexpr const char* STREAM_INDEX_FILE = "index.bin";
+
+// Raw reassembled bytes, one file per direction named tcpflow-style
+// (SRCIP.SRCPORT-DSTIP.DSTPORT, zero padded). Writers copy into a pool of
+// large page-aligned buffers; a background I/O thread hands each full buffer
+// to the kernel with pwritev, coalescing consecutive chunks of one file.
+// At most MAX_OPEN_FILES descriptors are kept, least recently used first out.
+class StreamWriter {
+public:
+    static constexpr size_t BUFFER_SIZE = 1 << 20;
+    static constexpr size_t BUFFER_ALIGN = 4096;
+    static constexpr size_t BUFFER_COUNT = 16;
+    static constexpr size_t MAX_OPEN_FILES = 256;
+    static constexpr int FLUSH_INTERVAL_MS = 1000;  // Partly filled buffers go out this often
+
+    // One stream file, shared by the connections that reuse its 4-tuple
+    struct File {
+        std::string name;      // Relative to the directory
+        uint64_t end = 0;      // Next free offset
+        uint32_t streams = 0;  // Open streams plus closes not yet written out
+        int fd = -1;           // I/O thread only, -1 while evicted
+        std::list<File*>::iterator lru;
+    };
+
+    // Handle of one direction of one connection, owned by the caller
+    struct Stream {
+        File* file = nullptr;  // nullptr until opened
+        uint64_t offset = 0;
+        uint64_t length = 0;
+    };
+
+    static StreamWriter& get_instance();
+
+    // Create directory if needed, open its index and start the I/O thread
+    bool start(const std::string& directory);
+    // Write out everything queued, close all files and join the I/O thread.
+    // Streams still open lose their index record.
+    void stop();
+    bool is_running() const { return running_.load(std::memory_order_relaxed); }
+
+    // Safe from any thread; a Stream is used by one thread at a time
+    bool open(const ConnInfo& info, Direction dir, Stream& stream);
+    void write(Stream& stream, const uint8_t* data, size_t len);
+    void close(const ConnInfo& info, Direction dir, Stream& stream);
+
+    // Human readable counters
+    void report(std::ostream& os) const;
+
+private:
+    struct Buffer {
+        uint8_t* data;
+        size_t used;
+    };
+
+    // Precedes each chunk in a Buffer, padded to CHUNK_ALIGN
+    struct Chunk {
+        enum Type : uint8_t { DATA, CLOSE };  // CLOSE carries a StreamIndexRecord
+        File* file;
+        uint64_t offset;
+        uint32_t len;
+        Type type;
+    };
+    static constexpr size_t CHUNK_ALIGN = 8;
+
+    StreamWriter() = default;
+    ~StreamWriter();
+    StreamWriter(const StreamWriter&) = delete;
+    StreamWriter& operator=(const StreamWriter&) = delete;
+
+    // Writer side, mutex_ held. reserve returns the payload room in current_,
+    // at least min_len, or 0 once stopped.
+    size_t reserve(std::unique_lock<std::mutex>& lock, size_t min_len);
+    void rotate(std::unique_lock<std::mutex>& lock);
+    void put(const Chunk& chunk, const void* data);
+
+    // I/O thread
+    void io_loop();
+    void flush_buffer(const Buffer& buffer);
+    void write_file(File* file, uint64_t offset, iovec* iov, size_t count);
+    int acquire_fd(File* file);
+    void close_fd(File* file);
+    // The stream's data is written; drop the file once no stream uses it
+    void release_file(File* file);
+
+    std::string directory_;
+    int index_fd_ = -1;
+    std::thread thread_;
+    std::atomic<bool> running_{false};
+    bool stopping_ = false;
+
+    std::mutex mutex_;
+    std::condition_variable full_cv_;  // I/O thread waits for buffers to write
+    std::condition_variable free_cv_;  // Writers wait for an empty buffer
+    std::vector<Buffer> buffers_;
+    std::vector<Buffer*> free_;
+    std::deque<Buffer*> full_;
+    Buffer* current_ = nullptr;
+    std::unordered_map<std::string, File> files_;  // By file name; nodes are stable
+
+    std::list<File*> lru_;  // I/O thread only, most recent first
+    std::vector<StreamIndexRecord> index_pending_;  // I/O thread only
+
+    std::atomic<uint64_t> streams_opened_{0};
+    std::atomic<uint64_t> bytes_captured_{0};
+    std::atomic<uint64_t> buffer_waits_{0};
+    std::atomic<uint64_t> files_opened_{0};
+    std::atomic<uint64_t> fd_evictions_{0};
+    std::atomic<uint64_t> write_errors_{0};
+};
+
+#endif // STREAM_WRITER_HPP
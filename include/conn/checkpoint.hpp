@@ -0,0 +1,99 @@
+#ifndef CHECKPOINT_HPP
+#define CHECKPOINT_HPP
+
+#include "definitions/conn_info.hpp"
+#include "misc/packet_clock.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+
+// CheckpointRecord::flags
+inline constexpr uint8_t CHECKPOINT_REASSEMBLY = 0x01;   // Analyzers were attached
+inline constexpr uint8_t CHECKPOINT_CLIENT_SEQ = 0x02;   // next_seq[CLIENT_TO_SERVER] is set
+inline constexpr uint8_t CHECKPOINT_SERVER_SEQ = 0x04;
+inline constexpr uint8_t CHECKPOINT_CLIENT_FIN = 0x08;
+inline constexpr uint8_t CHECKPOINT_SERVER_FIN = 0x10;
+inline constexpr uint8_t CHECKPOINT_COMPACTED = 0x20;    // compact holds the analyzer summary
+
+// One connection in a checkpoint file. Times are PacketClock microseconds;
+// arrays are indexed by Direction.
+struct CheckpointRecord {
+    FlowKey flow;
+    int32_t id = 0;
+    int64_t first_seen_us = 0;
+    int64_t last_seen_us = 0;
+    int64_t last_update_us = 0;
+    std::array<uint64_t, 2> packets{};
+    std::array<uint64_t, 2> bytes{};
+    std::array<uint32_t, 2> next_seq{};
+    std::array<uint16_t, 2> mss{};
+    std::array<uint8_t, 2> wscale{};
+    uint8_t client_state = 0;            // TCPState
+    uint8_t server_state = 0;
+    uint8_t flags = 0;                   // CHECKPOINT_*
+    CompactSummary compact;
+};
+static_assert(std::is_trivially_copyable_v<CheckpointRecord>, "Records are copied in and out of the mapping");
+
+// Checkpoint file: a CheckpointHeader followed by count records, in host
+// byte order. Written to PATH.tmp through a shared mapping, then renamed
+// over PATH, so a crash mid-write leaves the previous checkpoint intact.
+struct CheckpointHeader {
+    static constexpr uint64_t MAGIC = 0x31504b4354504354ULL;  // "TCPTCKP1"
+    static constexpr uint32_t VERSION = 1;
+
+    uint64_t magic = MAGIC;
+    uint32_t version = VERSION;
+    uint32_t record_size = sizeof(CheckpointRecord);
+    uint64_t count = 0;
+    int64_t taken_at_us = 0;
+};
+
+class CheckpointWriter {
+public:
+    CheckpointWriter() = default;
+    // Discards the file unless committed
+    ~CheckpointWriter();
+    CheckpointWriter(const CheckpointWriter&) = delete;
+    CheckpointWriter& operator=(const CheckpointWriter&) = delete;
+
+    // Map room for capacity records
+    bool open(const std::string& path, size_t capacity, PacketClock::time_point taken_at);
+    CheckpointRecord* records() { return records_; }
+    // Keep the first count records and replace the file at path
+    bool commit(size_t count);
+
+private:
+    void unmap();
+
+    std::string path_;
+    int fd_ = -1;
+    void* map_ = nullptr;
+    size_t map_len_ = 0;
+    CheckpointRecord* records_ = nullptr;
+};
+
+class CheckpointReader {
+public:
+    CheckpointReader() = default;
+    ~CheckpointReader();
+    CheckpointReader(const CheckpointReader&) = delete;
+    CheckpointReader& operator=(const CheckpointReader&) = delete;
+
+    // False, after a message, if the file is missing, truncated or foreign
+    bool open(const std::string& path);
+    size_t size() const { return count_; }
+    const CheckpointRecord& operator[](size_t index) const { return records_[index]; }
+    PacketClock::time_point taken_at() const { return taken_at_; }
+
+private:
+    void* map_ = nullptr;
+    size_t map_len_ = 0;
+    const CheckpointRecord* records_ = nullptr;
+    size_t count_ = 0;
+    PacketClock::time_point taken_at_;
+};
+
+#endif // CHECKPOINT_HPP
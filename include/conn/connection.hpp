@@ -2,31 +2,60 @@
 #define CONNECTION_HPP
 
 #include "conn/connection_key.hpp"
+#include "conn/checkpoint.hpp"
 #include "conn/tcp_state_machine.hpp"
+#include "definitions/conn_info.hpp"
 #include "reassm/reassembly.hpp"
+#include "reassm/protocol_handler.hpp"
 #include "interfaces/protocol_analyzer.hpp"
 #include "log/log_manager.hpp"
+#include "misc/packet_clock.hpp"
+#include <array>
 #include <string>
 #include <chrono>
 
+struct TCPHeader;
+
 class Connection {
 public:
     Connection() = default;
-    Connection(const ConnectionKey& key, int id);
+    // flow is the binary form of key, taken from the packet
+    Connection(const ConnectionKey& key, int id, const FlowKey& flow);
 	~Connection();
     void add_analyzer(std::shared_ptr<IProtocolAnalyzer> analyzer);
+    // Attach an analyzer now or, if it has a probe, once the payload matches
+    void add_candidate(const AnalyzerRegistry::AnalyzerFactory& factory);
+    // Per-direction packet and payload byte counters, reported on close
+    void count_packet(bool is_from_client, size_t payload_len);
+    // Pick MSS and window scale out of a SYN or SYN-ACK into the ConnInfo
+    void record_syn_options(bool is_from_client, const TCPHeader* tcp, size_t tcph_len);
     void update_client_state(uint8_t flags);
     void update_server_state(uint8_t flags);
     void process_payload(bool is_from_client, uint32_t seq, const uint8_t* payload, size_t payload_len, uint8_t flags);
-	bool should_clean_up() const;
+	bool should_clean_up(PacketClock::time_point now) const;
 
     TCPState get_client_state() const { return client_state_.state;};
     TCPState get_server_state() const { return server_state_.state;};
 	bool is_from_client(const std::string& pkt_src_ip) const { return key_.src_ip == pkt_src_ip;};
     const ConnectionKey& get_key() const { return key_; }
     int get_id() const { return id_; }
+    const ConnInfo& get_info() const { return info_; }
+    const ConnSummary& get_summary() const { return summary_; }
+    // Set once the analyzers and reassembly buffers have been released
+    const CompactSummary* get_compact_summary() const { return compact_.get(); }
+    // TCP, reassembly and analyzer state, for the control socket. Capture thread only.
+    void describe(std::ostream& os) const;
+    // Checkpointing. restore() follows the constructor and, when the record
+    // has CHECKPOINT_REASSEMBLY, add_candidate().
+    void save(CheckpointRecord& record) const;
+    void restore(const CheckpointRecord& record);
+    // Join a flow whose SYN was never seen: both sides start ESTABLISHED and
+    // analyzers are told via ConnInfo::mid_stream. Follows the constructor
+    // and precedes add_candidate().
+    void adopt();
 
 private:
+    void ensure_reassembly();
 	TCPState determine_new_client_state(TCPState current, uint8_t flags);
 	TCPState determine_new_server_state(TCPState current, uint8_t flags);
 
@@ -34,14 +63,23 @@ private:
     void handle_reassembly(bool is_from_client, uint32_t seq, const uint8_t* payload, size_t payload_len, uint8_t flags);
     void handle_fin(bool is_from_client);
     void handle_rst();
+    void publish_closed() const;
+    // Swap the analyzer state for a CompactSummary once nothing wants payload
+    void compact();
 
     ConnectionKey key_;
     int id_;
     ConnState client_state_;
     ConnState server_state_;
-    std::chrono::steady_clock::time_point last_update_;
+    PacketClock::time_point last_update_;
+    // Shared with the analyzers, so declared ahead of the handler
+    ConnInfo info_;
+    ConnSummary summary_;
+    ProtocolHandler protocol_handler_{info_, summary_};
+    // Only created once an analyzer or candidate is attached
     std::unique_ptr<Reassembly> client_reassembly_;
     std::unique_ptr<Reassembly> server_reassembly_;
+    std::unique_ptr<CompactSummary> compact_;
     TcpStateMachine state_machine_;
     Log& tcp_log_ = LogManager::get_instance().get_registered_log("tcp.log");
 };
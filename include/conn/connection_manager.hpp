@@ -3,45 +3,134 @@
 
 #include <unordered_map>
 #include <deque>
-#include <thread>
-#include <mutex>
 #include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
 #include <vector>
 #include "conn/connection.hpp"
+#include "conn/connection_snapshot.hpp"
+#include "conn/negative_flow_cache.hpp"
+#include "reassm/port_policy.hpp"
 #include "definitions/packet_key.hpp"
 #include "log/log.hpp"
 
+// Expiry runs on the capture thread whenever packet time has moved on by
+// the cleanup interval, so a replay expires connections exactly as the
+// live capture would have, however fast it is read. A sweep examines a
+// slice of the table per packet rather than all of it at once. While
+// snapshots are wanted it also collects a ConnectionSnapshot, published
+// when it has gone round, which query() reads without the lock. Swept
+// connections are retired to the EpochManager and destroyed by a reaper
+// thread, off the packet path. Packets of flows recently found untracked
+// are dropped through a NegativeFlowCache, which each sweep ages, before
+// the lock is taken.
 class ConnectionManager {
 public:
-    ConnectionManager(int cleanup_interval_seconds = 5, std::vector<std::string> default_analyzers = {});
+    ConnectionManager(int cleanup_interval_seconds = 5, PortPolicy port_policy = PortPolicy());
     ~ConnectionManager();
 
     // Process a packet and update connection state
     void process_packet(const ConnectionKey& key, const PacketKey& pkey);
     
-    // Get a connection by key
+    // Get a connection by key. The pointers of these two stay valid while
+    // the caller holds an EpochGuard taken before the call.
     Connection* get_connection(const ConnectionKey& key);
     
     // Get all active connections
     std::vector<Connection*> get_active_connections();
 
+    // Matching rows of the latest snapshot, at most one cleanup interval
+    // old. Safe from any thread; never blocks the packet path. Without
+    // enable_snapshots() a query only asks the next sweep for a snapshot,
+    // so the first one comes back empty.
+    ConnectionSnapshot query(const ConnectionQuery& filter) const;
+    // Snapshot at every sweep, for a reader that queries all along
+    void enable_snapshots() { snapshots_enabled_.store(true, std::memory_order_relaxed); }
+
+    // Control socket hooks; capture thread only
+    bool describe_connection(int id, std::ostream& os);
+    // Applies to connections opened from now on
+    void set_port_policy(PortPolicy port_policy);
+    const PortPolicy& get_port_policy() const { return *port_policies_.back(); }
+
+    // Adopt flows first seen without a SYN instead of ignoring them. The
+    // endpoint with the lower port is taken for the server. Only analyzers
+    // the port policy names that port for are attached.
+    void set_adopt_mid_stream(bool adopt) { adopt_mid_stream_ = adopt; }
+
+    // Checkpoint of the connection table, written every CHECKPOINT_INTERVAL
+    // of packet time once a file is set. Capture thread only.
+    static constexpr std::chrono::seconds CHECKPOINT_INTERVAL{60};
+    void set_checkpoint_file(const std::string& path) { checkpoint_file_ = path; }
+    // Copies the records under the lock and leaves writing, syncing and
+    // renaming the file to a background thread. The previous write is
+    // waited for first, the last one by the destructor.
+    bool write_checkpoint();
+    // Before the capture starts; returns the number of connections loaded
+    size_t restore_checkpoint();
+
+    // Live capture only: lets connections expire while no packets arrive.
+    // wake is called by the reaper after a quiet cleanup interval and must
+    // get the capture thread to call expire_idle(), as pcap_breakloop does.
+    void set_idle_wake(std::function<void()> wake);
+    // Capture thread. After a wake, sweeps the whole table as if packet
+    // time had run on with the host clock since the last packet.
+    void expire_idle();
+
 private:
-    Connection& create_or_get_connection(const ConnectionKey& key, const TCPHeader* tcp);
-    void mark_for_cleanup(const ConnectionKey& key);
-    void cleanup_marked_connections();
-    void cleanup_thread_func();
+    // Buckets a sweep examines per packet
+    static constexpr size_t SWEEP_SLICE = 64;
+    // How often the reaper frees retired connections and checks for a quiet link
+    static constexpr std::chrono::milliseconds REAP_INTERVAL{100};
+
+    Connection& create_or_get_connection(const ConnectionKey& key, const PacketKey& pkey);
+    // A sweep drops closed, TIME_WAIT expired and idle connections and
+    // collects a snapshot of the rest
+    void start_sweep();
+    // Examines up to max_buckets buckets; false once the sweep went round
+    bool sweep_slice(PacketClock::time_point now, size_t max_buckets);
+    void finish_sweep(PacketClock::time_point now);
+    void reap_loop();
+    static ConnectionRow make_row(const Connection& conn);
     
     Connection dummy_connection_;
     std::unordered_map<ConnectionKey, std::unique_ptr<Connection>> connections_;
-    std::vector<ConnectionKey> marked_for_cleanup_;
-    std::vector<std::string> default_analyzers_;
+    // Current policy last. Connections keep pointers into the factory
+    // lists, so replaced policies are kept until shutdown.
+    std::vector<std::unique_ptr<PortPolicy>> port_policies_;
 
     int next_id_;
-    std::thread cleanup_thread_;
     std::mutex connections_mutex_;
-    std::mutex cleanup_mutex_;
-    std::atomic<bool> running_;
-    int cleanup_interval_seconds_;
+    PacketClock::duration cleanup_interval_;
+    PacketClock::time_point next_cleanup_{};
+    std::atomic<const ConnectionSnapshot*> snapshot_{nullptr};  // Owned, retired on replacement
+    std::atomic<bool> snapshots_enabled_{false};
+    mutable std::atomic<bool> snapshot_requested_{false};
+    std::string checkpoint_file_;
+    std::thread checkpoint_thread_;
+    bool adopt_mid_stream_ = false;
+    NegativeFlowCache negative_cache_;
+    PacketClock::time_point next_checkpoint_{};
+
+    // Sweep in progress, capture thread only
+    bool sweeping_ = false;
+    size_t sweep_bucket_ = 0;
+    size_t sweep_buckets_ = 0;  // bucket_count() the sweep walks; 0 to (re)start
+    std::unique_ptr<ConnectionSnapshot> pending_snapshot_;  // Null unless snapshots are wanted
+    std::vector<ConnectionKey> expired_;
+
+    PacketClock::time_point last_packet_{};
+    std::atomic<uint64_t> packets_seen_{0};   // Written by the capture thread only
+    std::atomic<bool> idle_pending_{false};
+    std::atomic<int64_t> idle_us_{0};         // Host time since the last packet, at the wake
+
+    std::function<void()> idle_wake_;         // Guarded by reaper_mutex_
+    std::mutex reaper_mutex_;
+    std::condition_variable reaper_cv_;
+    bool reaper_stop_ = false;
+    std::thread reaper_;
 };
 
 #endif // CONNECTION_MANAGER_HPP
@@ -0,0 +1,49 @@
+#ifndef CONNECTION_SNAPSHOT_HPP
+#define CONNECTION_SNAPSHOT_HPP
+
+#include "conn/tcp_state_machine.hpp"
+#include "definitions/analyzer_events.hpp"
+#include "misc/packet_clock.hpp"
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <vector>
+
+// One connection as of a snapshot
+struct ConnectionRow {
+    FlowKey flow;
+    int id = 0;
+    PacketClock::time_point first_seen;
+    PacketClock::time_point last_seen;
+    std::array<uint64_t, 2> packets{};  // Indexed by Direction
+    std::array<uint64_t, 2> bytes{};    // Payload bytes
+    TCPState client_state = TCPState::CLOSED;
+    TCPState server_state = TCPState::CLOSED;
+    bool compacted = false;             // Analyzers released, see CompactSummary
+};
+
+// Immutable once published by the ConnectionManager
+struct ConnectionSnapshot {
+    PacketClock::time_point taken_at;
+    std::vector<ConnectionRow> rows;
+};
+
+// Filter of ConnectionManager::query. Ages are packet time since the first
+// packet, as of the snapshot.
+struct ConnectionQuery {
+    std::optional<TCPState> state;  // Either side in this state
+    uint16_t port = 0;              // Either port, 0 for any
+    PacketClock::duration min_age = PacketClock::duration::zero();
+    PacketClock::duration max_age = PacketClock::duration::max();
+    size_t limit = std::numeric_limits<size_t>::max();
+
+    bool matches(const ConnectionRow& row, PacketClock::time_point taken_at) const {
+        if (state && row.client_state != *state && row.server_state != *state) return false;
+        if (port && row.flow.client_port != port && row.flow.server_port != port) return false;
+        auto age = taken_at - row.first_seen;
+        return age >= min_age && age <= max_age;
+    }
+};
+
+#endif // CONNECTION_SNAPSHOT_HPP
@@ -0,0 +1,79 @@
+#ifndef NEGATIVE_FLOW_CACHE_HPP
+#define NEGATIVE_FLOW_CACHE_HPP
+
+#include "conn/connection_key.hpp"
+#include "misc/blocked_bloom_filter.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <utility>
+
+// Flows known not to be tracked, checked before the connection table is
+// locked. Untracked flows go into the newer of two filter generations and
+// age() drops the older one, so an entry lives one to two aging periods.
+// Tracked flows are kept in a second filter, and a flow that is in both
+// falls through to the table. A false positive of the untracked filters
+// therefore costs a lookup but never hides a connection. Each sweep builds
+// the next tracked filter, sized to the table, from the connections it
+// keeps; until it is done the current one stays in use. Capture thread only.
+class NegativeFlowCache {
+public:
+    static constexpr size_t UNTRACKED_BLOCKS = 256;  // 16 KiB per generation
+    static constexpr size_t TRACKED_BLOCKS = 512;    // At least
+    // Up to 32 flows in a 512-bit block keep false positives under 0.1%
+    static constexpr size_t TRACKED_FLOWS_PER_BLOCK = 32;
+
+    NegativeFlowCache()
+        : generations_{BlockedBloomFilter(UNTRACKED_BLOCKS), BlockedBloomFilter(UNTRACKED_BLOCKS)},
+          tracked_(TRACKED_BLOCKS), next_tracked_(TRACKED_BLOCKS) {}
+
+    // Same for both directions of a flow
+    static uint64_t hash(const ConnectionKey& key) {
+        // std::hash of the key is direction-free but weakly mixed; finish
+        // it as splitmix64 so both halves are usable by the filter
+        uint64_t h = std::hash<ConnectionKey>{}(key);
+        h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        h = (h ^ (h >> 27)) * 0x94d049bb133111ebULL;
+        return h ^ (h >> 31);
+    }
+
+    bool is_untracked(uint64_t hash) const {
+        return generations_[current_].contains(hash) || generations_[current_ ^ 1].contains(hash);
+    }
+    bool may_be_tracked(uint64_t hash) const { return tracked_.contains(hash); }
+
+    void add_untracked(uint64_t hash) { generations_[current_].insert(hash); }
+    void add_tracked(uint64_t hash) {
+        tracked_.insert(hash);
+        if (rebuilding_) next_tracked_.insert(hash);
+    }
+
+    // Forget the older untracked generation
+    void age() {
+        current_ ^= 1;
+        generations_[current_].clear();
+    }
+    // Starts the next tracked filter over, sized for twice the connections
+    // so those opened until the following rebuild fit too
+    void begin_rebuild(size_t connections) {
+        next_tracked_.reset(std::max(TRACKED_BLOCKS, 2 * connections / TRACKED_FLOWS_PER_BLOCK));
+        rebuilding_ = true;
+    }
+    // A connection the sweep keeps
+    void add_surviving(uint64_t hash) { next_tracked_.insert(hash); }
+    // Swept connections drop out of the tracked filter
+    void end_rebuild() {
+        std::swap(tracked_, next_tracked_);
+        rebuilding_ = false;
+    }
+
+private:
+    BlockedBloomFilter generations_[2];
+    BlockedBloomFilter tracked_;
+    BlockedBloomFilter next_tracked_;
+    bool rebuilding_ = false;
+    size_t current_ = 0;
+};
+
+#endif // NEGATIVE_FLOW_CACHE_HPP
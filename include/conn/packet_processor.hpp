@@ -12,11 +12,12 @@ public:
     ~PacketProcessor();
     void handle_packet(const struct pcap_pkthdr* header, const u_char* packet);
 
-private:
+    // Stateless decoding steps of handle_packet; public for tcp_tracker_bench
     bool validate_packet(const struct pcap_pkthdr* header, const u_char* packet);
     bool extract_packet(const u_char* packet, const size_t packet_len, 
         ConnectionKey& key, PacketKey& pkey);
 
+private:
     ConnectionManager& connection_manager_;
     Log& packet_log_ = LogManager::get_instance().get_registered_log("packet.log");
 };
@@ -1,8 +1,10 @@
 #ifndef TCP_STATE_MACHINE_HPP
 #define TCP_STATE_MACHINE_HPP
 
+#include "misc/packet_clock.hpp"
 #include <string>
 #include <chrono>
+#include <optional>
 
 enum class TCPState {
     CLOSED,
@@ -21,8 +23,8 @@ enum class TCPState {
 struct ConnState {
     TCPState state = TCPState::CLOSED;
     TCPState prev_state = TCPState::CLOSED;
-    std::chrono::steady_clock::time_point start_time;
-    std::optional<std::chrono::steady_clock::time_point> time_wait_entry_time;
+    PacketClock::time_point start_time;
+    std::optional<PacketClock::time_point> time_wait_entry_time;
 };
 
 class TcpStateMachine {
@@ -32,8 +34,9 @@ public:
     // Instance methods for state management
     TCPState determine_new_state(TCPState current, uint8_t flags, bool is_client);
     bool should_enter_time_wait(TCPState current, uint8_t flags, bool is_client);
-    bool should_clean_up(const ConnState& client_state, const ConnState& server_state, 
-                        const std::chrono::steady_clock::time_point& last_update) const;
+    // Timeouts are measured in packet time, so replays expire like the capture did
+    bool should_clean_up(const ConnState& client_state, const ConnState& server_state,
+                        PacketClock::time_point last_update, PacketClock::time_point now) const;
 
     // Static utility methods that don't need state
     static std::string state_to_string(TCPState s);
@@ -0,0 +1,63 @@
+#ifndef ANALYZER_EVENTS_HPP
+#define ANALYZER_EVENTS_HPP
+
+#include <cstdint>
+#include <type_traits>
+
+// Typed events published on the EventBus. Everything is POD so publishing
+// is a handful of stores; names are carried as fnv1a_32_lower ids.
+
+enum class AnalyzerEventType : uint8_t {
+    TLS_HANDSHAKE_DONE,
+    HTTP_TRANSACTION,
+    CONN_CLOSED
+};
+
+// IPv4 addresses in network byte order, client side first
+struct FlowKey {
+    uint32_t client_ip = 0;
+    uint32_t server_ip = 0;
+    uint16_t client_port = 0;
+    uint16_t server_port = 0;
+};
+
+struct TlsHandshakeDone {
+    uint32_t sni_id;      // 0 without server_name
+    uint16_t version;     // Negotiated TLSVersion
+    uint16_t cipher;      // Selected cipher suite
+    uint8_t kind;         // TLSHandshakeKind
+    uint32_t rtt_us;      // ClientHello to Finished
+};
+
+struct HttpTransaction {
+    uint32_t host_id;     // 0 without Host
+    uint8_t method;       // HttpMethod
+    uint16_t status;
+    uint32_t latency_us;  // Request sent to first response byte
+    uint64_t request_bytes;
+    uint64_t response_bytes;
+    uint64_t body_bytes;  // Response body
+};
+
+struct ConnClosed {
+    uint8_t client_state;  // TCPState
+    uint8_t server_state;
+    uint32_t duration_ms;  // First to last packet
+    uint64_t packets[2];   // Indexed by Direction
+    uint64_t bytes[2];     // Payload bytes
+};
+
+struct AnalyzerEvent {
+    AnalyzerEventType type;
+    FlowKey flow;
+    int64_t time_us;  // PacketClock time of the event
+    union {
+        TlsHandshakeDone tls_handshake_done;
+        HttpTransaction http_transaction;
+        ConnClosed conn_closed;
+    };
+};
+
+static_assert(std::is_trivially_copyable_v<AnalyzerEvent>);
+
+#endif // ANALYZER_EVENTS_HPP
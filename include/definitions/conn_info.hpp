@@ -0,0 +1,61 @@
+#ifndef CONN_INFO_HPP
+#define CONN_INFO_HPP
+
+#include "conn/connection_key.hpp"
+#include "definitions/analyzer_events.hpp"
+#include "misc/packet_clock.hpp"
+#include <array>
+#include <cstdint>
+
+// Window scale option absent
+inline constexpr uint8_t TCP_NO_WSCALE = 0xff;
+
+// What a connection is, shared with its analyzers through on_open. Owned by
+// the Connection and valid for the analyzer's whole lifetime, so analyzers
+// keep a pointer instead of copying the key. The TCP options fill in as the
+// SYN and SYN-ACK are seen, possibly after on_open.
+struct ConnInfo {
+    const ConnectionKey* key = nullptr;  // Text form, for logs
+    FlowKey flow;                        // Binary form, for metrics and events
+    int id = 0;
+    PacketClock::time_point first_seen;
+    std::array<uint16_t, 2> mss{};       // Indexed by Direction of the SYN sender, 0 if absent
+    std::array<uint8_t, 2> wscale{TCP_NO_WSCALE, TCP_NO_WSCALE};
+    // Adopted without a SYN: each direction starts at its first segment
+    // seen, possibly inside a protocol message
+    bool mid_stream = false;
+};
+
+// Running totals of a connection, final when handed to on_close
+struct ConnSummary {
+    PacketClock::time_point last_seen;
+    std::array<uint64_t, 2> packets{};  // Indexed by Direction
+    std::array<uint64_t, 2> bytes{};    // Payload bytes
+    uint8_t client_state = 0;           // TCPState
+    uint8_t server_state = 0;
+};
+
+// CompactSummary::flags
+inline constexpr uint8_t COMPACT_TLS_COMPLETE = 0x01;
+inline constexpr uint8_t COMPACT_TLS_FAILED = 0x02;
+
+// Fixed-size record of a connection whose analyzers were released once
+// none of them wanted more data, e.g. after the TLS handshake. Filled by
+// the Connection and by each analyzer's summarize().
+struct CompactSummary {
+    FlowKey flow;
+    uint32_t sni_id = 0;                // fnv1a_32_lower of the SNI, 0 if absent
+    int64_t first_seen_us = 0;          // PacketClock
+    std::array<uint64_t, 2> bytes{};    // Payload bytes up to the compaction, indexed by Direction
+    std::array<uint32_t, 2> packets{};
+    uint32_t handshake_us = 0;          // ClientHello to Finished, 0 if not measured
+    uint16_t tls_version = 0;           // Negotiated TLSVersion
+    uint16_t cipher = 0;
+    uint8_t tls_kind = 0;               // TLSHandshakeKind
+    uint8_t flags = 0;                  // COMPACT_TLS_*
+    uint8_t client_state = 0;           // TCPState
+    uint8_t server_state = 0;
+};
+static_assert(sizeof(CompactSummary) <= 64, "CompactSummary must stay within a cache line");
+
+#endif // CONN_INFO_HPP
@@ -0,0 +1,47 @@
+#ifndef HTTP_TYPES_HPP
+#define HTTP_TYPES_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// HTTP/1.x request methods (RFC 9110 Section 9, RFC 5789)
+enum class HttpMethod : uint8_t {
+    GET,
+    HEAD,
+    POST,
+    PUT,
+    DELETE,
+    CONNECT,
+    OPTIONS,
+    TRACE,
+    PATCH,
+    UNKNOWN,
+    COUNT
+};
+
+inline constexpr const char* HTTP_METHOD_NAMES[] = {
+    "GET", "HEAD", "POST", "PUT", "DELETE", "CONNECT", "OPTIONS", "TRACE", "PATCH"
+};
+inline constexpr size_t HTTP_KNOWN_METHODS = static_cast<size_t>(HttpMethod::UNKNOWN);
+static_assert(sizeof(HTTP_METHOD_NAMES) / sizeof(HTTP_METHOD_NAMES[0]) == HTTP_KNOWN_METHODS);
+
+static std::string get_http_method_name(HttpMethod method) {
+    size_t index = static_cast<size_t>(method);
+    return index < HTTP_KNOWN_METHODS ? HTTP_METHOD_NAMES[index] : "UNKNOWN";
+}
+
+// Response status classes 1xx..5xx; anything else counts as OTHER
+inline constexpr size_t HTTP_STATUS_CLASSES = 6;
+inline constexpr size_t HTTP_STATUS_CLASS_OTHER = 0;
+
+constexpr size_t http_status_class(uint16_t status) {
+    return status >= 100 && status < 600 ? status / 100 : HTTP_STATUS_CLASS_OTHER;
+}
+
+inline constexpr char HTTP_VERSION_PREFIX[] = "HTTP/1.";
+inline constexpr size_t HTTP_VERSION_PREFIX_LEN = sizeof(HTTP_VERSION_PREFIX) - 1;
+inline constexpr size_t HTTP_MAX_LINE_LEN = 8192;  // Longer start or header lines are not HTTP for us
+inline constexpr size_t HTTP_MAX_HOST_LEN = 63;
+
+#endif // HTTP_TYPES_HPP
@@ -15,6 +15,7 @@ enum class ReassmEvent {
     SEQ_INITIALIZED,         // Initial sequence number set
     DATA_IGNORED_FIN,        // Data ignored due to FIN already received
     DATA_IGNORED_INIT,       // Data ignored due to initial sequence number not set
+    DATA_IGNORED_IDLE,       // Data ignored because no analyzer wants it
     SEGMENT_INVALID,         // Segment is invalid (e.g., zero length)
     SEGMENT_OUT_OF_ORDER    // Segment is out of order and needs to be buffered
 };
@@ -43,7 +43,7 @@ enum class TLSHandshakeType : uint8_t {
 };
 
 // TLS connection state
-enum class TLS12State {
+enum class TLS12State : uint8_t {
     INIT,                       // Connection initialized
     
     // Client -> Server
@@ -66,24 +66,34 @@ enum class TLS12State {
     // Server -> Client
     CHANGE_CIPHER_SPEC_RECEIVED,// ChangeCipherSpec received (required)
     FINISHED_RECEIVED,          // Finished message received (required)
+
+    // Abbreviated handshake (RFC 5246 Section 7.3, RFC 5077 Section 3.1)
+    ABBREVIATED_CHANGE_CIPHER_SPEC_RECEIVED, // Server ChangeCipherSpec right after ServerHello
+    ABBREVIATED_FINISHED_RECEIVED,           // Server Finished received
+    ABBREVIATED_CHANGE_CIPHER_SPEC_SENT,     // Client ChangeCipherSpec sent
     
     HANDSHAKE_COMPLETE,         // Full handshake complete
+    ALERT_RECEIVED,             // Closure or error alert ended the handshake
     ERROR                       // Error occurred during processing
 };
 
+// TLS 1.3 connection state as observable on the wire. Everything after
+// ServerHello is encrypted (RFC 8446 Section 2), so the server and client
+// flights are tracked as opaque encrypted records.
 enum class TLS13State {
-    INIT,
-    CLIENT_HELLO_SENT,
-    SERVER_HELLO_RECEIVED,
-    ENCRYPTED_EXTENSIONS_RECEIVED,
-    CERTIFICATE_RECEIVED,
-    CERTIFICATE_VERIFY_RECEIVED,
-    FINISHED_RECEIVED,
-    CLIENT_CERTIFICATE_SENT,
-    CLIENT_CERTIFICATE_VERIFY_SENT,
-    CLIENT_FINISHED_SENT,
-    HANDSHAKE_COMPLETE,
-    ERROR
+    INIT,                         // Connection initialized
+
+    // Client -> Server
+    CLIENT_HELLO_SENT,            // ClientHello sent (required)
+
+    // Server -> Client
+    HELLO_RETRY_REQUEST_RECEIVED, // HelloRetryRequest received, second ClientHello expected
+    SERVER_HELLO_RECEIVED,        // ServerHello received (required)
+    SERVER_FLIGHT_RECEIVED,       // Encrypted EncryptedExtensions..Finished flight started
+
+    // Client -> Server
+    HANDSHAKE_COMPLETE,           // Client encrypted flight (Finished) seen
+    ERROR                         // Error occurred during processing
 };
 
 // TLS Alert levels
@@ -92,14 +102,42 @@ enum class TLSAlertLevel : uint8_t {
     FATAL = 2
 };
 
-// TLS Alert descriptions
+// TLS Alert descriptions (RFC 5246 Section 7.2, RFC 8446 Section 6)
 enum class TLSAlertDescription : uint8_t {
     CLOSE_NOTIFY = 0,
     UNEXPECTED_MESSAGE = 10,
     BAD_RECORD_MAC = 20,
+    DECRYPTION_FAILED = 21,
+    RECORD_OVERFLOW = 22,
+    DECOMPRESSION_FAILURE = 30,
     HANDSHAKE_FAILURE = 40,
+    NO_CERTIFICATE = 41,
+    BAD_CERTIFICATE = 42,
+    UNSUPPORTED_CERTIFICATE = 43,
+    CERTIFICATE_REVOKED = 44,
+    CERTIFICATE_EXPIRED = 45,
+    CERTIFICATE_UNKNOWN = 46,
+    ILLEGAL_PARAMETER = 47,
+    UNKNOWN_CA = 48,
+    ACCESS_DENIED = 49,
+    DECODE_ERROR = 50,
+    DECRYPT_ERROR = 51,
+    EXPORT_RESTRICTION = 60,
     PROTOCOL_VERSION = 70,
-    INTERNAL_ERROR = 80
+    INSUFFICIENT_SECURITY = 71,
+    INTERNAL_ERROR = 80,
+    INAPPROPRIATE_FALLBACK = 86,
+    USER_CANCELED = 90,
+    NO_RENEGOTIATION = 100,
+    MISSING_EXTENSION = 109,
+    UNSUPPORTED_EXTENSION = 110,
+    CERTIFICATE_UNOBTAINABLE = 111,
+    UNRECOGNIZED_NAME = 112,
+    BAD_CERTIFICATE_STATUS_RESPONSE = 113,
+    BAD_CERTIFICATE_HASH_VALUE = 114,
+    UNKNOWN_PSK_IDENTITY = 115,
+    CERTIFICATE_REQUIRED = 116,
+    NO_APPLICATION_PROTOCOL = 120
 };
 
 // TLS Record Structure (RFC 5246 Section 6.2.1)
@@ -114,6 +152,7 @@ struct TLSRecord {
 struct TLSAlert {
     TLSAlertLevel level;
     TLSAlertDescription description;
+    bool opaque = false;  // Encrypted after ChangeCipherSpec, level and description unknown
 };
 
 // TLS Change Cipher Spec Structure (RFC 5246 Section 7.1)
@@ -139,6 +178,30 @@ inline constexpr size_t TLS_MIN_RECORD_LEN = 6;     // header(5) + minimum fragm
 // Handshake constants
 inline constexpr size_t TLS_HANDSHAKE_HEADER_LEN = 4;  // type(1) + length(3)
 inline constexpr size_t TLS_MAX_HANDSHAKE_LEN = 16777215;  // 2^24 - 1
+inline constexpr size_t TLS_RANDOM_LEN = 32;
+
+// Hello extension constants
+inline constexpr uint16_t TLS_EXT_SERVER_NAME = 0x0000;
+inline constexpr uint16_t TLS_EXT_SESSION_TICKET = 0x0023;
+inline constexpr uint16_t TLS_EXT_PRE_SHARED_KEY = 0x0029;
+inline constexpr uint16_t TLS_EXT_EARLY_DATA = 0x002a;
+inline constexpr uint16_t TLS_EXT_SUPPORTED_VERSIONS = 0x002b;
+inline constexpr size_t TLS_MAX_SESSION_ID_LEN = 32;
+
+// Length of the TLS 1.3 record carrying a Finished: handshake header,
+// verify_data of the suite's hash, inner content type and AEAD tag
+// (RFC 8446 Sections 4.4.4 and 5.2, Appendix B.4)
+inline constexpr size_t tls13_finished_record_len(uint16_t cipher_suite) {
+    size_t hash_len = cipher_suite == 0x1302 ? 48 : 32;  // TLS_AES_256_GCM_SHA384
+    size_t tag_len = cipher_suite == 0x1305 ? 8 : 16;    // TLS_AES_128_CCM_8_SHA256
+    return TLS_HANDSHAKE_HEADER_LEN + hash_len + 1 + tag_len;
+}
+
+// ServerHello.random value identifying a HelloRetryRequest (RFC 8446 Section 4.1.3)
+inline constexpr uint8_t TLS_HELLO_RETRY_REQUEST_RANDOM[TLS_RANDOM_LEN] = {
+    0xcf, 0x21, 0xad, 0x74, 0xe5, 0x9a, 0x61, 0x11, 0xbe, 0x1d, 0x8c, 0x02, 0x1e, 0x65, 0xb8, 0x91,
+    0xc2, 0xa2, 0x11, 0x16, 0x7a, 0xbb, 0x8c, 0x5e, 0x07, 0x9e, 0x09, 0xe2, 0xc8, 0xa8, 0x33, 0x9c
+};
 
 // Alert constants
 inline constexpr size_t TLS_ALERT_LEN = 2;  // level(1) + description(1)
@@ -225,20 +288,83 @@ static std::string get_tls12_state_name(TLS12State state) {
         case TLS12State::FINISHED_SENT: return "FINISHED_SENT";
         case TLS12State::CHANGE_CIPHER_SPEC_RECEIVED: return "CHANGE_CIPHER_SPEC_RECEIVED";
         case TLS12State::FINISHED_RECEIVED: return "FINISHED_RECEIVED";
+        case TLS12State::ABBREVIATED_CHANGE_CIPHER_SPEC_RECEIVED: return "ABBREVIATED_CHANGE_CIPHER_SPEC_RECEIVED";
+        case TLS12State::ABBREVIATED_FINISHED_RECEIVED: return "ABBREVIATED_FINISHED_RECEIVED";
+        case TLS12State::ABBREVIATED_CHANGE_CIPHER_SPEC_SENT: return "ABBREVIATED_CHANGE_CIPHER_SPEC_SENT";
         case TLS12State::HANDSHAKE_COMPLETE: return "HANDSHAKE_COMPLETE";
+        case TLS12State::ALERT_RECEIVED: return "ALERT_RECEIVED";
         case TLS12State::ERROR: return "ERROR";
         default: return "UNKNOWN_STATE";
     }
 }
 
+static std::string get_tls13_state_name(TLS13State state) {
+    switch (state) {
+        case TLS13State::INIT: return "INIT";
+        case TLS13State::CLIENT_HELLO_SENT: return "CLIENT_HELLO_SENT";
+        case TLS13State::HELLO_RETRY_REQUEST_RECEIVED: return "HELLO_RETRY_REQUEST_RECEIVED";
+        case TLS13State::SERVER_HELLO_RECEIVED: return "SERVER_HELLO_RECEIVED";
+        case TLS13State::SERVER_FLIGHT_RECEIVED: return "SERVER_FLIGHT_RECEIVED";
+        case TLS13State::HANDSHAKE_COMPLETE: return "HANDSHAKE_COMPLETE";
+        case TLS13State::ERROR: return "ERROR";
+        default: return "UNKNOWN_STATE";
+    }
+}
+
+static std::string get_tls_version_name(uint16_t version) {
+    switch (version) {
+        case static_cast<uint16_t>(TLSVersion::TLS_1_0): return "TLSv1.0";
+        case static_cast<uint16_t>(TLSVersion::TLS_1_1): return "TLSv1.1";
+        case static_cast<uint16_t>(TLSVersion::TLS_1_2): return "TLSv1.2";
+        case static_cast<uint16_t>(TLSVersion::TLS_1_3): return "TLSv1.3";
+        default: return "Unknown";
+    }
+}
+
 static std::string get_alert_description(uint8_t code) {
-    switch (code) {
-        case TLS_ALERT_CLOSE_NOTIFY: return "close_notify";
-        case TLS_ALERT_UNEXPECTED_MESSAGE: return "unexpected_message";
-        case TLS_ALERT_BAD_RECORD_MAC: return "bad_record_mac";
-        case TLS_ALERT_HANDSHAKE_FAILURE: return "handshake_failure";
-        case TLS_ALERT_PROTOCOL_VERSION: return "protocol_version";
-        case TLS_ALERT_INTERNAL_ERROR: return "internal_error";
+    switch (static_cast<TLSAlertDescription>(code)) {
+        case TLSAlertDescription::CLOSE_NOTIFY: return "close_notify";
+        case TLSAlertDescription::UNEXPECTED_MESSAGE: return "unexpected_message";
+        case TLSAlertDescription::BAD_RECORD_MAC: return "bad_record_mac";
+        case TLSAlertDescription::DECRYPTION_FAILED: return "decryption_failed";
+        case TLSAlertDescription::RECORD_OVERFLOW: return "record_overflow";
+        case TLSAlertDescription::DECOMPRESSION_FAILURE: return "decompression_failure";
+        case TLSAlertDescription::HANDSHAKE_FAILURE: return "handshake_failure";
+        case TLSAlertDescription::NO_CERTIFICATE: return "no_certificate";
+        case TLSAlertDescription::BAD_CERTIFICATE: return "bad_certificate";
+        case TLSAlertDescription::UNSUPPORTED_CERTIFICATE: return "unsupported_certificate";
+        case TLSAlertDescription::CERTIFICATE_REVOKED: return "certificate_revoked";
+        case TLSAlertDescription::CERTIFICATE_EXPIRED: return "certificate_expired";
+        case TLSAlertDescription::CERTIFICATE_UNKNOWN: return "certificate_unknown";
+        case TLSAlertDescription::ILLEGAL_PARAMETER: return "illegal_parameter";
+        case TLSAlertDescription::UNKNOWN_CA: return "unknown_ca";
+        case TLSAlertDescription::ACCESS_DENIED: return "access_denied";
+        case TLSAlertDescription::DECODE_ERROR: return "decode_error";
+        case TLSAlertDescription::DECRYPT_ERROR: return "decrypt_error";
+        case TLSAlertDescription::EXPORT_RESTRICTION: return "export_restriction";
+        case TLSAlertDescription::PROTOCOL_VERSION: return "protocol_version";
+        case TLSAlertDescription::INSUFFICIENT_SECURITY: return "insufficient_security";
+        case TLSAlertDescription::INTERNAL_ERROR: return "internal_error";
+        case TLSAlertDescription::INAPPROPRIATE_FALLBACK: return "inappropriate_fallback";
+        case TLSAlertDescription::USER_CANCELED: return "user_canceled";
+        case TLSAlertDescription::NO_RENEGOTIATION: return "no_renegotiation";
+        case TLSAlertDescription::MISSING_EXTENSION: return "missing_extension";
+        case TLSAlertDescription::UNSUPPORTED_EXTENSION: return "unsupported_extension";
+        case TLSAlertDescription::CERTIFICATE_UNOBTAINABLE: return "certificate_unobtainable";
+        case TLSAlertDescription::UNRECOGNIZED_NAME: return "unrecognized_name";
+        case TLSAlertDescription::BAD_CERTIFICATE_STATUS_RESPONSE: return "bad_certificate_status_response";
+        case TLSAlertDescription::BAD_CERTIFICATE_HASH_VALUE: return "bad_certificate_hash_value";
+        case TLSAlertDescription::UNKNOWN_PSK_IDENTITY: return "unknown_psk_identity";
+        case TLSAlertDescription::CERTIFICATE_REQUIRED: return "certificate_required";
+        case TLSAlertDescription::NO_APPLICATION_PROTOCOL: return "no_application_protocol";
+        default: return "unknown";
+    }
+}
+
+static std::string get_alert_level_name(uint8_t level) {
+    switch (level) {
+        case TLS_ALERT_LEVEL_WARNING: return "warning";
+        case TLS_ALERT_LEVEL_FATAL: return "fatal";
         default: return "unknown";
     }
 }
@@ -0,0 +1,10 @@
+#ifndef DELIMITER_SCAN_HPP
+#define DELIMITER_SCAN_HPP
+
+#include <cstdint>
+
+// First '\n' in [begin, end), or end. Scans 32 bytes per step with AVX2 when
+// the CPU has it, 16 with SSE2 otherwise, and falls back to memchr off x86.
+const uint8_t* find_line_feed(const uint8_t* begin, const uint8_t* end);
+
+#endif // DELIMITER_SCAN_HPP
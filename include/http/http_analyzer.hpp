@@ -0,0 +1,62 @@
+#ifndef HTTP_ANALYZER_HPP
+#define HTTP_ANALYZER_HPP
+
+#include "definitions/direction.hpp"
+#include "definitions/http_types.hpp"
+#include "interfaces/protocol_analyzer.hpp"
+#include "http/http_parser.hpp"
+#include "http/http_metrics.hpp"
+#include "log/log_manager.hpp"
+#include <array>
+
+// Probe for the "http" analyzer: a request line from the client or a
+// status line from the server
+ProbeResult probe_http(Direction dir, const uint8_t* data, size_t len);
+
+// Pairs pipelined requests with their responses and reports each
+// transaction to HttpMetrics and http.log
+class HttpAnalyzer : public IProtocolAnalyzer, private HttpParser::Listener {
+public:
+    // Requests in flight; deeper pipelines stop the analysis
+    static constexpr size_t MAX_PIPELINE = 8;
+
+    HttpAnalyzer();
+
+    // IProtocolAnalyzer interface implementation
+    void on_open(const ConnInfo& info) override { info_ = &info; }
+    // Response bodies of known length are skipped rather than delivered
+    ParseHint on_data(Direction dir,
+                      const uint8_t* data,
+                      size_t len) override;
+    void on_connection_reset() override;
+    void on_connection_closed() override;
+
+    // Tunnelled, not HTTP, or lost track of the request/response pairing
+    bool is_finished() const override { return finished_; }
+
+    uint64_t get_transactions() const { return transactions_; }
+
+private:
+    struct PendingRequest {
+        HttpMessage request;
+        PacketClock::time_point sent;  // Last byte of the request
+    };
+
+    HttpBodyRule on_headers(const HttpMessage& message) override;
+    void on_message_complete(const HttpMessage& message) override;
+
+    void record_transaction(const PendingRequest& pending, const HttpMessage& response);
+    void finish();
+
+    const ConnInfo* info_ = nullptr;
+    Log& http_log_;
+    HttpParser request_parser_;
+    HttpParser response_parser_;
+    std::array<PendingRequest, MAX_PIPELINE> pending_;
+    size_t pending_head_ = 0;
+    size_t pending_count_ = 0;
+    uint64_t transactions_ = 0;
+    bool finished_ = false;
+};
+
+#endif // HTTP_ANALYZER_HPP
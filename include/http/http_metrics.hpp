@@ -0,0 +1,49 @@
+#ifndef HTTP_METRICS_HPP
+#define HTTP_METRICS_HPP
+
+#include "definitions/http_types.hpp"
+#include "http/http_parser.hpp"
+#include "misc/atomic_histogram.hpp"
+#include "misc/packet_clock.hpp"
+#include "misc/port_slot_table.hpp"
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+#include <utility>
+
+// Process-wide HTTP transaction aggregates, per server port. Recording is
+// lock-free and may happen from any thread.
+class HttpMetrics {
+public:
+    static constexpr size_t MAX_PORTS = 64;
+
+    struct PortMetrics {
+        std::atomic<uint64_t> requests[static_cast<size_t>(HttpMethod::COUNT)] = {};
+        std::atomic<uint64_t> responses[HTTP_STATUS_CLASSES] = {};
+        std::atomic<uint64_t> request_bytes{0};   // On the wire, headers included
+        std::atomic<uint64_t> response_bytes{0};
+        AtomicHistogram response_size;  // Response body bytes
+        AtomicHistogram latency;        // Request sent to first response byte, microseconds
+    };
+
+    static HttpMetrics& get_instance();
+
+    void record(uint16_t server_port, const HttpMessage& request, const HttpMessage& response,
+                PacketClock::duration latency);
+
+    // f(uint16_t port, const PortMetrics& metrics); port 0 collects overflow
+    template <typename F>
+    void for_each_port(F&& f) const { ports_.for_each(std::forward<F>(f)); }
+
+    // Human readable summary, one line per server port
+    void report(std::ostream& os) const;
+
+private:
+    HttpMetrics() = default;
+    HttpMetrics(const HttpMetrics&) = delete;
+    HttpMetrics& operator=(const HttpMetrics&) = delete;
+
+    PortSlotTable<PortMetrics, MAX_PORTS> ports_;
+};
+
+#endif // HTTP_METRICS_HPP
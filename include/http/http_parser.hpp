@@ -0,0 +1,95 @@
+#ifndef HTTP_PARSER_HPP
+#define HTTP_PARSER_HPP
+
+#include "definitions/http_types.hpp"
+#include "misc/packet_clock.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// What the listener wants done with the body of a message whose headers
+// just ended
+enum class HttpBodyRule : uint8_t {
+    NORMAL,   // Framing from Content-Length / Transfer-Encoding
+    NO_BODY,  // Response to HEAD
+    TUNNEL    // 101 Switching Protocols or a successful CONNECT: stop parsing
+};
+
+// One request or response as seen so far. Only the start line and the
+// headers that matter for framing and reporting are kept.
+struct HttpMessage {
+    bool is_request = true;
+    HttpMethod method = HttpMethod::UNKNOWN;  // Requests
+    uint16_t status = 0;                      // Responses
+    uint8_t version_minor = 1;
+    char host[HTTP_MAX_HOST_LEN + 1] = {};    // Host header, truncated
+    bool chunked = false;
+    bool has_content_length = false;
+    bool connection_close = false;
+    uint64_t content_length = 0;
+    uint64_t wire_bytes = 0;  // Start line through the end of the body, framing included
+    uint64_t body_bytes = 0;  // Decoded payload
+    PacketClock::time_point start;  // First byte of the start line
+};
+
+// Incremental HTTP/1.x parser for one direction. Data is scanned where it
+// lies; only a start or header line split across segments is copied, and
+// bodies are skipped by length without being buffered.
+class HttpParser {
+public:
+    class Listener {
+    public:
+        virtual ~Listener() = default;
+        virtual HttpBodyRule on_headers(const HttpMessage& message) = 0;
+        virtual void on_message_complete(const HttpMessage& message) = 0;
+    };
+
+    HttpParser(bool is_request, Listener& listener);
+
+    // Returns false once the stream stopped looking like HTTP
+    bool feed(const uint8_t* data, size_t len);
+    // Connection closed; ends a response delimited by the close
+    void on_end();
+    // Length-framed body bytes still expected; the caller may drop them
+    // unseen, they are accounted for here as if parsed
+    uint64_t skip_body();
+    // Ignore everything from now on, e.g. the client side of a CONNECT tunnel
+    void enter_tunnel() { state_ = State::TUNNEL; }
+
+    bool is_failed() const { return state_ == State::ERROR; }
+    bool is_tunnel() const { return state_ == State::TUNNEL; }
+    bool in_message() const { return state_ != State::START_LINE || !partial_line_.empty(); }
+
+private:
+    enum class State : uint8_t {
+        START_LINE,
+        HEADERS,
+        BODY,              // Content-Length bytes left in remaining_
+        CHUNK_SIZE,
+        CHUNK_DATA,        // Chunk bytes left in remaining_
+        CHUNK_DATA_END,    // CRLF after the chunk data
+        TRAILERS,
+        BODY_UNTIL_CLOSE,  // Response without framing
+        TUNNEL,
+        ERROR
+    };
+
+    static bool is_line_state(State state);
+
+    bool handle_line(const char* line, size_t len);
+    bool parse_request_line(const char* line, size_t len);
+    bool parse_status_line(const char* line, size_t len);
+    bool parse_header(const char* line, size_t len);
+    bool parse_chunk_size(const char* line, size_t len);
+    void finish_headers();
+    void complete_message();
+
+    bool is_request_;
+    Listener& listener_;
+    State state_ = State::START_LINE;
+    HttpMessage message_;
+    uint64_t remaining_ = 0;
+    std::string partial_line_;  // Line split across segments, without its LF
+};
+
+#endif // HTTP_PARSER_HPP
@@ -2,17 +2,69 @@
 #define PROTOCOL_ANALYZER_HPP
 
 #include "definitions/direction.hpp"
+#include "definitions/conn_info.hpp"
 #include <cstdint>
 #include <cstddef>
+#include <ostream>
+
+// Verdict of an analyzer probe on the first bytes of one direction
+enum class ProbeResult {
+    MATCH,      // Attach the analyzer to this connection
+    NO_MATCH,   // Never attach it to this connection
+    NEED_MORE   // Undecided, call again with more bytes
+};
+
+// Content sniffer registered next to an analyzer. data always starts at the
+// first byte of the direction and holds at most PROBE_BYTES bytes.
+using AnalyzerProbe = ProbeResult (*)(Direction dir, const uint8_t* data, size_t len);
+inline constexpr size_t PROBE_BYTES = 16;
+
+// Returned by on_data: what the analyzer wants from this direction next.
+// The analyzer has consumed everything it was handed; the hint covers the
+// bytes that follow and is applied by ParseHintGate.
+struct ParseHint {
+    enum class Kind : uint8_t {
+        MORE,  // Any amount of data
+        NEED,  // Hold data until bytes are available, then deliver at once
+        SKIP,  // Drop the next bytes unseen; the analyzer already accounted for them
+        DONE   // Nothing more from either direction
+    };
+
+    Kind kind = Kind::MORE;
+    size_t bytes = 0;
+
+    static constexpr ParseHint more() { return {}; }
+    static constexpr ParseHint need(size_t bytes) { return {Kind::NEED, bytes}; }
+    static constexpr ParseHint skip(size_t bytes) { return {Kind::SKIP, bytes}; }
+    static constexpr ParseHint done() { return {Kind::DONE, 0}; }
+};
 
 class IProtocolAnalyzer {
 public:
     virtual ~IProtocolAnalyzer() = default;
+
+    // Attached to a connection, before any data. info outlives the analyzer.
+    virtual void on_open(const ConnInfo& info) { (void)info; }
+
+    // Connection is going away or being compacted; no further calls follow
+    virtual void on_close(const ConnSummary& summary) { (void)summary; }
+
+    // Optional: Record what was learned before the analyzer is released by
+    // compaction. Only called once is_finished() holds.
+    virtual void summarize(CompactSummary& summary) const { (void)summary; }
+
+    // Optional: Write the current state as "name: ..." lines, for the
+    // control socket. Never called while data is being delivered.
+    virtual void describe(std::ostream& os) const { (void)os; }
     
     // Process reassembled data
-    virtual void on_data(Direction dir, 
-                        const uint8_t* data, 
-                        size_t len) = 0;
+    virtual ParseHint on_data(Direction dir, 
+                              const uint8_t* data, 
+                              size_t len) = 0;
+
+    // Optional: Report that no further data is needed for this connection,
+    // e.g. once a handshake has completed
+    virtual bool is_finished() const { return false; }
 
     // Optional: Handle connection events
     virtual void on_connection_reset() {}
@@ -6,12 +6,13 @@
 #include <fstream>
 #include <vector>
 #include <chrono>
+#include <atomic>
 #include <memory>
 #include <mutex>
 
 struct FlushPolicy {
     int max_updates = 1000;  // Flush after N updates
-    int max_minutes = 5;     // Flush after N minutes
+    int max_minutes = 5;     // Flush after N minutes of packet time
     size_t max_size = 10 * 1024 * 1024;  // 10 MB
 };
 
@@ -35,18 +36,29 @@ public:
     const std::string& get_filename() {
         return filename_;
     };
+    bool is_enabled() const {
+        return enabled_.load(std::memory_order_acquire) && open_.load(std::memory_order_acquire);
+    }
+    bool is_print_out() const { return print_out_.load(std::memory_order_relaxed); }
+    // Runtime switches; enabling opens the file if it never was
+    bool set_enabled(bool enabled);
+    void set_print_out(bool print_out) { print_out_.store(print_out, std::memory_order_relaxed); }
 
 private:
+    // Caller holds mutex_
+    void flush_locked();
     void check_size_and_truncate();
+    void open_locked();
 
     std::string filename_;
-    bool enabled_;
-    bool print_out_;
+    std::atomic<bool> enabled_{false};
+    std::atomic<bool> print_out_{false};
+    std::atomic<bool> open_{false};  // file_.is_open(), readable without mutex_
     FlushPolicy policy_;
     std::ofstream file_;
     std::vector<std::shared_ptr<LogEntry>> buffer_;
     int update_count_;
-    std::chrono::steady_clock::time_point last_flush_time_;
+    PacketClock::time_point last_flush_time_;
     std::mutex mutex_;
 };
 
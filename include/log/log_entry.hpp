@@ -2,6 +2,7 @@
 #define LOG_ENTRY_HPP
 
 #include "conn/connection_key.hpp"
+#include "misc/packet_clock.hpp"
 #include <sstream>
 #include <string>
 #include <chrono>
@@ -20,7 +21,7 @@ protected:
     
 private:
 	int utc_offset_ {0};	
-    std::chrono::system_clock::time_point timestamp_;
+    PacketClock::time_point timestamp_;  // Capture time of the packet being processed
     const ConnectionKey key_;
 };
 
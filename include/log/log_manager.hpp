@@ -5,6 +5,7 @@
 #include <string>
 #include <vector>
 #include <memory>
+#include <ostream>
 
 class LogManager {
 public:
@@ -15,6 +16,13 @@ public:
     bool init(bool enable, bool truncate, const std::vector<std::string>& print_out_logs);
     Log& get_registered_log(const std::string& filename);
 
+    // Runtime switches by channel, "tcp" for tcp.log; false if unknown.
+    // tls and reassm_data cannot be switched on or off after startup
+    bool set_enabled(const std::string& channel, bool enabled);
+    bool set_print_out(const std::string& channel, bool print_out);
+    // One line per channel
+    void describe(std::ostream& os);
+
 private:
     LogManager() = default;
     ~LogManager() = default;
@@ -4,6 +4,7 @@
 #include "log/log_entry.hpp"
 #include "definitions/packet_key.hpp"
 #include "conn/connection_key.hpp"
+#include <vector>
 
 class PacketLogEntry : public LogEntry {
 public:
@@ -11,7 +12,10 @@ public:
     std::string format() const override;
 
 private:
-    const PacketKey pkey_;
+    // Copied: the capture buffer is reused before the entry is flushed
+    size_t total_len_;
+    uint8_t flags_;
+    std::vector<uint8_t> payload_;
 };
 
 #endif // PACKET_LOG_ENTRY_HPP
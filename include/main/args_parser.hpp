@@ -9,8 +9,18 @@ struct ProgramOptions {
     bool truncate_log = false;
     int cleanup_interval_seconds = 5; // This can affect program exit waiting time.
     std::string filter = "tcp";
+    std::string read_file; // Replay this pcap file instead of capturing live
     std::vector<std::string> enabled_analyzers;
+    std::string port_policy; // "443,8443:tls;80:http"; overrides -a when set
+    int analyzer_workers = 0; // 0 runs analyzers on the capture thread
     std::vector<std::string> enabled_print_out_logs;
+    std::string event_file; // Typed analyzer events, one line each; empty disables the event bus
+    std::string stream_dir; // Raw streams of flows with the "stream" analyzer; empty disables capture
+    std::string metrics_endpoint; // "unix:PATH" or "http:PORT"; empty serves no metrics
+    std::string metrics_snapshot; // Prometheus text rewritten periodically; empty disables
+    std::string control_socket; // UNIX socket for runtime commands; empty disables
+    std::string checkpoint_file; // Connection table saved periodically and on exit, loaded at start
+    bool adopt_mid_stream = false; // Track flows first seen without a SYN
 };
 
 void check_default_argments(ProgramOptions& options);
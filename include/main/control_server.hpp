@@ -0,0 +1,65 @@
+#ifndef CONTROL_SERVER_HPP
+#define CONTROL_SERVER_HPP
+
+#include <pcap.h>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <istream>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+
+class ConnectionManager;
+class PortPolicy;
+
+// UNIX-domain control socket, served by its own thread one client at a
+// time. A client sends one command per line and gets its output followed
+// by "ok" or "error: ...". Commands that touch connection or capture state
+// are handed to the capture thread, which breaks out of pcap_loop to run
+// them between packets; "help" lists the commands.
+class ControlServer {
+public:
+    // How long a command waits for the capture thread
+    static constexpr int COMMAND_TIMEOUT_MS = 2000;
+
+    ControlServer(ConnectionManager& connection_manager, pcap_t* handle)
+        : connection_manager_(connection_manager), handle_(handle) {}
+    ~ControlServer();
+
+    bool start(const std::string& path);
+    // Call once the capture has ended, before the handle is closed
+    void stop();
+
+    // Capture thread: run the command waiting for it, if any
+    void run_pending();
+
+private:
+    void serve_loop();
+    void serve(int client);
+    // Empty on success, else the error
+    std::string execute(const std::string& line, std::ostream& out);
+    std::string list(std::istream& args, std::ostream& out);
+    std::string show(std::istream& args, std::ostream& out);
+    std::string set_log(std::istream& args, std::ostream& out);
+    std::string set_filter(const std::string& filter, std::ostream& out);
+    std::string set_analyzers(std::istream& args, std::ostream& out);
+    std::string set_policy(const std::string& spec, std::ostream& out);
+    std::string set_policy_on_capture_thread(PortPolicy policy, std::ostream& out);
+    std::string on_capture_thread(const std::function<void()>& job);
+
+    ConnectionManager& connection_manager_;
+    pcap_t* handle_;
+    std::string path_;
+    int listen_fd_ = -1;
+    std::thread thread_;
+    std::atomic<bool> running_{false};
+
+    std::mutex job_mutex_;
+    std::condition_variable job_cv_;
+    std::function<void()> job_;    // Set by the control thread, cleared once run
+    bool capture_done_ = false;
+};
+
+#endif // CONTROL_SERVER_HPP
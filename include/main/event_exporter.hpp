@@ -0,0 +1,23 @@
+#ifndef EVENT_EXPORTER_HPP
+#define EVENT_EXPORTER_HPP
+
+#include "definitions/analyzer_events.hpp"
+#include <fstream>
+#include <memory>
+#include <string>
+
+// EventBus subscriber writing one text line per event to a file. Runs on
+// the bus dispatch thread, so formatting stays off the capture path.
+class EventExporter {
+public:
+    bool open(const std::string& path);
+    void operator()(const AnalyzerEvent* events, size_t count);
+
+private:
+    void write(const AnalyzerEvent& event);
+
+    // Shared so copies handed to the bus keep writing the same file
+    std::shared_ptr<std::ofstream> file_;
+};
+
+#endif // EVENT_EXPORTER_HPP
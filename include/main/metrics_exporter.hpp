@@ -0,0 +1,42 @@
+#ifndef METRICS_EXPORTER_HPP
+#define METRICS_EXPORTER_HPP
+
+#include "misc/metrics_registry.hpp"
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+
+// Scraper thread for MetricsRegistry. Serves the Prometheus text format on
+// an endpoint, "unix:PATH" (the text, then close) or "http:PORT" (HTTP/1.0
+// on 127.0.0.1), and optionally rewrites a snapshot file every
+// SCRAPE_INTERVAL_MS. Starting it turns stage timing on.
+class MetricsExporter {
+public:
+    static constexpr int SCRAPE_INTERVAL_MS = 5000;
+
+    ~MetricsExporter();
+
+    // Either argument may be empty, not both
+    bool start(const std::string& endpoint, const std::string& snapshot_file);
+    // Writes a last snapshot
+    void stop();
+
+private:
+    bool listen_unix(const std::string& path);
+    bool listen_http(const std::string& port);
+    void scrape_loop();
+    std::string render();
+    void serve(int client, const std::string& text);
+    void write_snapshot(const std::string& text);
+
+    std::string snapshot_file_;
+    std::string unix_path_;
+    bool http_ = false;
+    int listen_fd_ = -1;
+    std::thread thread_;
+    std::atomic<bool> running_{false};
+    std::unique_ptr<MetricsRegistry::Snapshot> snapshot_;  // Scraper thread only
+};
+
+#endif // METRICS_EXPORTER_HPP
@@ -2,9 +2,16 @@
 #define PCAP_HANDLER_HPP
 
 #include <pcap.h>
+#include <functional>
+#include <ostream>
 #include <string>
 
-pcap_t* initialize_pcap(const std::string& filter);
-void run_packet_capture(pcap_t* handle, u_char* processor);
+// Live capture on en1, or a pcap file when read_file is set
+pcap_t* initialize_pcap(const std::string& filter, const std::string& read_file = "");
+// Compile and swap in a BPF filter; the old one stays on failure
+bool install_filter(pcap_t* handle, const std::string& filter, std::ostream& err);
+// Runs until the file ends or pcap_breakloop() is called. After a break
+// the capture resumes if on_break() returns true. The caller closes the handle.
+void run_packet_capture(pcap_t* handle, u_char* processor, const std::function<bool()>& on_break = nullptr);
 
 #endif // PCAP_HANDLER_HPP
@@ -0,0 +1,63 @@
+#ifndef ATOMIC_HISTOGRAM_HPP
+#define ATOMIC_HISTOGRAM_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+// Lock-free log-linear histogram: each power of two range is split into
+// SUB_BUCKETS linear buckets, bounding the relative error to 1/SUB_BUCKETS.
+// Safe to record from any thread; reads are approximate while recording.
+class AtomicHistogram {
+public:
+    static constexpr size_t SUB_BUCKET_BITS = 2;
+    static constexpr size_t SUB_BUCKETS = size_t(1) << SUB_BUCKET_BITS;
+    static constexpr size_t MAGNITUDES = 40;
+    static constexpr size_t BUCKET_COUNT = MAGNITUDES * SUB_BUCKETS;
+
+    void record(uint64_t value) {
+        buckets_[bucket_index(value)].fetch_add(1, std::memory_order_relaxed);
+        count_.fetch_add(1, std::memory_order_relaxed);
+        sum_.fetch_add(value, std::memory_order_relaxed);
+    }
+
+    uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+    uint64_t sum() const { return sum_.load(std::memory_order_relaxed); }
+    uint64_t bucket_count(size_t index) const { return buckets_[index].load(std::memory_order_relaxed); }
+
+    // Upper bound of the bucket holding the q-th quantile (0 <= q <= 1)
+    uint64_t percentile(double q) const {
+        uint64_t total = count();
+        if (total == 0) return 0;
+        uint64_t rank = static_cast<uint64_t>(q * (total - 1)) + 1;
+        uint64_t seen = 0;
+        for (size_t i = 0; i < BUCKET_COUNT; ++i) {
+            seen += bucket_count(i);
+            if (seen >= rank) return bucket_upper_bound(i);
+        }
+        return bucket_upper_bound(BUCKET_COUNT - 1);
+    }
+
+    static size_t bucket_index(uint64_t value) {
+        if (value < SUB_BUCKETS) return static_cast<size_t>(value);
+        size_t magnitude = 63 - __builtin_clzll(value);  // value >= SUB_BUCKETS
+        size_t shift = magnitude - SUB_BUCKET_BITS;
+        size_t index = (shift + 1) * SUB_BUCKETS + ((value >> shift) & (SUB_BUCKETS - 1));
+        return index < BUCKET_COUNT ? index : BUCKET_COUNT - 1;
+    }
+
+    // Largest value that lands in the bucket
+    static uint64_t bucket_upper_bound(size_t index) {
+        if (index < SUB_BUCKETS) return index;
+        size_t shift = index / SUB_BUCKETS - 1;
+        uint64_t base = (SUB_BUCKETS + index % SUB_BUCKETS) << shift;
+        return base + (uint64_t(1) << shift) - 1;
+    }
+
+private:
+    std::atomic<uint64_t> buckets_[BUCKET_COUNT] = {};
+    std::atomic<uint64_t> count_{0};
+    std::atomic<uint64_t> sum_{0};
+};
+
+#endif // ATOMIC_HISTOGRAM_HPP
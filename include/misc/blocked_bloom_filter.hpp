@@ -0,0 +1,72 @@
+#ifndef BLOCKED_BLOOM_FILTER_HPP
+#define BLOCKED_BLOOM_FILTER_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Split block Bloom filter over 64-bit hashes. The high half of a hash
+// picks one 64-byte block and the low half one bit in each of its eight
+// words, so an insert or lookup touches a single cache line. Not thread safe.
+class BlockedBloomFilter {
+public:
+    // Rounded up to a power of two
+    explicit BlockedBloomFilter(size_t blocks) : blocks_(round_up(blocks)), mask_(blocks_.size() - 1) {}
+
+    void insert(uint64_t hash) {
+        Block& block = blocks_[index(hash)];
+        for (size_t i = 0; i < WORDS; ++i) {
+            block.words[i] |= bit(hash, i);
+        }
+    }
+
+    // False positives possible, false negatives not
+    bool contains(uint64_t hash) const {
+        const Block& block = blocks_[index(hash)];
+        for (size_t i = 0; i < WORDS; ++i) {
+            if (!(block.words[i] & bit(hash, i))) return false;
+        }
+        return true;
+    }
+
+    void clear() { std::fill(blocks_.begin(), blocks_.end(), Block{}); }
+    // Empty, with room for blocks; reallocates only when the size changes
+    void reset(size_t blocks) {
+        size_t size = round_up(blocks);
+        if (size == blocks_.size()) {
+            clear();
+            return;
+        }
+        blocks_.assign(size, Block{});
+        mask_ = size - 1;
+    }
+    size_t size_bytes() const { return blocks_.size() * sizeof(Block); }
+
+private:
+    static constexpr size_t WORDS = 8;
+    // Odd multipliers spreading the low half over each word's 64 bits
+    static constexpr std::array<uint32_t, WORDS> SALT = {
+        0x47b6137bu, 0x44974d91u, 0x8824ad5bu, 0xa2b7289du,
+        0x705495c7u, 0x2df1424bu, 0x9efc4947u, 0x5c6bfb31u};
+
+    struct alignas(64) Block {
+        std::array<uint64_t, WORDS> words{};
+    };
+
+    static size_t round_up(size_t blocks) {
+        size_t size = 1;
+        while (size < blocks) size <<= 1;
+        return size;
+    }
+    size_t index(uint64_t hash) const { return static_cast<size_t>(hash >> 32) & mask_; }
+    static uint64_t bit(uint64_t hash, size_t i) {
+        return uint64_t{1} << ((static_cast<uint32_t>(hash) * SALT[i]) >> 26);
+    }
+
+    std::vector<Block> blocks_;
+    size_t mask_;
+};
+
+#endif // BLOCKED_BLOOM_FILTER_HPP
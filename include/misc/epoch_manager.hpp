@@ -0,0 +1,77 @@
+#ifndef EPOCH_MANAGER_HPP
+#define EPOCH_MANAGER_HPP
+
+#include "misc/packet_clock.hpp"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Epoch-based reclamation. Readers wrap their accesses in an EpochGuard,
+// which only stores the current epoch into the thread's own slot. A writer
+// unlinks an object, hands it to retire(), and reclaim() later frees it
+// once every reader that could still see it has left its guard. Reclaimed
+// objects are destroyed on the thread calling reclaim(), with its
+// PacketClock set to the packet time at which they were retired.
+class EpochManager {
+public:
+    static EpochManager& get_instance();
+
+    template <typename T>
+    void retire(std::unique_ptr<T> object) {
+        if (object) retire_node(std::make_unique<Node<T>>(std::move(object)));
+    }
+    // Frees what no reader can reach any more
+    void reclaim();
+    // Waits out the current readers, then frees everything retired so far
+    void synchronize();
+
+private:
+    friend class EpochGuard;
+
+    struct Retired {
+        virtual ~Retired() = default;
+        uint64_t epoch = 0;
+        PacketClock::time_point retired_at{};
+    };
+    template <typename T>
+    struct Node : Retired {
+        explicit Node(std::unique_ptr<T> object) : object(std::move(object)) {}
+        std::unique_ptr<T> object;
+    };
+
+    struct alignas(64) ReaderSlot {
+        std::atomic<uint64_t> epoch{0};  // 0 while outside a guard
+        unsigned depth = 0;              // Owning thread only
+    };
+
+    EpochManager() = default;
+    EpochManager(const EpochManager&) = delete;
+    EpochManager& operator=(const EpochManager&) = delete;
+
+    void retire_node(std::unique_ptr<Retired> node);
+    // Oldest epoch a reader is still in, or UINT64_MAX
+    uint64_t oldest_reader() const;
+    ReaderSlot& local();
+
+    std::atomic<uint64_t> epoch_{1};
+    mutable std::mutex readers_mutex_;
+    std::vector<std::unique_ptr<ReaderSlot>> readers_;  // Never shrinks; slots outlive their threads
+    std::mutex retired_mutex_;
+    std::vector<std::unique_ptr<Retired>> retired_;
+};
+
+// Pins the current epoch for its scope. Guards nest.
+class EpochGuard {
+public:
+    EpochGuard();
+    ~EpochGuard();
+    EpochGuard(const EpochGuard&) = delete;
+    EpochGuard& operator=(const EpochGuard&) = delete;
+
+private:
+    EpochManager::ReaderSlot& slot_;
+};
+
+#endif // EPOCH_MANAGER_HPP
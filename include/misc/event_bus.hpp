@@ -0,0 +1,76 @@
+#ifndef EVENT_BUS_HPP
+#define EVENT_BUS_HPP
+
+#include "definitions/analyzer_events.hpp"
+#include "misc/spsc_queue.hpp"
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <thread>
+#include <vector>
+
+// Delivers AnalyzerEvents from any thread to subscribers on one dispatch
+// thread. Every publishing thread owns an SPSC ring, so publishing is lock
+// free; a full ring drops the event and counts it. Without subscribers the
+// bus never starts; publishers check is_running() before building an
+// event, so an unwanted event costs a single relaxed load.
+class EventBus {
+public:
+    static constexpr size_t RING_CAPACITY = 4096;  // Per publishing thread
+    static constexpr size_t BATCH_SIZE = 256;
+
+    // Called on the dispatch thread with up to BATCH_SIZE events of one ring
+    using Subscriber = std::function<void(const AnalyzerEvent* events, size_t count)>;
+
+    static EventBus& get_instance();
+
+    // Register before start()
+    void subscribe(Subscriber subscriber);
+    void start();
+    // Deliver what is queued and join the dispatch thread
+    void stop();
+
+    bool is_running() const { return running_.load(std::memory_order_relaxed); }
+
+    void publish(const AnalyzerEvent& event) {
+        if (!running_.load(std::memory_order_relaxed)) {
+            return;
+        }
+        if (local_ring().try_push(event)) {
+            published_.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    // Human readable counters
+    void report(std::ostream& os) const;
+
+private:
+    using Ring = SpscQueue<AnalyzerEvent>;
+
+    EventBus() = default;
+    ~EventBus();
+    EventBus(const EventBus&) = delete;
+    EventBus& operator=(const EventBus&) = delete;
+
+    Ring& local_ring();
+    // Returns the number of events delivered
+    size_t drain();
+    void dispatch_loop();
+
+    std::vector<Subscriber> subscribers_;
+    std::mutex rings_mutex_;
+    std::vector<std::unique_ptr<Ring>> rings_;  // Never shrinks; rings outlive their threads
+    std::vector<Ring*> drain_rings_;            // Dispatch thread's copy of rings_
+    std::thread thread_;
+    std::atomic<bool> running_{false};
+
+    std::atomic<uint64_t> published_{0};
+    std::atomic<uint64_t> dropped_{0};
+};
+
+#endif // EVENT_BUS_HPP
@@ -0,0 +1,19 @@
+#ifndef FNV1A_HPP
+#define FNV1A_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+// 32-bit FNV-1a over ASCII-lowercased bytes, for compact ids of host names
+// that compare case-insensitively. 0 is kept free to mean "no name".
+constexpr uint32_t fnv1a_32_lower(const uint8_t* data, size_t len) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < len; ++i) {
+        uint8_t c = data[i];
+        if (c >= 'A' && c <= 'Z') c = static_cast<uint8_t>(c - 'A' + 'a');
+        hash = (hash ^ c) * 16777619u;
+    }
+    return hash != 0 ? hash : 1;
+}
+
+#endif // FNV1A_HPP
@@ -0,0 +1,87 @@
+#ifndef HDR_HISTOGRAM_HPP
+#define HDR_HISTOGRAM_HPP
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Log-linear bucket layout in the style of HdrHistogram: each power of two
+// range is split into SUB_BUCKETS linear buckets, so any recorded value is
+// known to within 1/SUB_BUCKETS (about 3%).
+struct HdrBuckets {
+    static constexpr size_t SUB_BUCKET_BITS = 5;
+    static constexpr size_t SUB_BUCKETS = size_t(1) << SUB_BUCKET_BITS;
+    static constexpr size_t MAGNITUDES = 40;
+    static constexpr size_t COUNT = MAGNITUDES * SUB_BUCKETS;
+
+    static size_t index(uint64_t value) {
+        if (value < SUB_BUCKETS) return static_cast<size_t>(value);
+        size_t magnitude = 63 - __builtin_clzll(value);  // value >= SUB_BUCKETS
+        size_t shift = magnitude - SUB_BUCKET_BITS;
+        size_t index = (shift + 1) * SUB_BUCKETS + ((value >> shift) & (SUB_BUCKETS - 1));
+        return index < COUNT ? index : COUNT - 1;
+    }
+
+    // Largest value that lands in the bucket
+    static uint64_t upper_bound(size_t index) {
+        if (index < SUB_BUCKETS) return index;
+        size_t shift = index / SUB_BUCKETS - 1;
+        uint64_t base = (SUB_BUCKETS + index % SUB_BUCKETS) << shift;
+        return base + (uint64_t(1) << shift) - 1;
+    }
+};
+
+// Histogram with a single recording thread. Recording is plain loads and
+// stores, no locked instructions; other threads may read it concurrently
+// and see a slightly stale state.
+class HdrHistogram {
+public:
+    void record(uint64_t value) {
+        bump(buckets_[HdrBuckets::index(value)], 1);
+        bump(count_, 1);
+        bump(sum_, value);
+    }
+
+    uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+    uint64_t sum() const { return sum_.load(std::memory_order_relaxed); }
+    uint64_t bucket_count(size_t index) const { return buckets_[index].load(std::memory_order_relaxed); }
+
+private:
+    static void bump(std::atomic<uint64_t>& value, uint64_t n) {
+        value.store(value.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+
+    std::array<std::atomic<uint64_t>, HdrBuckets::COUNT> buckets_{};
+    std::atomic<uint64_t> count_{0};
+    std::atomic<uint64_t> sum_{0};
+};
+
+// Sum of several HdrHistograms, e.g. one per thread
+struct HdrSnapshot {
+    std::array<uint64_t, HdrBuckets::COUNT> buckets{};
+    uint64_t count = 0;
+    uint64_t sum = 0;
+
+    void add(const HdrHistogram& histogram) {
+        for (size_t i = 0; i < HdrBuckets::COUNT; ++i) {
+            buckets[i] += histogram.bucket_count(i);
+        }
+        count += histogram.count();
+        sum += histogram.sum();
+    }
+
+    // Upper bound of the bucket holding the q-th quantile (0 <= q <= 1)
+    uint64_t percentile(double q) const {
+        if (count == 0) return 0;
+        uint64_t rank = static_cast<uint64_t>(q * (count - 1)) + 1;
+        uint64_t seen = 0;
+        for (size_t i = 0; i < HdrBuckets::COUNT; ++i) {
+            seen += buckets[i];
+            if (seen >= rank) return HdrBuckets::upper_bound(i);
+        }
+        return HdrBuckets::upper_bound(HdrBuckets::COUNT - 1);
+    }
+};
+
+#endif // HDR_HISTOGRAM_HPP
@@ -0,0 +1,125 @@
+#ifndef METRICS_REGISTRY_HPP
+#define METRICS_REGISTRY_HPP
+
+#include "misc/hdr_histogram.hpp"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+// Monotonic event counts
+enum class MetricCounter : size_t {
+    PACKETS_RECEIVED,
+    BYTES_RECEIVED,
+    PACKETS_INVALID,       // Rejected by validate_packet
+    PACKETS_MALFORMED,     // Rejected by extract_packet
+    CONNECTIONS_CREATED,
+    CONNECTION_MISSES,     // Mid-stream packet of an unknown connection
+    SEGMENTS_OUT_OF_ORDER, // Buffered by reassembly
+    CONNECTIONS_RESTORED,  // Loaded from a checkpoint
+    CONNECTIONS_ADOPTED,   // Created mid-stream, without a SYN
+    NEGATIVE_CACHE_HITS,   // Misses answered without the connection table
+    NEGATIVE_CACHE_FALSE_POSITIVES, // Negative cache hits on tracked connections
+    COUNT
+};
+
+// Levels; each thread keeps its own delta, the sum is the level
+enum class MetricGauge : size_t {
+    CONNECTIONS_ACTIVE,
+    REASSEMBLY_BUFFERED_BYTES,
+    REASSEMBLY_BUFFERED_SEGMENTS,
+    COUNT
+};
+
+// Latency histograms, nanoseconds of wall time per packet or chunk
+enum class MetricStage : size_t {
+    DECODE,      // validate_packet and extract_packet
+    LOOKUP,      // create_or_get_connection
+    REASSEMBLY,  // Reassembly::process, inline analyzers included
+    ANALYZER,    // One chunk through the analyzers of a connection
+    COUNT
+};
+
+// Process-wide metrics. Every thread that records owns a cache-line aligned
+// block, so recording never contends; scrape() sums the blocks. Stage
+// timing costs two clock reads and only runs once enable_timing() is called.
+class MetricsRegistry {
+public:
+    struct Snapshot {
+        std::array<uint64_t, static_cast<size_t>(MetricCounter::COUNT)> counters{};
+        std::array<int64_t, static_cast<size_t>(MetricGauge::COUNT)> gauges{};
+        std::array<HdrSnapshot, static_cast<size_t>(MetricStage::COUNT)> stages{};
+    };
+
+    static MetricsRegistry& get_instance();
+
+    void add(MetricCounter counter, uint64_t n = 1) {
+        bump(local().counters[static_cast<size_t>(counter)], n);
+    }
+    void add(MetricGauge gauge, int64_t delta) {
+        bump(local().gauges[static_cast<size_t>(gauge)], delta);
+    }
+    void record(MetricStage stage, uint64_t ns) {
+        local().stages[static_cast<size_t>(stage)].record(ns);
+    }
+
+    void enable_timing() { timing_.store(true, std::memory_order_relaxed); }
+    bool is_timing() const { return timing_.load(std::memory_order_relaxed); }
+
+    // Sum over all threads
+    void scrape(Snapshot& snapshot) const;
+    // Prometheus text exposition format 0.0.4
+    static void write_prometheus(const Snapshot& snapshot, std::ostream& os);
+
+private:
+    struct alignas(64) ThreadMetrics {
+        std::array<std::atomic<uint64_t>, static_cast<size_t>(MetricCounter::COUNT)> counters{};
+        std::array<std::atomic<int64_t>, static_cast<size_t>(MetricGauge::COUNT)> gauges{};
+        std::array<HdrHistogram, static_cast<size_t>(MetricStage::COUNT)> stages;
+    };
+
+    MetricsRegistry() = default;
+    MetricsRegistry(const MetricsRegistry&) = delete;
+    MetricsRegistry& operator=(const MetricsRegistry&) = delete;
+
+    // Single writer: no locked read-modify-write needed
+    template <typename T>
+    static void bump(std::atomic<T>& value, T n) {
+        value.store(value.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+
+    ThreadMetrics& local();
+
+    mutable std::mutex threads_mutex_;
+    std::vector<std::unique_ptr<ThreadMetrics>> threads_;  // Never shrinks; blocks outlive their threads
+    std::atomic<bool> timing_{false};
+};
+
+// Records the wall time of its scope into a MetricStage while timing is on
+class StageTimer {
+public:
+    explicit StageTimer(MetricStage stage)
+        : stage_(stage), timing_(MetricsRegistry::get_instance().is_timing()) {
+        if (timing_) start_ = std::chrono::steady_clock::now();
+    }
+    ~StageTimer() {
+        if (timing_) {
+            auto elapsed = std::chrono::steady_clock::now() - start_;
+            MetricsRegistry::get_instance().record(stage_,
+                std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+        }
+    }
+    StageTimer(const StageTimer&) = delete;
+    StageTimer& operator=(const StageTimer&) = delete;
+
+private:
+    MetricStage stage_;
+    bool timing_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+#endif // METRICS_REGISTRY_HPP
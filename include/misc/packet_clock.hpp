@@ -0,0 +1,30 @@
+#ifndef PACKET_CLOCK_HPP
+#define PACKET_CLOCK_HPP
+
+#include <chrono>
+#include <sys/time.h>
+
+// Clock driven by capture timestamps (pcap_pkthdr::ts) rather than the
+// host clock. now() is the time of the packet being processed on the
+// calling thread, so analyzers measure latencies in packet time.
+class PacketClock {
+public:
+    using duration = std::chrono::microseconds;
+    using rep = duration::rep;
+    using period = duration::period;
+    using time_point = std::chrono::time_point<PacketClock>;
+    static constexpr bool is_steady = false;
+
+    static time_point now() { return current_; }
+
+    static void advance(const struct timeval& ts) {
+        current_ = time_point(std::chrono::seconds(ts.tv_sec) + duration(ts.tv_usec));
+    }
+
+    static void set(time_point tp) { current_ = tp; }
+
+private:
+    static inline thread_local time_point current_{};
+};
+
+#endif // PACKET_CLOCK_HPP
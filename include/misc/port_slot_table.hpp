@@ -0,0 +1,49 @@
+#ifndef PORT_SLOT_TABLE_HPP
+#define PORT_SLOT_TABLE_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+// Fixed-size open-addressed table of per-port slots, claimed lock-free on
+// first use. Once all N slots are taken, further ports share one overflow
+// slot reported as port 0. Slots are never released.
+template <typename Slot, size_t N>
+class PortSlotTable {
+public:
+    Slot& get(uint16_t port) {
+        uint32_t tag = uint32_t(port) + 1;  // 0 marks a free slot
+        size_t start = (port * 0x9e3779b1u) % N;
+        for (size_t probe = 0; probe < N; ++probe) {
+            size_t i = (start + probe) % N;
+            uint32_t current = ports_[i].load(std::memory_order_acquire);
+            if (current == 0 &&
+                ports_[i].compare_exchange_strong(current, tag, std::memory_order_acq_rel)) {
+                return slots_[i];
+            }
+            if (current == tag) {
+                return slots_[i];
+            }
+        }
+        return overflow_;
+    }
+
+    // f(uint16_t port, const Slot& slot) for each claimed slot
+    template <typename F>
+    void for_each(F&& f) const {
+        for (size_t i = 0; i < N; ++i) {
+            uint32_t tag = ports_[i].load(std::memory_order_acquire);
+            if (tag != 0) {
+                f(static_cast<uint16_t>(tag - 1), slots_[i]);
+            }
+        }
+        f(uint16_t(0), overflow_);
+    }
+
+private:
+    std::atomic<uint32_t> ports_[N] = {};
+    Slot slots_[N];
+    Slot overflow_;
+};
+
+#endif // PORT_SLOT_TABLE_HPP
@@ -0,0 +1,30 @@
+#ifndef SHA256_HPP
+#define SHA256_HPP
+
+#include <array>
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+// Minimal SHA-256 (FIPS 180-4), used for certificate fingerprints
+class Sha256 {
+public:
+    using Digest = std::array<uint8_t, 32>;
+
+    Sha256();
+    void update(const uint8_t* data, size_t len);
+    Digest finish();
+
+    static Digest digest(const uint8_t* data, size_t len);
+    static std::string to_hex(const Digest& digest);
+
+private:
+    void transform(const uint8_t* block);
+
+    uint32_t state_[8];
+    uint8_t block_[64];
+    size_t block_len_;
+    uint64_t total_len_;
+};
+
+#endif // SHA256_HPP
@@ -0,0 +1,65 @@
+#ifndef SPSC_QUEUE_HPP
+#define SPSC_QUEUE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+// Bounded lock-free queue for exactly one producer and one consumer thread.
+// Capacity is rounded up to a power of two.
+template <typename T>
+class SpscQueue {
+public:
+    explicit SpscQueue(size_t capacity) {
+        size_t size = 1;
+        while (size < capacity) size <<= 1;
+        slots_.resize(size);
+        mask_ = size - 1;
+    }
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    // Producer side; false when full
+    bool try_push(const T& item) {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - head_cache_ > mask_) {
+            head_cache_ = head_.load(std::memory_order_acquire);
+            if (tail - head_cache_ > mask_) return false;
+        }
+        slots_[tail & mask_] = item;
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side; false when empty
+    bool try_pop(T& item) {
+        size_t head = head_.load(std::memory_order_relaxed);
+        if (head == tail_cache_) {
+            tail_cache_ = tail_.load(std::memory_order_acquire);
+            if (head == tail_cache_) return false;
+        }
+        item = slots_[head & mask_];
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    size_t capacity() const { return mask_ + 1; }
+
+    // Exact only when called from the producer or consumer while the other is idle
+    size_t size() const {
+        return tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire);
+    }
+
+private:
+    std::vector<T> slots_;
+    size_t mask_ = 0;
+    // Producer and consumer indices on separate cache lines, each with the
+    // owning side's cached copy of the other index
+    alignas(64) std::atomic<size_t> tail_{0};
+    size_t head_cache_ = 0;
+    alignas(64) std::atomic<size_t> head_{0};
+    size_t tail_cache_ = 0;
+};
+
+#endif // SPSC_QUEUE_HPP
@@ -9,10 +9,13 @@ public:
     static void register_default_analyzers();
     static void register_tls_analyzer();
     static void register_reassm_analyzer();
+    static void register_http_analyzer();
+    static void register_stream_analyzer();
     static void register_custom_analyzer(
         const std::string& name,
         AnalyzerRegistry::AnalyzerCreator creator,
-        const std::string& description = "");
+        const std::string& description = "",
+        AnalyzerProbe probe = nullptr);
 };
 
 #endif // ANALYZER_REGISTRAR_HPP
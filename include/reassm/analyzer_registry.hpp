@@ -2,34 +2,44 @@
 #define ANALYZER_REGISTRY_HPP
 
 #include "interfaces/protocol_analyzer.hpp"
-#include "conn/connection_key.hpp"
 #include <unordered_map>
-#include <functional>
 #include <memory>
 #include <vector>
 #include <string>
 
 class AnalyzerRegistry {
 public:
-    using AnalyzerCreator = std::function<std::shared_ptr<IProtocolAnalyzer>(const ConnectionKey&)>;
+    // Plain function pointer: no std::function dispatch per connection.
+    // The connection is handed over afterwards through on_open.
+    using AnalyzerCreator = std::shared_ptr<IProtocolAnalyzer> (*)();
     using AnalyzerConfig = std::unordered_map<std::string, std::string>;
 
+    // Everything needed to attach an analyzer, resolved once by name
+    struct AnalyzerFactory {
+        std::string name;
+        AnalyzerCreator creator;
+        AnalyzerProbe probe = nullptr;  // nullptr attaches to every connection
+        int static_slot = -1;           // Slot in StaticAnalyzers, static builds only
+    };
+
     static AnalyzerRegistry& get_instance();
 
     // Register a new analyzer type
     void register_analyzer(const std::string& name, 
                          AnalyzerCreator creator, 
-                         const std::string& description = "");
+                         const std::string& description = "",
+                         AnalyzerProbe probe = nullptr,
+                         int static_slot = -1);
+
+    // Resolve analyzer names to factories; unknown names are skipped
+    std::vector<AnalyzerFactory> get_factories(const std::vector<std::string>& analyzer_names) const;
 
     // Create analyzers based on names
     std::vector<std::shared_ptr<IProtocolAnalyzer>> create_analyzers(
-        const ConnectionKey& key,
         const std::vector<std::string>& analyzer_names) const;
 
     // Create a single analyzer
-    std::shared_ptr<IProtocolAnalyzer> create_analyzer(
-        const std::string& name,
-        const ConnectionKey& key) const;
+    std::shared_ptr<IProtocolAnalyzer> create_analyzer(const std::string& name) const;
 
     // Get list of registered analyzers
     std::vector<std::string> get_registered_analyzers() const;
@@ -50,6 +60,8 @@ private:
     struct AnalyzerInfo {
         AnalyzerCreator creator;
         std::string description;
+        AnalyzerProbe probe;
+        int static_slot;
     };
 
     std::unordered_map<std::string, AnalyzerInfo> analyzers_;
@@ -0,0 +1,86 @@
+#ifndef ANALYZER_WORKER_POOL_HPP
+#define ANALYZER_WORKER_POOL_HPP
+
+#include "definitions/direction.hpp"
+#include "misc/packet_clock.hpp"
+#include "misc/spsc_queue.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <thread>
+#include <vector>
+
+class ProtocolHandler;
+
+// Fixed-size chunk of reassembled payload handed to a worker
+struct AnalyzerBuffer {
+    static constexpr size_t SIZE = 2048;
+    uint8_t data[SIZE];
+};
+
+struct AnalyzerTask {
+    enum class Type : uint8_t { DATA, RESET, CLOSED };
+
+    ProtocolHandler* handler = nullptr;
+    AnalyzerBuffer* buffer = nullptr;  // DATA only, returned to the pool after use
+    uint16_t len = 0;
+    Type type = Type::DATA;
+    Direction dir = Direction::CLIENT_TO_SERVER;
+    PacketClock::time_point time;      // Packet time on the capture thread, replayed on the worker
+};
+
+// Runs analyzers off the capture thread. Every connection is pinned to one
+// worker and fed through that worker's SPSC queue, which keeps its data in
+// order. Only the capture thread may post; when a worker falls behind,
+// posting fails and the connection degrades to header-only tracking.
+class AnalyzerWorkerPool {
+public:
+    static constexpr size_t QUEUE_CAPACITY = 1024;
+    static constexpr size_t BUFFERS_PER_WORKER = 1024;
+
+    static AnalyzerWorkerPool& get_instance();
+
+    // Start the workers; 0 keeps analyzers on the capture thread
+    void start(size_t workers);
+    // Finish queued work and join the workers; later posts fail
+    void stop();
+    size_t worker_count() const { return workers_.size(); }
+
+    // Copy data into pooled buffers and queue it; all or nothing
+    bool post_data(size_t worker, ProtocolHandler* handler, Direction dir, const uint8_t* data, size_t len);
+    bool post_event(size_t worker, ProtocolHandler* handler, AnalyzerTask::Type type);
+
+    void record_degraded() { degraded_connections_.fetch_add(1, std::memory_order_relaxed); }
+
+    // Human readable counters
+    void report(std::ostream& os) const;
+
+private:
+    struct Worker {
+        explicit Worker(size_t return_capacity) : tasks(QUEUE_CAPACITY), returned(return_capacity) {}
+        SpscQueue<AnalyzerTask> tasks;        // Capture thread -> worker
+        SpscQueue<AnalyzerBuffer*> returned;  // Worker -> capture thread
+        std::thread thread;
+    };
+
+    AnalyzerWorkerPool() = default;
+    ~AnalyzerWorkerPool();
+    AnalyzerWorkerPool(const AnalyzerWorkerPool&) = delete;
+    AnalyzerWorkerPool& operator=(const AnalyzerWorkerPool&) = delete;
+
+    size_t reclaim_buffers();
+    void worker_loop(Worker& worker);
+
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::unique_ptr<AnalyzerBuffer[]> storage_;
+    std::vector<AnalyzerBuffer*> free_buffers_;  // Capture thread only
+    std::atomic<bool> running_{false};
+
+    std::atomic<uint64_t> tasks_posted_{0};
+    std::atomic<uint64_t> chunks_dropped_{0};
+    std::atomic<uint64_t> degraded_connections_{0};
+};
+
+#endif // ANALYZER_WORKER_POOL_HPP
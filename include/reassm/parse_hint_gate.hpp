@@ -0,0 +1,58 @@
+#ifndef PARSE_HINT_GATE_HPP
+#define PARSE_HINT_GATE_HPP
+
+#include "interfaces/protocol_analyzer.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Applies the ParseHints of one analyzer to one direction of its input:
+// holds data until a NEED is met, drops SKIPped bytes without copying
+// them, and stops at DONE. Data meeting a NEED on its own is passed through
+// in place; only bytes of a requirement split across segments are copied.
+class ParseHintGate {
+public:
+    // deliver(const uint8_t* data, size_t len) -> ParseHint
+    template <typename Deliver>
+    void feed(const uint8_t* data, size_t len, Deliver&& deliver) {
+        if (hint_.kind == ParseHint::Kind::DONE) {
+            return;
+        }
+
+        if (hint_.kind == ParseHint::Kind::SKIP) {
+            size_t skip = std::min(hint_.bytes, len);
+            data += skip;
+            len -= skip;
+            hint_.bytes -= skip;
+            if (hint_.bytes > 0) {
+                return;
+            }
+            hint_ = ParseHint::more();
+        }
+        if (len == 0) {
+            return;
+        }
+
+        if (hint_.kind == ParseHint::Kind::NEED && held_.size() + len < hint_.bytes) {
+            held_.insert(held_.end(), data, data + len);
+            return;
+        }
+
+        if (held_.empty()) {
+            hint_ = deliver(data, len);
+        } else {
+            held_.insert(held_.end(), data, data + len);
+            hint_ = deliver(held_.data(), held_.size());
+            held_.clear();
+        }
+    }
+
+    bool is_done() const { return hint_.kind == ParseHint::Kind::DONE; }
+
+private:
+    ParseHint hint_;
+    std::vector<uint8_t> held_;
+};
+
+#endif // PARSE_HINT_GATE_HPP
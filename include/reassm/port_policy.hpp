@@ -0,0 +1,50 @@
+#ifndef PORT_POLICY_HPP
+#define PORT_POLICY_HPP
+
+#include "reassm/analyzer_registry.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Server port -> analyzer set, compiled at startup into a flat table so a
+// new connection costs one array index. Ports without analyzers skip
+// reassembly altogether.
+class PortPolicy {
+public:
+    using FactoryList = std::vector<AnalyzerRegistry::AnalyzerFactory>;
+
+    PortPolicy();
+
+    // Every port gets the same analyzers
+    void assign_all(const std::vector<std::string>& analyzer_names);
+
+    // "443,8443:tls;80,8000-8099:http;*:reassm". Later entries override
+    // earlier ones, '*' covers every port not listed. Returns false on a
+    // malformed spec.
+    bool parse(const std::string& spec);
+
+    const FactoryList& lookup(uint16_t server_port) const { return lists_[table_[server_port]]; }
+    // Only analyzers the spec names the port for, not those of '*' or
+    // assign_all(); for connections whose start was not seen
+    const FactoryList& lookup_explicit(uint16_t server_port) const {
+        return explicit_ports_[server_port] ? lookup(server_port) : lists_[0];
+    }
+
+    // Human readable summary of the compiled table
+    std::string describe() const;
+
+private:
+    static constexpr size_t PORT_COUNT = 65536;
+    static constexpr size_t MAX_LISTS = 256;
+
+    bool intern(const std::vector<std::string>& analyzer_names, uint8_t& index);
+    static bool parse_ports(const std::string& ports, std::vector<std::pair<uint16_t, uint16_t>>& ranges, bool& wildcard);
+    static bool parse_port(const std::string& text, uint16_t& port);
+
+    std::vector<uint8_t> table_;     // Index into lists_ per server port
+    std::vector<bool> explicit_ports_; // Set by a port or range entry
+    std::vector<FactoryList> lists_; // lists_[0] is the empty list
+    std::vector<std::string> names_; // Comma joined names per list, for describe()
+};
+
+#endif // PORT_POLICY_HPP
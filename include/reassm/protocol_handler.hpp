@@ -2,15 +2,45 @@
 #define PROTOCOL_HANDLER_HPP
 
 #include "interfaces/protocol_analyzer.hpp"
+#include "reassm/analyzer_registry.hpp"
+#include "definitions/conn_info.hpp"
+#include "reassm/analyzer_worker_pool.hpp"
+#include "reassm/parse_hint_gate.hpp"
+#ifdef TCP_TRACKER_STATIC_ANALYZERS
+#include "reassm/static_analyzers.hpp"
+#endif
+#include <array>
+#include <atomic>
 #include <memory>
 #include <vector>
 #include <algorithm>
 
+// Per-connection analyzer set shared by both reassembly directions.
+// Analyzers with a probe are only created once the probe claims the flow.
+// STATIC_ANALYZERS builds run the analyzers of StaticAnalyzers without
+// virtual calls, in a pipeline allocated only once one of them attaches.
+// Bound to a worker, all analyzer calls run on that AnalyzerWorkerPool thread.
+// Each analyzer's ParseHints gate what it is handed, per direction.
+// info and summary are owned by the Connection and must outlive the handler.
 class ProtocolHandler {
 public:
-    // Add a protocol analyzer
+    ProtocolHandler(const ConnInfo& info, const ConnSummary& summary)
+        : info_(info), summary_(summary) {}
+    // Waits for tasks still queued on the worker
+    ~ProtocolHandler();
+
+    // Run analyzers on this AnalyzerWorkerPool worker; call before attaching anything
+    void set_worker(int worker) { worker_ = worker; }
+
+    // Add a protocol analyzer; it is opened right away
     void add_analyzer(std::shared_ptr<IProtocolAnalyzer> analyzer);
 
+    // Attach through a factory: immediately without a probe, otherwise
+    // once the probe matches. Probes only recognize the opening bytes of a
+    // stream, so mid-stream connections attach on the port policy alone.
+    // The factory must outlive the handler.
+    void add_candidate(const AnalyzerRegistry::AnalyzerFactory& factory);
+
     // Remove a protocol analyzer
     void remove_analyzer(const std::shared_ptr<IProtocolAnalyzer>& analyzer);
        
@@ -20,9 +50,71 @@ public:
     // Notify connection events
     void notify_reset();
     void notify_closed();
+    // Hand the final summary to every analyzer. Runs on the calling thread
+    // once the worker has drained this handler; nothing may follow.
+    void notify_close();
+
+    // Nothing attached, pending or still interested: payload can be skipped
+    bool is_idle() const;
+
+    // Once idle and drained, let each analyzer summarize into summary, close
+    // it and release it. False, with nothing changed, if the worker still
+    // has tasks queued or an analyzer wants more data.
+    bool compact(CompactSummary& summary);
+
+    // Attached and pending analyzers and their state. Capture thread only;
+    // waits for the worker first.
+    void describe(std::ostream& os) const;
 
 private:
-    std::vector<std::shared_ptr<IProtocolAnalyzer>> analyzers_;
+    friend class AnalyzerWorkerPool;
+
+    struct AnalyzerSlot {
+        std::shared_ptr<IProtocolAnalyzer> analyzer;
+        std::array<ParseHintGate, 2> gates;
+
+        bool is_finished() const {
+            return gates[0].is_done() || gates[1].is_done() || analyzer->is_finished();
+        }
+        void feed(Direction dir, const uint8_t* data, size_t len);
+    };
+
+    // Run on the analyzer thread, inline or on the worker
+    void deliver_data(Direction dir, const uint8_t* data, size_t len);
+    void deliver_reset();
+    void deliver_closed();
+    void wait_for_worker() const;
+    void run_task(const AnalyzerTask& task);
+    bool compute_idle() const;
+    // Worker fell behind: stop feeding analyzers for good
+    void degrade();
+
+    void probe(Direction dir, const uint8_t* data, size_t len);
+    // Create the analyzer; with replay, hand it the bytes probed so far
+    void attach(const AnalyzerRegistry::AnalyzerFactory& factory, bool replay);
+    // Calls feed(dir, data, len) over the probed bytes in arrival order
+    template <typename Feed>
+    void replay_probed(Feed feed) const;
+
+    const ConnInfo& info_;
+    const ConnSummary& summary_;
+#ifdef TCP_TRACKER_STATIC_ANALYZERS
+    // Allocated by the first static attach
+    std::unique_ptr<StaticAnalyzers> static_analyzers_;
+#endif
+    std::vector<AnalyzerSlot> analyzers_;
+    std::vector<const AnalyzerRegistry::AnalyzerFactory*> candidates_;
+    // First bytes of each direction, kept while candidates are undecided
+    std::array<std::array<uint8_t, PROBE_BYTES>, 2> probe_buffer_{};
+    std::array<size_t, 2> probe_len_{};
+    // Bit i is set when the i-th probed byte came from the server
+    uint32_t probe_order_ = 0;
+    static_assert(2 * PROBE_BYTES <= 32, "probe_order_ holds a bit per probed byte");
+
+    int worker_ = -1;                     // -1 runs analyzers inline
+    bool degraded_ = false;               // Capture thread only
+    std::atomic<bool> idle_{false};       // compute_idle() as last seen by the worker
+    std::atomic<uint32_t> pending_{0};    // Tasks queued but not yet run
 };
 
 #endif // PROTOCOL_HANDLER_HPP
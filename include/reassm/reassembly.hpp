@@ -23,7 +23,8 @@ inline bool seq_ge(uint32_t seq1, uint32_t seq2) {
 
 class Reassembly {
 public:
-    Reassembly(const ConnectionKey& key, Direction dir);
+    // The handler is shared with the opposite direction and must outlive this object
+    Reassembly(const ConnectionKey& key, Direction dir, ProtocolHandler& protocol_handler);
     ~Reassembly();
 
     // Process an incoming TCP segment's payload for this direction
@@ -38,28 +39,23 @@ public:
     // Signal that a FIN has been received for this direction
     void fin_received();
 
-    // Add protocol analyzer
-    void add_analyzer(std::shared_ptr<IProtocolAnalyzer> analyzer) {
-        protocol_handler_.add_analyzer(std::move(analyzer));
-    }
-
-    // Remove protocol analyzer
-    void remove_analyzer(const std::shared_ptr<IProtocolAnalyzer>& analyzer) {
-        protocol_handler_.remove_analyzer(analyzer);
-    }
-
     // --- Accessors ---
     uint32_t get_next_seq() const { return next_seq_; }
     bool is_initialized() const { return initial_seq_set_; }
     bool is_closed() const { return fin_received_; }
+    // Sequence state and out-of-order buffer, one line
+    void describe(std::ostream& os) const;
 
 private:
     void deliver_contiguous();
     void log_event(ReassmEvent type, uint32_t seq = 0, size_t len = 0);
+    // Keep buffered_bytes_ and the reassembly gauges in step with the map
+    void track_buffered(int64_t bytes, int64_t segments);
+    void clear_buffered();
 
     ConnectionKey key_;
     Direction direction_;
-    ProtocolHandler protocol_handler_;
+    ProtocolHandler& protocol_handler_;
     Log& reassm_log_ = LogManager::get_instance().get_registered_log("reassm.log");
 
     uint32_t next_seq_ = 0;
@@ -68,6 +64,7 @@ private:
 
     // Buffer for out-of-order segments: map<start_seq, payload_vector>
     std::map<uint32_t, std::vector<uint8_t>> out_of_order_segments_;
+    size_t buffered_bytes_ = 0;
 };
 
 #endif // TCP_REASSEMBLY_HPP
@@ -0,0 +1,153 @@
+#ifndef STATIC_ANALYZER_PIPELINE_HPP
+#define STATIC_ANALYZER_PIPELINE_HPP
+
+#include "definitions/conn_info.hpp"
+#include "definitions/direction.hpp"
+#include "reassm/parse_hint_gate.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <ostream>
+#include <tuple>
+#include <type_traits>
+
+// Fixed analyzer set stored inline: one optional slot per analyzer type,
+// engaged when the analyzer is attached to the connection. Calls are
+// qualified with the concrete type so they bind statically and inline.
+// ParseHints are applied per slot and direction as in ProtocolHandler.
+template <typename... Analyzers>
+class StaticAnalyzerPipeline {
+public:
+    static constexpr size_t SIZE = sizeof...(Analyzers);
+
+    // Slot of analyzer type A, or -1 if A is not part of the pipeline
+    template <typename A>
+    static constexpr int slot_of() {
+        int slot = -1;
+        int index = 0;
+        ((slot = (slot < 0 && std::is_same_v<A, Analyzers>) ? index : slot, ++index), ...);
+        return slot;
+    }
+
+    // Construct and open the analyzer in a slot; false if the slot does not exist
+    bool emplace(size_t slot, const ConnInfo& info) {
+        return emplace_impl(slot, info, std::index_sequence_for<Analyzers...>{});
+    }
+
+    // Deliver to one slot, e.g. to replay bytes seen before it was attached
+    void on_data(size_t slot, Direction dir, const uint8_t* data, size_t len) {
+        size_t index = 0;
+        for_each([&](auto& analyzer) {
+            if (index == slot && analyzer) {
+                feed(analyzer, index, dir, data, len);
+            }
+            ++index;
+        });
+    }
+
+    void on_data(Direction dir, const uint8_t* data, size_t len) {
+        size_t index = 0;
+        for_each([&](auto& analyzer) {
+            using A = typename std::decay_t<decltype(analyzer)>::value_type;
+            if (analyzer && !analyzer->A::is_finished()) {
+                feed(analyzer, index, dir, data, len);
+            }
+            ++index;
+        });
+    }
+
+    void on_connection_reset() {
+        for_each([](auto& analyzer) {
+            using A = typename std::decay_t<decltype(analyzer)>::value_type;
+            if (analyzer) analyzer->A::on_connection_reset();
+        });
+    }
+
+    void on_connection_closed() {
+        for_each([](auto& analyzer) {
+            using A = typename std::decay_t<decltype(analyzer)>::value_type;
+            if (analyzer) analyzer->A::on_connection_closed();
+        });
+    }
+
+    void on_close(const ConnSummary& summary) {
+        for_each([&summary](auto& analyzer) {
+            using A = typename std::decay_t<decltype(analyzer)>::value_type;
+            if (analyzer) analyzer->A::on_close(summary);
+        });
+    }
+
+    void summarize(CompactSummary& summary) const {
+        std::apply([&summary](const auto&... analyzer) {
+            auto one = [&summary](const auto& a) {
+                using A = typename std::decay_t<decltype(a)>::value_type;
+                if (a) a->A::summarize(summary);
+            };
+            (one(analyzer), ...);
+        }, analyzers_);
+    }
+
+    void describe(std::ostream& os) const {
+        std::apply([&os](const auto&... analyzer) {
+            auto one = [&os](const auto& a) {
+                using A = typename std::decay_t<decltype(a)>::value_type;
+                if (a) a->A::describe(os);
+            };
+            (one(analyzer), ...);
+        }, analyzers_);
+    }
+
+    // Destroy every attached analyzer and forget its hints
+    void clear() {
+        for_each([](auto& analyzer) { analyzer.reset(); });
+        gates_ = {};
+    }
+
+    // True when every attached analyzer is done (or none is attached)
+    bool is_finished() const {
+        return is_finished_impl(std::index_sequence_for<Analyzers...>{});
+    }
+
+private:
+    template <typename A>
+    void feed(std::optional<A>& analyzer, size_t slot, Direction dir, const uint8_t* data, size_t len) {
+        gates_[slot][static_cast<size_t>(dir)].feed(data, len, [&](const uint8_t* d, size_t n) {
+            return analyzer->A::on_data(dir, d, n);
+        });
+    }
+
+    template <size_t I>
+    bool is_slot_finished() const {
+        using A = std::tuple_element_t<I, std::tuple<Analyzers...>>;
+        const auto& analyzer = std::get<I>(analyzers_);
+        return !analyzer || analyzer->A::is_finished() ||
+               gates_[I][0].is_done() || gates_[I][1].is_done();
+    }
+
+    template <size_t... I>
+    bool is_finished_impl(std::index_sequence<I...>) const {
+        return (is_slot_finished<I>() && ...);
+    }
+
+    template <typename F>
+    void for_each(F&& f) {
+        std::apply([&f](auto&... analyzer) { (f(analyzer), ...); }, analyzers_);
+    }
+
+    template <size_t I>
+    void emplace_slot(const ConnInfo& info) {
+        using A = std::tuple_element_t<I, std::tuple<Analyzers...>>;
+        std::get<I>(analyzers_).emplace().A::on_open(info);
+    }
+
+    template <size_t... I>
+    bool emplace_impl(size_t slot, const ConnInfo& info, std::index_sequence<I...>) {
+        return ((slot == I ? (emplace_slot<I>(info), true) : false) || ...);
+    }
+
+    std::tuple<std::optional<Analyzers>...> analyzers_;
+    std::array<std::array<ParseHintGate, 2>, SIZE> gates_;
+};
+
+#endif // STATIC_ANALYZER_PIPELINE_HPP
@@ -0,0 +1,16 @@
+#ifndef STATIC_ANALYZERS_HPP
+#define STATIC_ANALYZERS_HPP
+
+#include "reassm/static_analyzer_pipeline.hpp"
+#include "reassm/reassm_analyzer.hpp"
+#include "tls/tls_analyzer.hpp"
+
+// Analyzer set compiled into every connection in STATIC_ANALYZERS builds.
+// The TLS slot has logging compiled out, so with tls.log enabled TLS goes
+// through the dynamic AnalyzerRegistry path, as do analyzers not listed here.
+using StaticAnalyzers = StaticAnalyzerPipeline<
+    TLSAnalyzer<NullTLSSink>,
+    ReassmAnalyzer
+>;
+
+#endif // STATIC_ANALYZERS_HPP
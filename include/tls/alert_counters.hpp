@@ -0,0 +1,42 @@
+#ifndef ALERT_COUNTERS_HPP
+#define ALERT_COUNTERS_HPP
+
+#include "definitions/tls_types.hpp"
+#include "misc/port_slot_table.hpp"
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+#include <utility>
+
+// Process-wide alert counts per (server port, alert description), cheap
+// enough to stay on with tls.log disabled. Recording is lock-free.
+class AlertCounters {
+public:
+    static constexpr size_t MAX_PORTS = 64;
+    static constexpr size_t OPAQUE = 256;  // Slot for encrypted alerts
+
+    struct PortCounters {
+        std::atomic<uint64_t> by_description[OPAQUE + 1] = {};
+        std::atomic<uint64_t> fatal{0};
+    };
+
+    static AlertCounters& get_instance();
+
+    void record(uint16_t server_port, const TLSAlert& alert);
+
+    // f(uint16_t port, const PortCounters& counters); port 0 collects overflow
+    template <typename F>
+    void for_each_port(F&& f) const { ports_.for_each(std::forward<F>(f)); }
+
+    // Human readable summary, one line per server port
+    void report(std::ostream& os) const;
+
+private:
+    AlertCounters() = default;
+    AlertCounters(const AlertCounters&) = delete;
+    AlertCounters& operator=(const AlertCounters&) = delete;
+
+    PortSlotTable<PortCounters, MAX_PORTS> ports_;
+};
+
+#endif // ALERT_COUNTERS_HPP
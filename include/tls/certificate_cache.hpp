@@ -0,0 +1,78 @@
+#ifndef CERTIFICATE_CACHE_HPP
+#define CERTIFICATE_CACHE_HPP
+
+#include "misc/sha256.hpp"
+#include "tls/x509_parser.hpp"
+#include <atomic>
+#include <cstring>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+// A DER certificate identified by its SHA-256 fingerprint
+struct CertificateEntry {
+    Sha256::Digest digest;
+    size_t der_len = 0;
+    bool parsed = false;        // False if the DER could not be decoded
+    CertificateInfo info;
+};
+
+// Bounded, sharded LRU of parsed certificates. Connections presenting an
+// already known chain pay one hash per certificate instead of ASN.1 parsing.
+class CertificateCache {
+public:
+    static constexpr size_t SHARD_COUNT = 16;
+    static constexpr size_t DEFAULT_CAPACITY = 4096;
+
+    static CertificateCache& get_instance();
+
+    CertificateCache(const CertificateCache&) = delete;
+    CertificateCache& operator=(const CertificateCache&) = delete;
+
+    // Look up a DER certificate, parsing and inserting it on a miss
+    std::shared_ptr<const CertificateEntry> lookup(const uint8_t* der, size_t len, bool& hit);
+
+    // Entry count limit across all shards; shrinking evicts lazily
+    void set_capacity(size_t capacity);
+
+    // Copy of the cached entries, for inventory and expiry reports
+    std::vector<std::shared_ptr<const CertificateEntry>> snapshot() const;
+
+    uint64_t get_hits() const { return hits_.load(std::memory_order_relaxed); }
+    uint64_t get_misses() const { return misses_.load(std::memory_order_relaxed); }
+    double get_hit_ratio() const;
+
+private:
+    CertificateCache() = default;
+    ~CertificateCache() = default;
+
+    struct DigestHash {
+        size_t operator()(const Sha256::Digest& digest) const {
+            // The digest is already uniformly distributed
+            size_t value;
+            std::memcpy(&value, digest.data(), sizeof(value));
+            return value;
+        }
+    };
+
+    struct Shard {
+        using LruList = std::list<std::shared_ptr<const CertificateEntry>>;
+
+        mutable std::mutex mutex;
+        LruList lru;  // Most recently used first
+        std::unordered_map<Sha256::Digest, LruList::iterator, DigestHash> index;
+    };
+
+    Shard& shard_for(const Sha256::Digest& digest) {
+        return shards_[digest[sizeof(size_t)] % SHARD_COUNT];
+    }
+
+    Shard shards_[SHARD_COUNT];
+    std::atomic<size_t> shard_capacity_{DEFAULT_CAPACITY / SHARD_COUNT};
+    std::atomic<uint64_t> hits_{0};
+    std::atomic<uint64_t> misses_{0};
+};
+
+#endif // CERTIFICATE_CACHE_HPP
@@ -0,0 +1,69 @@
+#ifndef HANDSHAKE_METRICS_HPP
+#define HANDSHAKE_METRICS_HPP
+
+#include "misc/atomic_histogram.hpp"
+#include "misc/packet_clock.hpp"
+#include "misc/port_slot_table.hpp"
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <utility>
+
+enum class TLSHandshakeKind : uint8_t {
+    FULL,
+    SESSION_ID_RESUMPTION,  // TLS 1.2 abbreviated handshake on a cached session ID
+    TICKET_RESUMPTION,      // RFC 5077 ticket, or TLS 1.3 PSK
+    COUNT
+};
+
+static std::string get_handshake_kind_name(TLSHandshakeKind kind) {
+    switch (kind) {
+        case TLSHandshakeKind::FULL: return "full";
+        case TLSHandshakeKind::SESSION_ID_RESUMPTION: return "session_id";
+        case TLSHandshakeKind::TICKET_RESUMPTION: return "ticket";
+        default: return "unknown";
+    }
+}
+
+// Packet timestamps of one handshake; a default time_point means not seen
+struct TLSHandshakeTimestamps {
+    PacketClock::time_point client_hello;        // First ClientHello
+    PacketClock::time_point server_hello;        // ServerHello (not HelloRetryRequest)
+    PacketClock::time_point change_cipher_spec;  // First ChangeCipherSpec, either side
+    PacketClock::time_point finished;            // Finished completing the handshake
+};
+
+// Process-wide handshake latency aggregates, per server port. Recording is
+// lock-free and may happen from any thread.
+class HandshakeMetrics {
+public:
+    static constexpr size_t MAX_PORTS = 64;
+
+    struct PortMetrics {
+        std::atomic<uint64_t> handshakes[static_cast<size_t>(TLSHandshakeKind::COUNT)] = {};
+        AtomicHistogram handshake_rtt;      // ClientHello to Finished, microseconds
+        AtomicHistogram server_think_time;  // Last ClientHello to ServerHello, microseconds
+    };
+
+    static HandshakeMetrics& get_instance();
+
+    void record(uint16_t server_port, TLSHandshakeKind kind,
+                PacketClock::duration handshake_rtt, PacketClock::duration server_think_time);
+
+    // f(uint16_t port, const PortMetrics& metrics); port 0 collects overflow
+    template <typename F>
+    void for_each_port(F&& f) const { ports_.for_each(std::forward<F>(f)); }
+
+    // Human readable summary, one line per server port
+    void report(std::ostream& os) const;
+
+private:
+    HandshakeMetrics() = default;
+    HandshakeMetrics(const HandshakeMetrics&) = delete;
+    HandshakeMetrics& operator=(const HandshakeMetrics&) = delete;
+
+    PortSlotTable<PortMetrics, MAX_PORTS> ports_;
+};
+
+#endif // HANDSHAKE_METRICS_HPP
@@ -2,28 +2,145 @@
 #define TLS12_STATE_MACHINE_HPP
 
 #include "definitions/tls_types.hpp"
+#include "conn/connection_key.hpp"
 #include "definitions/direction.hpp"
-#include <functional>
+#include <cstddef>
 #include <string>
 
+// Events driving the TLS 1.2 handshake: handshake message types 0..24 map
+// onto themselves, record level events follow
+inline constexpr size_t TLS12_EVENT_HANDSHAKE_TYPES = 25;
+inline constexpr size_t TLS12_EVENT_CHANGE_CIPHER_SPEC = 25;
+inline constexpr size_t TLS12_EVENT_ENCRYPTED_HANDSHAKE = 26;  // Finished after ChangeCipherSpec
+inline constexpr size_t TLS12_EVENT_ALERT = 27;                // Fatal, closure or encrypted alert
+inline constexpr size_t TLS12_EVENT_UNKNOWN = 28;
+inline constexpr size_t TLS12_EVENT_COUNT = 29;
+
+constexpr size_t tls12_handshake_event(TLSHandshakeType type) {
+    size_t value = static_cast<size_t>(type);
+    return value < TLS12_EVENT_HANDSHAKE_TYPES ? value : TLS12_EVENT_UNKNOWN;
+}
+
+// Compile-time (state, direction, event) -> state table; unlisted
+// combinations lead to ERROR
+class TLS12TransitionTable {
+public:
+    constexpr TLS12TransitionTable() : next_() {
+        for (auto& state : next_) {
+            state = TLS12State::ERROR;
+        }
+
+        constexpr Direction C2S = Direction::CLIENT_TO_SERVER;
+        constexpr Direction S2C = Direction::SERVER_TO_CLIENT;
+
+        add(TLS12State::INIT, C2S, TLSHandshakeType::CLIENT_HELLO, TLS12State::CLIENT_HELLO_SENT);
+        add(TLS12State::CLIENT_HELLO_SENT, S2C, TLSHandshakeType::SERVER_HELLO, TLS12State::SERVER_HELLO_RECEIVED);
+
+        add(TLS12State::SERVER_HELLO_RECEIVED, S2C, TLSHandshakeType::CERTIFICATE, TLS12State::CERTIFICATE_RECEIVED);
+        add(TLS12State::SERVER_HELLO_RECEIVED, S2C, TLSHandshakeType::SERVER_KEY_EXCHANGE, TLS12State::SERVER_KEY_EXCHANGE_RECEIVED);
+        add(TLS12State::SERVER_HELLO_RECEIVED, S2C, TLSHandshakeType::CERTIFICATE_REQUEST, TLS12State::CERTIFICATE_REQUEST_RECEIVED);
+        add(TLS12State::SERVER_HELLO_RECEIVED, S2C, TLSHandshakeType::SERVER_HELLO_DONE, TLS12State::SERVER_HELLO_DONE_RECEIVED);
+
+        add(TLS12State::CERTIFICATE_RECEIVED, S2C, TLSHandshakeType::SERVER_KEY_EXCHANGE, TLS12State::SERVER_KEY_EXCHANGE_RECEIVED);
+        add(TLS12State::CERTIFICATE_RECEIVED, S2C, TLSHandshakeType::CERTIFICATE_REQUEST, TLS12State::CERTIFICATE_REQUEST_RECEIVED);
+        add(TLS12State::CERTIFICATE_RECEIVED, S2C, TLSHandshakeType::SERVER_HELLO_DONE, TLS12State::SERVER_HELLO_DONE_RECEIVED);
+
+        add(TLS12State::SERVER_KEY_EXCHANGE_RECEIVED, S2C, TLSHandshakeType::CERTIFICATE_REQUEST, TLS12State::CERTIFICATE_REQUEST_RECEIVED);
+        add(TLS12State::SERVER_KEY_EXCHANGE_RECEIVED, S2C, TLSHandshakeType::SERVER_HELLO_DONE, TLS12State::SERVER_HELLO_DONE_RECEIVED);
+
+        add(TLS12State::CERTIFICATE_REQUEST_RECEIVED, S2C, TLSHandshakeType::SERVER_HELLO_DONE, TLS12State::SERVER_HELLO_DONE_RECEIVED);
+
+        add(TLS12State::SERVER_HELLO_DONE_RECEIVED, C2S, TLSHandshakeType::CERTIFICATE, TLS12State::CERTIFICATE_SENT);
+        add(TLS12State::SERVER_HELLO_DONE_RECEIVED, C2S, TLSHandshakeType::CLIENT_KEY_EXCHANGE, TLS12State::CLIENT_KEY_EXCHANGE_SENT);
+
+        add(TLS12State::CERTIFICATE_SENT, C2S, TLSHandshakeType::CERTIFICATE_VERIFY, TLS12State::CERTIFICATE_VERIFY_SENT);
+        add(TLS12State::CERTIFICATE_SENT, C2S, TLSHandshakeType::CLIENT_KEY_EXCHANGE, TLS12State::CLIENT_KEY_EXCHANGE_SENT);
+
+        add(TLS12State::CERTIFICATE_VERIFY_SENT, C2S, TLSHandshakeType::CLIENT_KEY_EXCHANGE, TLS12State::CLIENT_KEY_EXCHANGE_SENT);
+
+        add(TLS12State::CLIENT_KEY_EXCHANGE_SENT, C2S, TLSHandshakeType::FINISHED, TLS12State::FINISHED_SENT);
+
+        // Optional NewSessionTicket keeps the current state
+        add(TLS12State::FINISHED_SENT, S2C, TLSHandshakeType::NEW_SESSION_TICKET, TLS12State::FINISHED_SENT);
+        add(TLS12State::FINISHED_SENT, S2C, TLSHandshakeType::FINISHED, TLS12State::FINISHED_RECEIVED);
+
+        // ChangeCipherSpec and the encrypted Finished that follows it
+        add(TLS12State::CLIENT_KEY_EXCHANGE_SENT, C2S, TLS12_EVENT_CHANGE_CIPHER_SPEC, TLS12State::CHANGE_CIPHER_SPEC_SENT);
+        add(TLS12State::CHANGE_CIPHER_SPEC_SENT, C2S, TLS12_EVENT_CHANGE_CIPHER_SPEC, TLS12State::FINISHED_SENT);
+        add(TLS12State::CHANGE_CIPHER_SPEC_SENT, C2S, TLS12_EVENT_ENCRYPTED_HANDSHAKE, TLS12State::FINISHED_SENT);
+        add(TLS12State::FINISHED_SENT, S2C, TLS12_EVENT_CHANGE_CIPHER_SPEC, TLS12State::CHANGE_CIPHER_SPEC_RECEIVED);
+        add(TLS12State::CHANGE_CIPHER_SPEC_RECEIVED, S2C, TLS12_EVENT_CHANGE_CIPHER_SPEC, TLS12State::FINISHED_RECEIVED);
+        add(TLS12State::CHANGE_CIPHER_SPEC_RECEIVED, S2C, TLS12_EVENT_ENCRYPTED_HANDSHAKE, TLS12State::FINISHED_RECEIVED);
+        add(TLS12State::FINISHED_RECEIVED, C2S, TLS12_EVENT_CHANGE_CIPHER_SPEC, TLS12State::HANDSHAKE_COMPLETE);
+        add(TLS12State::FINISHED_RECEIVED, S2C, TLS12_EVENT_CHANGE_CIPHER_SPEC, TLS12State::HANDSHAKE_COMPLETE);
+
+        // Abbreviated handshake: the server resumes and sends its Finished first
+        add(TLS12State::SERVER_HELLO_RECEIVED, S2C, TLSHandshakeType::NEW_SESSION_TICKET, TLS12State::SERVER_HELLO_RECEIVED);
+        add(TLS12State::SERVER_HELLO_RECEIVED, S2C, TLS12_EVENT_CHANGE_CIPHER_SPEC, TLS12State::ABBREVIATED_CHANGE_CIPHER_SPEC_RECEIVED);
+        add(TLS12State::ABBREVIATED_CHANGE_CIPHER_SPEC_RECEIVED, S2C, TLS12_EVENT_ENCRYPTED_HANDSHAKE, TLS12State::ABBREVIATED_FINISHED_RECEIVED);
+        add(TLS12State::ABBREVIATED_FINISHED_RECEIVED, C2S, TLS12_EVENT_CHANGE_CIPHER_SPEC, TLS12State::ABBREVIATED_CHANGE_CIPHER_SPEC_SENT);
+        add(TLS12State::ABBREVIATED_CHANGE_CIPHER_SPEC_SENT, C2S, TLS12_EVENT_ENCRYPTED_HANDSHAKE, TLS12State::HANDSHAKE_COMPLETE);
+
+        // A terminating alert ends the handshake from any state, either side
+        for (size_t state = 0; state < static_cast<size_t>(TLS12State::ERROR); ++state) {
+            add(static_cast<TLS12State>(state), C2S, TLS12_EVENT_ALERT, TLS12State::ALERT_RECEIVED);
+            add(static_cast<TLS12State>(state), S2C, TLS12_EVENT_ALERT, TLS12State::ALERT_RECEIVED);
+        }
+    }
+
+    constexpr TLS12State lookup(TLS12State state, Direction dir, size_t event) const {
+        return next_[index(state, dir, event)];
+    }
+
+private:
+    static constexpr size_t STATE_COUNT = static_cast<size_t>(TLS12State::ERROR) + 1;
+
+    static constexpr size_t index(TLS12State state, Direction dir, size_t event) {
+        return (static_cast<size_t>(state) * 2 + static_cast<size_t>(dir)) * TLS12_EVENT_COUNT + event;
+    }
+
+    constexpr void add(TLS12State from, Direction dir, TLSHandshakeType type, TLS12State to) {
+        add(from, dir, tls12_handshake_event(type), to);
+    }
+
+    constexpr void add(TLS12State from, Direction dir, size_t event, TLS12State to) {
+        next_[index(from, dir, event)] = to;
+    }
+
+    TLS12State next_[STATE_COUNT * 2 * TLS12_EVENT_COUNT];
+};
+
+inline constexpr TLS12TransitionTable TLS12_TRANSITIONS{};
+
+static_assert(TLS12_TRANSITIONS.lookup(TLS12State::INIT, Direction::CLIENT_TO_SERVER,
+    tls12_handshake_event(TLSHandshakeType::CLIENT_HELLO)) == TLS12State::CLIENT_HELLO_SENT);
+static_assert(TLS12_TRANSITIONS.lookup(TLS12State::INIT, Direction::SERVER_TO_CLIENT,
+    tls12_handshake_event(TLSHandshakeType::CLIENT_HELLO)) == TLS12State::ERROR);
+static_assert(TLS12_TRANSITIONS.lookup(TLS12State::FINISHED_SENT, Direction::SERVER_TO_CLIENT,
+    TLS12_EVENT_ALERT) == TLS12State::ALERT_RECEIVED);
+
+// Sink is an event sink from tls/tls_event_sink.hpp
+template <typename Sink>
 class TLS12StateMachine {
 public:
-    explicit TLS12StateMachine(std::function<void(const std::string&)> log_helper);
+    explicit TLS12StateMachine(Sink sink);
+    // The key must outlive the state machine
+    void bind(const ConnectionKey& key) { sink_.bind(key); }
 
     bool process_handshake(Direction dir, TLSHandshakeType msg_type);
+    bool process_encrypted_handshake(Direction dir);
     bool process_change_cipher_spec(Direction dir);
+    // Fatal alert, close_notify, or an alert too encrypted to tell
+    bool process_alert(Direction dir);
     
     TLS12State get_state() const { return state_; }
     void reset();
 
 private:
-    bool validate_transition(TLS12State new_state);
-
-    // Update state if transition is valid
-    void update_state(TLS12State new_state);
+    bool transition(Direction dir, size_t event);
 
     TLS12State state_ = TLS12State::INIT;
-    std::function<void(const std::string&)> log_helper_;
+    Sink sink_;
 };
 
-#endif // TLS12_STATE_MACHINE_HPP 
\ No newline at end of file
+#endif // TLS12_STATE_MACHINE_HPP
@@ -0,0 +1,46 @@
+#ifndef TLS13_STATE_MACHINE_HPP
+#define TLS13_STATE_MACHINE_HPP
+
+#include "definitions/tls_types.hpp"
+#include "conn/connection_key.hpp"
+#include "definitions/direction.hpp"
+#include <string>
+
+// Sink is an event sink from tls/tls_event_sink.hpp
+template <typename Sink>
+class TLS13StateMachine {
+public:
+    explicit TLS13StateMachine(Sink sink);
+    // The key must outlive the state machine
+    void bind(const ConnectionKey& key) { sink_.bind(key); }
+
+    // Plaintext handshake messages (ClientHello, ServerHello)
+    bool process_handshake(Direction dir, TLSHandshakeType msg_type);
+    bool process_hello_retry_request(Direction dir);
+    // Set from each ClientHello and ServerHello; with early data offered
+    // the client Finished is told from 0-RTT records by its length
+    void set_early_data(bool offered) { early_data_ = offered; }
+    void set_cipher_suite(uint16_t cipher_suite) { finished_len_ = tls13_finished_record_len(cipher_suite); }
+    // Middlebox compatibility ChangeCipherSpec (RFC 8446 Appendix D.4)
+    bool process_change_cipher_spec(Direction dir);
+    // ApplicationData records, which carry the encrypted handshake after ServerHello
+    bool process_encrypted_record(Direction dir, size_t len);
+    // Plaintext alert; only sent before the handshake is encrypted, so always fatal to it
+    bool process_alert(Direction dir);
+
+    TLS13State get_state() const { return state_; }
+    bool is_handshake_complete() const { return state_ == TLS13State::HANDSHAKE_COMPLETE; }
+    void reset();
+
+private:
+    bool fail(const char* what);
+    void update_state(TLS13State new_state);
+
+    TLS13State state_ = TLS13State::INIT;
+    bool hello_retried_ = false;
+    bool early_data_ = false;
+    size_t finished_len_ = 0;
+    Sink sink_;
+};
+
+#endif // TLS13_STATE_MACHINE_HPP
@@ -7,42 +7,106 @@
 #include "interfaces/protocol_analyzer.hpp"
 #include "tls/tls_recorder.hpp"
 #include "tls/tls12_state_machine.hpp"
-#include "log/log_manager.hpp"
+#include "tls/tls13_state_machine.hpp"
+#include "tls/tls_event_sink.hpp"
+#include "tls/certificate_cache.hpp"
+#include "tls/alert_counters.hpp"
+#include "tls/handshake_metrics.hpp"
+#include "tls/tls_hello_parser.hpp"
 #include <memory>
+#include <optional>
 
+// Probe for the "tls" analyzer: a handshake record carrying a ClientHello
+// from the client or a ServerHello from the server
+ProbeResult probe_tls(Direction dir, const uint8_t* data, size_t len);
+
+// Sink selects the logging of the whole TLS stack: TLSLogSink writes
+// tls.log, NullTLSSink compiles all logging out
+template <typename Sink>
 class TLSAnalyzer : public IProtocolAnalyzer {
 public:
-    // Create analyzer for a specific TCP connection
-    explicit TLSAnalyzer(const ConnectionKey& key);
+    TLSAnalyzer();
     ~TLSAnalyzer();
 
     // IProtocolAnalyzer interface implementation
-    void on_data(Direction dir, 
-                 const uint8_t* data, 
-                 size_t len) override;
+    // Mid-stream connections resync both directions on a record boundary
+    void on_open(const ConnInfo& info) override;
+    // Asks for the rest of a partial record so it is parsed once
+    ParseHint on_data(Direction dir, 
+                      const uint8_t* data, 
+                      size_t len) override;
+
+    // Nothing left to track once the handshake has completed or failed, or
+    // was missed altogether
+    bool is_finished() const override { return is_handshake_complete() || is_handshake_failed() || lost_track_; }
+    // Version, cipher, SNI and timing of the handshake
+    void summarize(CompactSummary& summary) const override;
+    // Version, state machine, cipher and partial records
+    void describe(std::ostream& os) const override;
 
     // TLS-specific interface
     TLS12State get_state() const { return state_machine_.get_state(); }
-    bool is_handshake_complete() const { return state_machine_.get_state() == TLS12State::HANDSHAKE_COMPLETE; }
+    TLS13State get_tls13_state() const { return tls13_state_machine_.get_state(); }
+    std::optional<TLSVersion> get_version() const { return negotiated_version_; }
+    // Server certificate chain, leaf first, shared with CertificateCache
+    const std::vector<std::shared_ptr<const CertificateEntry>>& get_certificates() const { return certificates_; }
+    bool is_handshake_complete() const;
+    bool is_handshake_failed() const;
+    const TLSHandshakeTimestamps& get_timestamps() const { return timestamps_; }
+    TLSHandshakeKind get_handshake_kind() const;
+    // Last alert seen from either side
+    const std::optional<TLSAlert>& get_alert() const { return alert_; }
     
     // Reset analyzer state
     void reset();
 
 private:
     // Process a complete TLS record
-    void handle_record(Direction dir, TLSContentType type, 
-                      const std::vector<uint8_t>& fragment);
+    void handle_record(Direction dir, TLSContentType type,
+                      const uint8_t* fragment, size_t len);
     
     // Handle specific message types
-    void handle_handshake(Direction dir, const std::vector<uint8_t>& data);
-    void handle_alert(Direction dir, const std::vector<uint8_t>& data);
+    void handle_handshake(Direction dir, const uint8_t* data, size_t data_len);
+    void handle_handshake_message(Direction dir, TLSHandshakeType type, const uint8_t* body, size_t len);
+    void handle_server_hello(Direction dir, const uint8_t* body, size_t len);
+    void handle_certificate(const uint8_t* body, size_t len);
+    void handle_alert(Direction dir, const uint8_t* data, size_t len);
     void handle_change_cipher_spec(Direction dir);
+    void handle_application_data(Direction dir, size_t len);
+    // Feed HandshakeMetrics once the handshake completes
+    void record_handshake();
+
+    bool is_tls13() const { return negotiated_version_ == TLSVersion::TLS_1_3; }
+    bool& encrypted(Direction dir) { return dir == Direction::CLIENT_TO_SERVER ? client_encrypted_ : server_encrypted_; }
     
-    ConnectionKey key_;
-    TLS12StateMachine state_machine_;
-    TLSRecorder client_buffer_;
-    TLSRecorder server_buffer_;
-    Log& tls_log_ = LogManager::get_instance().get_registered_log("tls.log");
+    const ConnInfo* info_ = nullptr;
+    Sink sink_;
+    TLS12StateMachine<Sink> state_machine_;
+    TLS13StateMachine<Sink> tls13_state_machine_;
+    TLSRecorder<Sink> client_buffer_;
+    TLSRecorder<Sink> server_buffer_;
+    // Handshake messages may span several records (RFC 5246 Section 6.2.1)
+    std::vector<uint8_t> client_handshake_;
+    std::vector<uint8_t> server_handshake_;
+    std::vector<std::shared_ptr<const CertificateEntry>> certificates_;
+    // Set from the ServerHello supported_versions extension
+    std::optional<TLSVersion> negotiated_version_;
+    // TLS 1.2 handshake records are encrypted after ChangeCipherSpec
+    bool client_encrypted_ = false;
+    bool server_encrypted_ = false;
+    // Handshake timing and resumption
+    TLSHelloInfo client_hello_;
+    TLSHandshakeTimestamps timestamps_;
+    PacketClock::time_point last_client_hello_;  // Differs from the first after a HelloRetryRequest
+    bool resumed_ = false;  // TLS 1.2 abbreviated handshake or TLS 1.3 PSK accepted
+    bool handshake_recorded_ = false;
+    std::optional<TLSAlert> alert_;
+    uint16_t cipher_suite_ = 0;  // From the ServerHello
+    // Joined mid-stream and no record seen yet; only a handshake still in
+    // progress can be followed from there
+    bool mid_stream_ = false;
+    // Joined after the handshake, or no record boundary found
+    bool lost_track_ = false;
 };
 
 #endif // TLS_ANALYZER_HPP
@@ -0,0 +1,34 @@
+#ifndef TLS_EVENT_SINK_HPP
+#define TLS_EVENT_SINK_HPP
+
+#include "conn/connection_key.hpp"
+#include "log/log_manager.hpp"
+#include <string>
+
+// Event sinks for the TLS components. Callers format messages only when
+// Sink::enabled is set, so NullTLSSink instantiations carry no logging cost.
+
+// Discards every event; used when tls.log is disabled
+struct NullTLSSink {
+    static constexpr bool enabled = false;
+
+    void bind(const ConnectionKey&) {}
+    void operator()(const std::string&) const {}
+};
+
+// Forwards events to tls.log, tagged with the connection key
+class TLSLogSink {
+public:
+    static constexpr bool enabled = true;
+
+    TLSLogSink();
+    // Called by the analyzer before any event; the key must outlive the sink
+    void bind(const ConnectionKey& key) { key_ = &key; }
+    void operator()(const std::string& msg) const;
+
+private:
+    const ConnectionKey* key_ = nullptr;
+    Log* tls_log_;
+};
+
+#endif // TLS_EVENT_SINK_HPP
@@ -0,0 +1,43 @@
+#ifndef TLS_HELLO_PARSER_HPP
+#define TLS_HELLO_PARSER_HPP
+
+#include "definitions/tls_types.hpp"
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstddef>
+
+// Fields of interest from a ClientHello or ServerHello body
+struct TLSHelloInfo {
+    uint16_t legacy_version = 0;       // Version field of the hello itself
+    uint16_t max_offered_version = 0;  // ClientHello: highest supported_versions entry
+    uint16_t selected_version = 0;     // ServerHello: supported_versions, else legacy_version
+    uint16_t cipher_suite = 0;         // ServerHello: selected cipher suite
+    bool hello_retry_request = false;  // ServerHello carrying the HelloRetryRequest random
+    std::array<uint8_t, TLS_MAX_SESSION_ID_LEN> session_id{};
+    uint8_t session_id_len = 0;
+    bool session_ticket = false;       // ClientHello: non-empty SessionTicket extension
+    bool pre_shared_key = false;       // ClientHello: PSK offered; ServerHello: PSK accepted
+    bool early_data = false;           // ClientHello: 0-RTT data follows it
+    uint32_t server_name_id = 0;       // ClientHello: fnv1a_32_lower of the SNI host name, 0 if absent
+
+    bool same_session_id(const TLSHelloInfo& other) const {
+        return session_id_len == other.session_id_len &&
+               std::equal(session_id.begin(), session_id.begin() + session_id_len, other.session_id.begin());
+    }
+};
+
+class TLSHelloParser {
+public:
+    // Parse a handshake message body (without the 4 byte handshake header)
+    // Returns false if the message is truncated or malformed
+    static bool parse_client_hello(const uint8_t* data, size_t len, TLSHelloInfo& info);
+    static bool parse_server_hello(const uint8_t* data, size_t len, TLSHelloInfo& info);
+
+private:
+    static bool parse_extensions(const uint8_t* data, size_t len, bool is_client, TLSHelloInfo& info);
+    static bool parse_session_id(const uint8_t* data, size_t len, size_t pos, TLSHelloInfo& info);
+    static bool is_grease(uint16_t value);
+};
+
+#endif // TLS_HELLO_PARSER_HPP
@@ -2,34 +2,61 @@
 #define TLS_RECORDER_HPP
 
 #include "definitions/tls_types.hpp"
-#include <functional>
+#include "conn/connection_key.hpp"
 #include <string>
 #include <vector>
 #include <optional>
 
+// Sink is an event sink from tls/tls_event_sink.hpp
+template <typename Sink>
 class TLSRecorder {
 public:
-    explicit TLSRecorder(std::function<void(const std::string&)> log_helper);
+    explicit TLSRecorder(Sink sink);
+    // The key must outlive the recorder
+    void bind(const ConnectionKey& key) { sink_.bind(key); }
  
+    // Drops the records already extracted, then appends
     void add_data(const uint8_t* data, size_t len);
 
     // Try to extract a complete TLS record from the buffer
-    // Returns true if a record was extracted
-    bool try_extract_record(TLSContentType& type, std::vector<uint8_t>& fragment);
+    // Returns true if a record was extracted. The fragment points into the
+    // buffer and stays valid until the next add_data() or reset()
+    bool try_extract_record(TLSContentType& type, const uint8_t*& fragment, size_t& fragment_len);
+    // Bytes still missing from the record at the front of the buffer,
+    // 0 if it is complete or its header is invalid
+    size_t bytes_needed() const;
+    // Bytes held for records not yet complete
+    size_t buffered() const { return buffer_.size() - pos_; }
     void reset();
 
+    // The stream was joined mid-way: drop bytes up to the first header that
+    // is followed by another header, or ends exactly at the buffered data
+    void resync();
+    bool is_resyncing() const { return resyncing_; }
+    // A real boundary lies within one maximal record of the start, so
+    // skipping more than that means the stream is not TLS
+    bool resync_failed() const { return resync_skipped_ > TLS_RECORD_HEADER_LEN + TLS_MAX_RECORD_LEN; }
+
 private:
     // Parse a TLS record from raw data
     // Returns bytes consumed if successful, 0 if more data needed
-    std::optional<size_t> try_parse(const uint8_t* data, size_t len, 
-        TLSContentType& type, std::vector<uint8_t>& fragment);
+    std::optional<size_t> try_parse(const uint8_t* data, size_t len,
+        TLSContentType& type, const uint8_t*& fragment, size_t& fragment_len);
 
     bool validate_header(const uint8_t* data, size_t len);
     bool check_version(uint16_t version);
     bool check_length(uint16_t length);
+    // Content type, version and length of a record header all valid
+    bool plausible_header(const uint8_t* data);
+    // Skip bytes ahead of the first confirmed boundary; false while none is found
+    bool find_boundary();
 
     std::vector<uint8_t> buffer_;
-    std::function<void(const std::string&)> log_helper_;
+    // Start of the first record not yet extracted
+    size_t pos_ = 0;
+    bool resyncing_ = false;
+    size_t resync_skipped_ = 0;
+    Sink sink_;
 };
 
 #endif // TLS_RECORDER_HPP
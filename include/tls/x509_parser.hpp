@@ -0,0 +1,33 @@
+#ifndef X509_PARSER_HPP
+#define X509_PARSER_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <ctime>
+#include <string>
+#include <vector>
+
+// Certificate fields kept for inventory and expiry monitoring
+struct CertificateInfo {
+    std::string serial;                // Hex encoded serial number
+    std::string subject;               // e.g. "CN=example.com,O=Example"
+    std::string issuer;
+    std::vector<std::string> san;      // dNSName and iPAddress entries
+    time_t not_before = 0;             // Seconds since epoch, UTC
+    time_t not_after = 0;
+};
+
+// DER decoder for the parts of an X.509 certificate (RFC 5280) we report
+class X509Parser {
+public:
+    // Returns false if the certificate is malformed; info may be partially filled
+    static bool parse(const uint8_t* der, size_t len, CertificateInfo& info);
+
+private:
+    static bool parse_name(const uint8_t* data, size_t len, std::string& out);
+    static bool parse_time(uint8_t tag, const uint8_t* data, size_t len, time_t& out);
+    static bool parse_extensions(const uint8_t* data, size_t len, CertificateInfo& info);
+    static bool parse_san(const uint8_t* data, size_t len, std::vector<std::string>& out);
+};
+
+#endif // X509_PARSER_HPP
@@ -0,0 +1,27 @@
+#include "capture/stream_capture_analyzer.hpp"
+
+StreamCaptureAnalyzer::~StreamCaptureAnalyzer() {
+    close_streams();
+}
+
+ParseHint StreamCaptureAnalyzer::on_data(Direction dir, const uint8_t* data, size_t len) {
+    auto& writer = StreamWriter::get_instance();
+    auto& stream = streams_[static_cast<size_t>(dir)];
+    if (!stream.file && !writer.open(*info_, dir, stream)) {
+        return ParseHint::done();
+    }
+    writer.write(stream, data, len);
+    return ParseHint::more();
+}
+
+void StreamCaptureAnalyzer::on_close(const ConnSummary&) {
+    close_streams();
+}
+
+void StreamCaptureAnalyzer::close_streams() {
+    for (size_t dir = 0; dir < streams_.size(); ++dir) {
+        if (streams_[dir].file) {
+            StreamWriter::get_instance().close(*info_, static_cast<Direction>(dir), streams_[dir]);
+        }
+    }
+}
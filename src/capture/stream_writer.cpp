@@ -0,0 +1,379 @@
+#include "capture/stream_writer.hpp"
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+
+namespace {
+
+// iovecs per pwritev; well below IOV_MAX
+constexpr size_t IOV_BATCH = 64;
+// Smaller tails of a buffer are left unused rather than split into
+constexpr size_t MIN_CHUNK = 256;
+
+std::string stream_file_name(const FlowKey& flow, Direction dir) {
+    bool from_client = dir == Direction::CLIENT_TO_SERVER;
+    uint32_t src_ip = from_client ? flow.client_ip : flow.server_ip;
+    uint32_t dst_ip = from_client ? flow.server_ip : flow.client_ip;
+    unsigned src_port = from_client ? flow.client_port : flow.server_port;
+    unsigned dst_port = from_client ? flow.server_port : flow.client_port;
+    // Network byte order: the first byte in memory is the first octet
+    const uint8_t* src = reinterpret_cast<const uint8_t*>(&src_ip);
+    const uint8_t* dst = reinterpret_cast<const uint8_t*>(&dst_ip);
+
+    char name[64];
+    std::snprintf(name, sizeof(name), "%03u.%03u.%03u.%03u.%05u-%03u.%03u.%03u.%03u.%05u",
+        src[0], src[1], src[2], src[3], src_port, dst[0], dst[1], dst[2], dst[3], dst_port);
+    return name;
+}
+
+} // namespace
+
+StreamWriter& StreamWriter::get_instance() {
+    static StreamWriter instance;
+    return instance;
+}
+
+StreamWriter::~StreamWriter() {
+    stop();
+}
+
+bool StreamWriter::start(const std::string& directory) {
+    if (running_) {
+        return true;
+    }
+
+    std::error_code ec;
+    std::filesystem::create_directories(directory, ec);
+    if (ec) {
+        std::cerr << "Failed to create stream directory " << directory << ": " << ec.message() << std::endl;
+        return false;
+    }
+    std::string index_path = directory + "/" + STREAM_INDEX_FILE;
+    index_fd_ = ::open(index_path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (index_fd_ < 0) {
+        std::cerr << "Failed to open stream index " << index_path << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    directory_ = directory;
+    buffers_.resize(BUFFER_COUNT);
+    for (auto& buffer : buffers_) {
+        buffer.data = static_cast<uint8_t*>(std::aligned_alloc(BUFFER_ALIGN, BUFFER_SIZE));
+        buffer.used = 0;
+        free_.push_back(&buffer);
+    }
+
+    stopping_ = false;
+    running_ = true;
+    thread_ = std::thread(&StreamWriter::io_loop, this);
+    return true;
+}
+
+void StreamWriter::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_) {
+            return;
+        }
+        running_ = false;
+        stopping_ = true;
+    }
+    full_cv_.notify_one();
+    free_cv_.notify_all();
+    thread_.join();
+
+    for (File* file : lru_) {
+        ::close(file->fd);
+    }
+    lru_.clear();
+    files_.clear();
+    ::close(index_fd_);
+    index_fd_ = -1;
+
+    current_ = nullptr;
+    free_.clear();
+    for (auto& buffer : buffers_) {
+        std::free(buffer.data);
+    }
+    buffers_.clear();
+}
+
+bool StreamWriter::open(const ConnInfo& info, Direction dir, Stream& stream) {
+    std::string name = stream_file_name(info.flow, dir);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!running_) {
+        return false;
+    }
+    auto [it, inserted] = files_.try_emplace(name);
+    File& file = it->second;
+    if (inserted) {
+        file.name = name;
+        // Left by an earlier connection on the same 4-tuple: append
+        struct stat st;
+        if (::stat((directory_ + "/" + name).c_str(), &st) == 0) {
+            file.end = static_cast<uint64_t>(st.st_size);
+        }
+    }
+    ++file.streams;
+
+    stream.file = &file;
+    stream.offset = file.end;
+    stream.length = 0;
+    streams_opened_.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+void StreamWriter::write(Stream& stream, const uint8_t* data, size_t len) {
+    if (!stream.file) {
+        return;
+    }
+
+    // Copying under the lock keeps chunks of one stream in order in the buffers
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (len > 0) {
+        size_t room = reserve(lock, std::min(len, MIN_CHUNK));
+        if (room == 0) {
+            return;
+        }
+        size_t take = std::min(len, room);
+        Chunk chunk{stream.file, stream.offset + stream.length, static_cast<uint32_t>(take), Chunk::DATA};
+        put(chunk, data);
+
+        stream.length += take;
+        stream.file->end = std::max(stream.file->end, chunk.offset + take);
+        data += take;
+        len -= take;
+        bytes_captured_.fetch_add(take, std::memory_order_relaxed);
+    }
+}
+
+void StreamWriter::close(const ConnInfo& info, Direction dir, Stream& stream) {
+    if (!stream.file) {
+        return;
+    }
+
+    StreamIndexRecord record{};
+    record.conn_id = static_cast<uint32_t>(info.id);
+    record.flow = info.flow;
+    record.offset = stream.offset;
+    record.length = stream.length;
+    record.first_seen_us = info.first_seen.time_since_epoch().count();
+    record.dir = static_cast<uint8_t>(dir);
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (reserve(lock, sizeof(record)) > 0) {
+        put(Chunk{stream.file, 0, sizeof(record), Chunk::CLOSE}, &record);
+    }
+    stream.file = nullptr;
+}
+
+size_t StreamWriter::reserve(std::unique_lock<std::mutex>& lock, size_t min_len) {
+    while (running_) {
+        if (current_ && BUFFER_SIZE - current_->used >= sizeof(Chunk) + min_len) {
+            return BUFFER_SIZE - current_->used - sizeof(Chunk);
+        }
+        rotate(lock);
+    }
+    return 0;
+}
+
+void StreamWriter::rotate(std::unique_lock<std::mutex>& lock) {
+    if (current_) {
+        full_.push_back(current_);
+        current_ = nullptr;
+        full_cv_.notify_one();
+    }
+    if (free_.empty()) {
+        // Disk slower than capture: hold the writer rather than lose bytes
+        buffer_waits_.fetch_add(1, std::memory_order_relaxed);
+        free_cv_.wait(lock, [this] { return !free_.empty() || !running_; });
+    }
+    if (!free_.empty() && running_) {
+        current_ = free_.back();
+        free_.pop_back();
+    }
+}
+
+void StreamWriter::put(const Chunk& chunk, const void* data) {
+    uint8_t* dst = current_->data + current_->used;
+    std::memcpy(dst, &chunk, sizeof(Chunk));
+    std::memcpy(dst + sizeof(Chunk), data, chunk.len);
+    size_t padded = (chunk.len + CHUNK_ALIGN - 1) & ~(CHUNK_ALIGN - 1);
+    current_->used += sizeof(Chunk) + padded;
+}
+
+void StreamWriter::io_loop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        full_cv_.wait_for(lock, std::chrono::milliseconds(FLUSH_INTERVAL_MS),
+            [this] { return !full_.empty() || stopping_; });
+        // Quiet streams still reach the disk within FLUSH_INTERVAL_MS
+        if (full_.empty() && current_ && current_->used > 0) {
+            full_.push_back(current_);
+            current_ = nullptr;
+        }
+        if (full_.empty()) {
+            if (stopping_) {
+                break;
+            }
+            continue;
+        }
+
+        Buffer* buffer = full_.front();
+        full_.pop_front();
+        lock.unlock();
+        flush_buffer(*buffer);
+        lock.lock();
+
+        buffer->used = 0;
+        free_.push_back(buffer);
+        free_cv_.notify_one();
+    }
+}
+
+void StreamWriter::flush_buffer(const Buffer& buffer) {
+    iovec iov[IOV_BATCH];
+    size_t count = 0;
+    File* run_file = nullptr;
+    uint64_t run_offset = 0;
+    uint64_t run_end = 0;
+    std::vector<File*> closed;
+
+    size_t pos = 0;
+    while (pos < buffer.used) {
+        Chunk chunk;
+        std::memcpy(&chunk, buffer.data + pos, sizeof(Chunk));
+        uint8_t* payload = buffer.data + pos + sizeof(Chunk);
+        pos += sizeof(Chunk) + ((chunk.len + CHUNK_ALIGN - 1) & ~(CHUNK_ALIGN - 1));
+
+        if (chunk.type == Chunk::CLOSE) {
+            StreamIndexRecord record;
+            std::memcpy(&record, payload, sizeof(record));
+            index_pending_.push_back(record);
+            closed.push_back(chunk.file);
+            continue;
+        }
+
+        // Consecutive chunks of one file go out in a single pwritev
+        if (count > 0 && (chunk.file != run_file || chunk.offset != run_end || count == IOV_BATCH)) {
+            write_file(run_file, run_offset, iov, count);
+            count = 0;
+        }
+        if (count == 0) {
+            run_file = chunk.file;
+            run_offset = chunk.offset;
+            run_end = chunk.offset;
+        }
+        iov[count++] = iovec{payload, chunk.len};
+        run_end += chunk.len;
+    }
+    if (count > 0) {
+        write_file(run_file, run_offset, iov, count);
+    }
+
+    if (!index_pending_.empty()) {
+        size_t bytes = index_pending_.size() * sizeof(StreamIndexRecord);
+        if (::write(index_fd_, index_pending_.data(), bytes) != static_cast<ssize_t>(bytes)) {
+            write_errors_.fetch_add(1, std::memory_order_relaxed);
+        }
+        index_pending_.clear();
+    }
+    // Data of every closed stream is written by now. A stream reopened on
+    // the same 4-tuple meanwhile holds its own reference to the file.
+    for (File* file : closed) {
+        release_file(file);
+    }
+}
+
+void StreamWriter::write_file(File* file, uint64_t offset, iovec* iov, size_t count) {
+    int fd = acquire_fd(file);
+    if (fd < 0) {
+        write_errors_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    while (count > 0) {
+        ssize_t written = ::pwritev(fd, iov, static_cast<int>(count), static_cast<off_t>(offset));
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            write_errors_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        offset += written;
+        // Skip what went out, then resume inside a partly written iovec
+        size_t done = static_cast<size_t>(written);
+        while (count > 0 && done >= iov->iov_len) {
+            done -= iov->iov_len;
+            ++iov;
+            --count;
+        }
+        if (count > 0) {
+            iov->iov_base = static_cast<uint8_t*>(iov->iov_base) + done;
+            iov->iov_len -= done;
+        }
+    }
+}
+
+int StreamWriter::acquire_fd(File* file) {
+    if (file->fd >= 0) {
+        lru_.splice(lru_.begin(), lru_, file->lru);
+        return file->fd;
+    }
+
+    if (lru_.size() >= MAX_OPEN_FILES) {
+        close_fd(lru_.back());
+        fd_evictions_.fetch_add(1, std::memory_order_relaxed);
+    }
+    std::string path = directory_ + "/" + file->name;
+    int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        return -1;
+    }
+    files_opened_.fetch_add(1, std::memory_order_relaxed);
+    file->fd = fd;
+    lru_.push_front(file);
+    file->lru = lru_.begin();
+    return fd;
+}
+
+void StreamWriter::close_fd(File* file) {
+    ::close(file->fd);
+    file->fd = -1;
+    lru_.erase(file->lru);
+}
+
+void StreamWriter::release_file(File* file) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (--file->streams > 0) {
+        return;
+    }
+    if (file->fd >= 0) {
+        close_fd(file);
+    }
+    std::string name = file->name;
+    files_.erase(name);
+}
+
+void StreamWriter::report(std::ostream& os) const {
+    if (directory_.empty()) {
+        return;
+    }
+    os << "Stream capture dir=" << directory_
+       << " streams=" << streams_opened_.load(std::memory_order_relaxed)
+       << " bytes=" << bytes_captured_.load(std::memory_order_relaxed)
+       << " files_opened=" << files_opened_.load(std::memory_order_relaxed)
+       << " fd_evictions=" << fd_evictions_.load(std::memory_order_relaxed)
+       << " buffer_waits=" << buffer_waits_.load(std::memory_order_relaxed)
+       << " write_errors=" << write_errors_.load(std::memory_order_relaxed) << "\n";
+}
@@ -0,0 +1,120 @@
+#include "conn/checkpoint.hpp"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <new>
+
+namespace {
+
+size_t file_size(size_t count) {
+    return sizeof(CheckpointHeader) + count * sizeof(CheckpointRecord);
+}
+
+} // namespace
+
+CheckpointWriter::~CheckpointWriter() {
+    if (fd_ >= 0) {
+        unmap();
+        ::close(fd_);
+        ::unlink((path_ + ".tmp").c_str());
+    }
+}
+
+void CheckpointWriter::unmap() {
+    if (map_) {
+        ::munmap(map_, map_len_);
+        map_ = nullptr;
+        records_ = nullptr;
+    }
+}
+
+bool CheckpointWriter::open(const std::string& path, size_t capacity, PacketClock::time_point taken_at) {
+    path_ = path;
+    std::string tmp = path + ".tmp";
+    fd_ = ::open(tmp.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    map_len_ = file_size(capacity);
+    if (fd_ < 0 || ::ftruncate(fd_, static_cast<off_t>(map_len_)) < 0) {
+        std::cerr << "Failed to create checkpoint " << tmp << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    map_ = ::mmap(nullptr, map_len_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    if (map_ == MAP_FAILED) {
+        map_ = nullptr;
+        std::cerr << "Failed to map checkpoint " << tmp << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    auto* header = new (map_) CheckpointHeader();
+    header->taken_at_us = taken_at.time_since_epoch().count();
+    records_ = reinterpret_cast<CheckpointRecord*>(static_cast<char*>(map_) + sizeof(CheckpointHeader));
+    return true;
+}
+
+bool CheckpointWriter::commit(size_t count) {
+    if (!map_) return false;
+
+    static_cast<CheckpointHeader*>(map_)->count = count;
+    bool ok = ::msync(map_, map_len_, MS_SYNC) == 0;
+    unmap();
+    std::string tmp = path_ + ".tmp";
+    ok = ok && ::ftruncate(fd_, static_cast<off_t>(file_size(count))) == 0;
+    ::close(fd_);
+    fd_ = -1;
+    if (!ok || std::rename(tmp.c_str(), path_.c_str()) != 0) {
+        std::cerr << "Failed to write checkpoint " << path_ << ": " << std::strerror(errno) << std::endl;
+        ::unlink(tmp.c_str());
+        return false;
+    }
+    return true;
+}
+
+CheckpointReader::~CheckpointReader() {
+    if (map_) {
+        ::munmap(map_, map_len_);
+    }
+}
+
+bool CheckpointReader::open(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        // No checkpoint yet is the normal first start
+        if (errno != ENOENT) {
+            std::cerr << "Failed to open checkpoint " << path << ": " << std::strerror(errno) << std::endl;
+        }
+        return false;
+    }
+    struct stat st;
+    if (::fstat(fd, &st) < 0 || static_cast<size_t>(st.st_size) < sizeof(CheckpointHeader)) {
+        std::cerr << "Checkpoint " << path << " is truncated" << std::endl;
+        ::close(fd);
+        return false;
+    }
+    map_len_ = static_cast<size_t>(st.st_size);
+    map_ = ::mmap(nullptr, map_len_, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (map_ == MAP_FAILED) {
+        map_ = nullptr;
+        std::cerr << "Failed to map checkpoint " << path << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    const auto* header = static_cast<const CheckpointHeader*>(map_);
+    if (header->magic != CheckpointHeader::MAGIC || header->version != CheckpointHeader::VERSION ||
+        header->record_size != sizeof(CheckpointRecord)) {
+        std::cerr << "Checkpoint " << path << " has an unknown format" << std::endl;
+        return false;
+    }
+    if (header->count > (map_len_ - sizeof(CheckpointHeader)) / sizeof(CheckpointRecord)) {
+        std::cerr << "Checkpoint " << path << " is truncated" << std::endl;
+        return false;
+    }
+    count_ = header->count;
+    taken_at_ = PacketClock::time_point(PacketClock::duration(header->taken_at_us));
+    records_ = reinterpret_cast<const CheckpointRecord*>(static_cast<const char*>(map_) + sizeof(CheckpointHeader));
+    return true;
+}
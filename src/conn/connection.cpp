@@ -2,13 +2,34 @@
 #include "definitions/packet_key.hpp"
 #include "log/conn_log_entry.hpp"
 #include "interfaces/protocol_analyzer.hpp"
+#include "reassm/analyzer_worker_pool.hpp"
+#include "misc/event_bus.hpp"
+#include "misc/metrics_registry.hpp"
 #include <iostream>
 #include <iomanip>
 #include <chrono>
 #include <sstream>
 
-Connection::Connection(const ConnectionKey& key, int id)
-    : key_(key), id_(id), last_update_(std::chrono::steady_clock::now()) {
+namespace {
+
+// TCP option kinds (RFC 9293 Section 3.2, RFC 7323 Section 2.2)
+constexpr uint8_t TCP_OPT_EOL = 0;
+constexpr uint8_t TCP_OPT_NOP = 1;
+constexpr uint8_t TCP_OPT_MSS = 2;
+constexpr uint8_t TCP_OPT_WSCALE = 3;
+constexpr size_t TCP_BASE_HEADER_LEN = 20;
+
+} // namespace
+
+Connection::Connection(const ConnectionKey& key, int id, const FlowKey& flow)
+    : key_(key), id_(id), last_update_(PacketClock::now()) {
+    info_.key = &key_;
+    info_.flow = flow;
+    info_.id = id_;
+    info_.first_seen = PacketClock::now();
+    summary_.last_seen = info_.first_seen;
+    MetricsRegistry::get_instance().add(MetricGauge::CONNECTIONS_ACTIVE, 1);
+
     // Client starts by initiating connection -> SYN_SENT
     // Server starts by listening -> LISTEN
     client_state_.state = TCPState::SYN_SENT; // More accurate starting point if created on first SYN
@@ -18,9 +39,11 @@ Connection::Connection(const ConnectionKey& key, int id)
     client_state_.prev_state = TCPState::CLOSED; // Indicate transition from non-existence
     server_state_.prev_state = TCPState::CLOSED; // Indicate transition from non-existence
 
-    // Initialize reassembly objects for both directions
-    client_reassembly_ = std::make_unique<Reassembly>(key, Direction::CLIENT_TO_SERVER);
-    server_reassembly_ = std::make_unique<Reassembly>(!key, Direction::SERVER_TO_CLIENT);
+    // Pin the connection to one analyzer worker to keep its data in order
+    size_t workers = AnalyzerWorkerPool::get_instance().worker_count();
+    if (workers > 0) {
+        protocol_handler_.set_worker(static_cast<int>(static_cast<size_t>(id_) % workers));
+    }
 
     std::string initial_info = "Initial State: cli:" + TcpStateMachine::state_to_string(client_state_.state) +
                                " srv:" + TcpStateMachine::state_to_string(server_state_.state);
@@ -28,12 +51,85 @@ Connection::Connection(const ConnectionKey& key, int id)
 }
 
 Connection::~Connection() {
+    // The default constructed placeholder connection is never reported
+    if (!key_.src_ip.empty()) {
+        summary_.client_state = static_cast<uint8_t>(client_state_.state);
+        summary_.server_state = static_cast<uint8_t>(server_state_.state);
+        protocol_handler_.notify_close();
+        publish_closed();
+        MetricsRegistry::get_instance().add(MetricGauge::CONNECTIONS_ACTIVE, -1);
+    }
     tcp_log_.flush(); // Ensure logs are written on destruction
 }
 
+void Connection::count_packet(bool is_from_client, size_t payload_len) {
+    size_t dir = static_cast<size_t>(is_from_client ? Direction::CLIENT_TO_SERVER : Direction::SERVER_TO_CLIENT);
+    ++summary_.packets[dir];
+    summary_.bytes[dir] += payload_len;
+    summary_.last_seen = PacketClock::now();
+}
+
+void Connection::record_syn_options(bool is_from_client, const TCPHeader* tcp, size_t tcph_len) {
+    size_t dir = static_cast<size_t>(is_from_client ? Direction::CLIENT_TO_SERVER : Direction::SERVER_TO_CLIENT);
+    const uint8_t* options = reinterpret_cast<const uint8_t*>(tcp) + TCP_BASE_HEADER_LEN;
+    size_t len = tcph_len > TCP_BASE_HEADER_LEN ? tcph_len - TCP_BASE_HEADER_LEN : 0;
+
+    size_t offset = 0;
+    while (offset < len) {
+        uint8_t kind = options[offset];
+        if (kind == TCP_OPT_EOL) break;
+        if (kind == TCP_OPT_NOP) {
+            ++offset;
+            continue;
+        }
+        if (len - offset < 2) break;
+        uint8_t opt_len = options[offset + 1];
+        if (opt_len < 2 || opt_len > len - offset) break;
+
+        if (kind == TCP_OPT_MSS && opt_len == 4) {
+            info_.mss[dir] = static_cast<uint16_t>((options[offset + 2] << 8) | options[offset + 3]);
+        } else if (kind == TCP_OPT_WSCALE && opt_len == 3) {
+            info_.wscale[dir] = options[offset + 2];
+        }
+        offset += opt_len;
+    }
+}
+
+void Connection::publish_closed() const {
+    auto& bus = EventBus::get_instance();
+    if (!bus.is_running()) {
+        return;
+    }
+    AnalyzerEvent event;
+    event.type = AnalyzerEventType::CONN_CLOSED;
+    event.flow = info_.flow;
+    event.time_us = summary_.last_seen.time_since_epoch().count();
+    event.conn_closed.client_state = summary_.client_state;
+    event.conn_closed.server_state = summary_.server_state;
+    event.conn_closed.duration_ms = static_cast<uint32_t>(
+        std::chrono::duration_cast<std::chrono::milliseconds>(summary_.last_seen - info_.first_seen).count());
+    for (size_t dir = 0; dir < 2; ++dir) {
+        event.conn_closed.packets[dir] = summary_.packets[dir];
+        event.conn_closed.bytes[dir] = summary_.bytes[dir];
+    }
+    bus.publish(event);
+}
+
 void Connection::add_analyzer(std::shared_ptr<IProtocolAnalyzer> analyzer) {
-    client_reassembly_->add_analyzer(analyzer);
-    server_reassembly_->add_analyzer(analyzer);
+    ensure_reassembly();
+    protocol_handler_.add_analyzer(std::move(analyzer));
+}
+
+void Connection::add_candidate(const AnalyzerRegistry::AnalyzerFactory& factory) {
+    ensure_reassembly();
+    protocol_handler_.add_candidate(factory);
+}
+
+void Connection::ensure_reassembly() {
+    if (!client_reassembly_) {
+        client_reassembly_ = std::make_unique<Reassembly>(key_, Direction::CLIENT_TO_SERVER, protocol_handler_);
+        server_reassembly_ = std::make_unique<Reassembly>(!key_, Direction::SERVER_TO_CLIENT, protocol_handler_);
+    }
 }
 
 void Connection::update_client_state(uint8_t flags) {
@@ -41,7 +137,7 @@ void Connection::update_client_state(uint8_t flags) {
     TCPState new_state = state_machine_.determine_new_state(current_state, flags, true);
 
     if (new_state != current_state) {
-        auto timestamp = std::chrono::steady_clock::now();
+        auto timestamp = PacketClock::now();
         // Log shows transition *before* updating state member
         std::string change_info = "Trigger: S->C flags(" + TcpStateMachine::flags_to_string(flags) + ") | " + // Show trigger
                                   "cli: " + TcpStateMachine::state_to_string(current_state) + " -> " + TcpStateMachine::state_to_string(new_state) +
@@ -59,7 +155,7 @@ void Connection::update_client_state(uint8_t flags) {
             client_state_.time_wait_entry_time = timestamp;
         }
     } else {
-        last_update_ = std::chrono::steady_clock::now();
+        last_update_ = PacketClock::now();
     }
 }
 
@@ -68,7 +164,7 @@ void Connection::update_server_state(uint8_t flags) {
     TCPState new_state = state_machine_.determine_new_state(current_state, flags, false);
 
     if (new_state != current_state) {
-        auto timestamp = std::chrono::steady_clock::now();
+        auto timestamp = PacketClock::now();
         // Log shows transition *before* updating state member
         std::string change_info = "Trigger: C->S flags(" + TcpStateMachine::flags_to_string(flags) + ") | " + // Show trigger
                                   "srv: " + TcpStateMachine::state_to_string(current_state) + " -> " + TcpStateMachine::state_to_string(new_state) +
@@ -86,12 +182,111 @@ void Connection::update_server_state(uint8_t flags) {
             server_state_.time_wait_entry_time = timestamp;
         }
     } else {
-        last_update_ = std::chrono::steady_clock::now();
+        last_update_ = PacketClock::now();
     }
 }
 
-bool Connection::should_clean_up() const {
-    return state_machine_.should_clean_up(client_state_, server_state_, last_update_);
+bool Connection::should_clean_up(PacketClock::time_point now) const {
+    return state_machine_.should_clean_up(client_state_, server_state_, last_update_, now);
+}
+
+void Connection::describe(std::ostream& os) const {
+    os << "connection " << id_ << ": " << key_.src_ip << ":" << key_.src_port
+       << " -> " << key_.dst_ip << ":" << key_.dst_port << "\n";
+    os << "tcp: cli " << TcpStateMachine::state_to_string(client_state_.state)
+       << ", srv " << TcpStateMachine::state_to_string(server_state_.state)
+       << ", packets " << summary_.packets[0] << "/" << summary_.packets[1]
+       << ", bytes " << summary_.bytes[0] << "/" << summary_.bytes[1]
+       << ", idle " << std::chrono::duration_cast<std::chrono::milliseconds>(PacketClock::now() - last_update_).count()
+       << " ms" << (info_.mid_stream ? ", adopted mid-stream" : "") << "\n";
+    if (compact_) {
+        os << "compacted: tls version 0x" << std::hex << compact_->tls_version << ", cipher 0x" << compact_->cipher
+           << std::dec << ", sni id " << compact_->sni_id << ", handshake " << compact_->handshake_us << " us\n";
+        return;
+    }
+    if (!client_reassembly_) {
+        os << "header-only: no analyzer wants the payload\n";
+        return;
+    }
+    client_reassembly_->describe(os);
+    server_reassembly_->describe(os);
+    protocol_handler_.describe(os);
+}
+
+void Connection::save(CheckpointRecord& record) const {
+    record = CheckpointRecord();
+    record.flow = info_.flow;
+    record.id = id_;
+    record.first_seen_us = info_.first_seen.time_since_epoch().count();
+    record.last_seen_us = summary_.last_seen.time_since_epoch().count();
+    record.last_update_us = last_update_.time_since_epoch().count();
+    record.packets = summary_.packets;
+    record.bytes = summary_.bytes;
+    record.mss = info_.mss;
+    record.wscale = info_.wscale;
+    record.client_state = static_cast<uint8_t>(client_state_.state);
+    record.server_state = static_cast<uint8_t>(server_state_.state);
+    if (compact_) {
+        record.flags |= CHECKPOINT_COMPACTED;
+        record.compact = *compact_;
+    } else if (client_reassembly_) {
+        record.flags |= CHECKPOINT_REASSEMBLY;
+        const Reassembly* reassemblies[2] = {client_reassembly_.get(), server_reassembly_.get()};
+        const uint8_t seq_flags[2] = {CHECKPOINT_CLIENT_SEQ, CHECKPOINT_SERVER_SEQ};
+        const uint8_t fin_flags[2] = {CHECKPOINT_CLIENT_FIN, CHECKPOINT_SERVER_FIN};
+        for (size_t dir = 0; dir < 2; ++dir) {
+            if (reassemblies[dir]->is_initialized()) {
+                record.flags |= seq_flags[dir];
+                record.next_seq[dir] = reassemblies[dir]->get_next_seq();
+            }
+            if (reassemblies[dir]->is_closed()) {
+                record.flags |= fin_flags[dir];
+            }
+        }
+    }
+}
+
+void Connection::restore(const CheckpointRecord& record) {
+    info_.first_seen = PacketClock::time_point(PacketClock::duration(record.first_seen_us));
+    info_.mss = record.mss;
+    info_.wscale = record.wscale;
+    summary_.last_seen = PacketClock::time_point(PacketClock::duration(record.last_seen_us));
+    summary_.packets = record.packets;
+    summary_.bytes = record.bytes;
+    last_update_ = PacketClock::time_point(PacketClock::duration(record.last_update_us));
+    client_state_.state = static_cast<TCPState>(record.client_state);
+    server_state_.state = static_cast<TCPState>(record.server_state);
+    for (ConnState* side : {&client_state_, &server_state_}) {
+        side->prev_state = TCPState::CLOSED;
+        side->start_time = last_update_;
+        if (side->state == TCPState::TIME_WAIT) {
+            side->time_wait_entry_time = last_update_;
+        }
+    }
+
+    if (record.flags & CHECKPOINT_COMPACTED) {
+        compact_ = std::make_unique<CompactSummary>(record.compact);
+    } else if (client_reassembly_) {
+        // Analyzers start over on the byte after the checkpoint; those with
+        // a probe only attach if that still looks like their protocol
+        if (record.flags & CHECKPOINT_CLIENT_SEQ) client_reassembly_->set_initial_seq(record.next_seq[0]);
+        if (record.flags & CHECKPOINT_SERVER_SEQ) server_reassembly_->set_initial_seq(record.next_seq[1]);
+        if (record.flags & CHECKPOINT_CLIENT_FIN) client_reassembly_->fin_received();
+        if (record.flags & CHECKPOINT_SERVER_FIN) server_reassembly_->fin_received();
+    }
+
+    tcp_log_.log(std::make_shared<ConnLogEntry>(key_, "Restored from checkpoint: cli:" +
+        TcpStateMachine::state_to_string(client_state_.state) + " srv:" +
+        TcpStateMachine::state_to_string(server_state_.state)));
+}
+
+void Connection::adopt() {
+    info_.mid_stream = true;
+    client_state_.state = TCPState::ESTABLISHED;
+    server_state_.state = TCPState::ESTABLISHED;
+    tcp_log_.log(std::make_shared<ConnLogEntry>(key_, "Adopted mid-stream: cli:" +
+        TcpStateMachine::state_to_string(client_state_.state) + " srv:" +
+        TcpStateMachine::state_to_string(server_state_.state)));
 }
 
 void Connection::handle_syn_sequence(bool is_from_client, uint32_t seq) {
@@ -128,6 +323,19 @@ void Connection::handle_rst() {
 }
 
 void Connection::process_payload(bool is_from_client, uint32_t seq, const uint8_t* payload, size_t payload_len, uint8_t flags) {
+    // Header-only connection: no analyzer wants the byte stream
+    if (!client_reassembly_) {
+        return;
+    }
+
+    // Adopted connections start each direction at its first segment seen
+    if (info_.mid_stream) {
+        Reassembly& reassembly = is_from_client ? *client_reassembly_ : *server_reassembly_;
+        if (!reassembly.is_initialized()) {
+            reassembly.set_initial_seq(seq);
+        }
+    }
+
     // Handle sequence number initialization on SYN
     if (flags & TH_SYN) {
         handle_syn_sequence(is_from_client, seq);
@@ -145,4 +353,29 @@ void Connection::process_payload(bool is_from_client, uint32_t seq, const uint8_
     if (flags & TH_RST) {
         handle_rst();
     }
+
+    if (protocol_handler_.is_idle()) {
+        compact();
+    }
+}
+
+void Connection::compact() {
+    CompactSummary compact;
+    compact.flow = info_.flow;
+    compact.first_seen_us = info_.first_seen.time_since_epoch().count();
+    for (size_t dir = 0; dir < 2; ++dir) {
+        compact.bytes[dir] = summary_.bytes[dir];
+        compact.packets[dir] = static_cast<uint32_t>(summary_.packets[dir]);
+    }
+    compact.client_state = static_cast<uint8_t>(client_state_.state);
+    compact.server_state = static_cast<uint8_t>(server_state_.state);
+    if (!protocol_handler_.compact(compact)) {
+        return;
+    }
+
+    // Out-of-order maps go with the reassemblies; later payload is skipped
+    client_reassembly_.reset();
+    server_reassembly_.reset();
+    compact_ = std::make_unique<CompactSummary>(compact);
+    tcp_log_.log(std::make_shared<ConnLogEntry>(key_, "Compacted: analyzers and reassembly released"));
 }
@@ -2,34 +2,72 @@
 #include "conn/connection.hpp"
 #include "reassm/analyzer_registry.hpp"
 #include "tls/tls_analyzer.hpp"
+#include "misc/metrics_registry.hpp"
+#include "misc/epoch_manager.hpp"
 #include <netinet/tcp.h>
 #include <arpa/inet.h>
+#include <algorithm>
 #include <chrono>
+#include <cstdint>
 #include <iostream>
 
-ConnectionManager::ConnectionManager(int cleanup_interval_seconds, std::vector<std::string> default_analyzers)
+ConnectionManager::ConnectionManager(int cleanup_interval_seconds, PortPolicy port_policy)
     : next_id_(1)
-    , running_(true)
-    , cleanup_interval_seconds_(cleanup_interval_seconds)
-    , default_analyzers_(std::move(default_analyzers))
+    , cleanup_interval_(std::chrono::seconds(cleanup_interval_seconds))
 {
-    cleanup_thread_ = std::thread(&ConnectionManager::cleanup_thread_func, this);
+    port_policies_.push_back(std::make_unique<PortPolicy>(std::move(port_policy)));
+    reaper_ = std::thread(&ConnectionManager::reap_loop, this);
 }
 
 ConnectionManager::~ConnectionManager() {
-    running_ = false;
-    if (cleanup_thread_.joinable()) {
-        cleanup_thread_.join();
+    {
+        std::lock_guard<std::mutex> lock(reaper_mutex_);
+        reaper_stop_ = true;
+    }
+    reaper_cv_.notify_all();
+    reaper_.join();
+    if (checkpoint_thread_.joinable()) {
+        checkpoint_thread_.join();
     }
+    // Let readers still holding rows or connection pointers finish
+    EpochManager::get_instance().synchronize();
+    delete snapshot_.load(std::memory_order_relaxed);
 }
 
 void ConnectionManager::process_packet(const ConnectionKey& key, const PacketKey& pkey) {
     if (!pkey.tcp || key.src_ip.empty() || key.dst_ip.empty()) return;
 
-    Connection& conn = create_or_get_connection(key, pkey.tcp);
+    auto now = PacketClock::now();
+    last_packet_ = now;
+    packets_seen_.store(packets_seen_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    if (now >= next_cleanup_) {
+        // A sweep still going round when the next is due just carries on
+        if (!sweeping_) {
+            start_sweep();
+        }
+        next_cleanup_ = now + cleanup_interval_;
+
+        if (!checkpoint_file_.empty()) {
+            if (next_checkpoint_ == PacketClock::time_point{}) {
+                next_checkpoint_ = now + CHECKPOINT_INTERVAL;
+            } else if (now >= next_checkpoint_) {
+                write_checkpoint();
+                next_checkpoint_ = now + CHECKPOINT_INTERVAL;
+            }
+        }
+    }
+    if (sweeping_ && !sweep_slice(now, SWEEP_SLICE)) {
+        finish_sweep(now);
+    }
+
+    Connection& conn = create_or_get_connection(key, pkey);
     if (conn.get_key().src_ip.empty()) return;
 
     bool is_from_client = conn.is_from_client(key.src_ip);
+    conn.count_packet(is_from_client, pkey.payload_len);
+    if (pkey.tcp->th_flags & TH_SYN) {
+        conn.record_syn_options(is_from_client, pkey.tcp, pkey.tcph_len);
+    }
 
     if (pkey.payload_len > 0 || (pkey.tcp->th_flags & (TH_SYN | TH_FIN))) {
         conn.process_payload(is_from_client, ntohl(pkey.tcp->th_seq), 
@@ -42,13 +80,6 @@ void ConnectionManager::process_packet(const ConnectionKey& key, const PacketKey
     } else {
         conn.update_client_state(pkey.tcp->th_flags);
     }
-
-    // Check if connection should be marked for cleanup
-    if ((pkey.tcp->th_flags & (TH_FIN | TH_RST)) || 
-        (conn.get_client_state() == TCPState::CLOSED && conn.get_server_state() == TCPState::CLOSED) ||
-        (conn.get_client_state() == TCPState::TIME_WAIT || conn.get_server_state() == TCPState::TIME_WAIT)) {
-        mark_for_cleanup(key);
-    }
 }
 
 Connection* ConnectionManager::get_connection(const ConnectionKey& key) {
@@ -66,54 +97,287 @@ std::vector<Connection*> ConnectionManager::get_active_connections() {
     return active_connections;
 }
 
-Connection& ConnectionManager::create_or_get_connection(const ConnectionKey& key, const TCPHeader* tcp) {
+Connection& ConnectionManager::create_or_get_connection(const ConnectionKey& key, const PacketKey& pkey) {
+    StageTimer timer(MetricStage::LOOKUP);
+    const TCPHeader* tcp = pkey.tcp;
+    auto& metrics = MetricsRegistry::get_instance();
+    bool init_flag = (tcp->th_flags & TH_SYN) && !(tcp->th_flags & TH_ACK);
+    uint64_t flow_hash = NegativeFlowCache::hash(key);
+    // A SYN always reaches the table, it may open a flow listed as untracked
+    bool listed = !init_flag && negative_cache_.is_untracked(flow_hash);
+    if (listed && !negative_cache_.may_be_tracked(flow_hash)) {
+        metrics.add(MetricCounter::NEGATIVE_CACHE_HITS);
+        metrics.add(MetricCounter::CONNECTION_MISSES);
+        return dummy_connection_;
+    }
+
     std::unique_lock<std::mutex> lock(connections_mutex_);
     auto it = connections_.find(key);
     
     if (it == connections_.end()) {
-        bool init_flag = (tcp->th_flags & TH_SYN) && !(tcp->th_flags & TH_ACK);
-        if (!init_flag) {
+        // A handshake, reset or close in flight is left alone rather than adopted
+        bool adopt = !init_flag && adopt_mid_stream_ && !(tcp->th_flags & (TH_SYN | TH_RST | TH_FIN));
+        if (!init_flag && !adopt) {
+            metrics.add(MetricCounter::CONNECTION_MISSES);
+            // With adoption on, the next packet of the flow may be adopted
+            if (!adopt_mid_stream_) {
+                negative_cache_.add_untracked(flow_hash);
+            }
             return dummy_connection_;
         }
 
-        auto conn = std::make_unique<Connection>(key, next_id_++);
-        for (const auto& analyzer : default_analyzers_) {
-            conn->add_analyzer(AnalyzerRegistry::get_instance().create_analyzer(analyzer, key));
+        // Connections are keyed client -> server, from the SYN or else by port
+        bool reversed = adopt && key.src_port < key.dst_port;
+        ConnectionKey conn_key = reversed ? !key : key;
+        FlowKey flow;
+        flow.client_ip = reversed ? pkey.ip->iph_dest : pkey.ip->iph_source;
+        flow.server_ip = reversed ? pkey.ip->iph_source : pkey.ip->iph_dest;
+        flow.client_port = conn_key.src_port;
+        flow.server_port = conn_key.dst_port;
+        auto conn = std::make_unique<Connection>(conn_key, next_id_++, flow);
+        if (adopt) {
+            metrics.add(MetricCounter::CONNECTIONS_ADOPTED);
+            conn->adopt();
+        } else {
+            metrics.add(MetricCounter::CONNECTIONS_CREATED);
+        }
+        negative_cache_.add_tracked(flow_hash);
+        // Analyzers of an adopted flow attach without probing, so only
+        // those the policy names the port for
+        const PortPolicy& policy = *port_policies_.back();
+        for (const auto& factory : adopt ? policy.lookup_explicit(conn_key.dst_port) : policy.lookup(conn_key.dst_port)) {
+            conn->add_candidate(factory);
         }
 
-        connections_[key] = std::move(conn);
-        return *connections_[key];
+        Connection& created = *conn;
+        connections_[conn_key] = std::move(conn);
+        return created;
     }
 
+    if (listed) {
+        metrics.add(MetricCounter::NEGATIVE_CACHE_FALSE_POSITIVES);
+    }
     return *it->second;
 }
 
-void ConnectionManager::mark_for_cleanup(const ConnectionKey& key) {
-    std::lock_guard<std::mutex> lock(cleanup_mutex_);
-    marked_for_cleanup_.push_back(key);
+ConnectionSnapshot ConnectionManager::query(const ConnectionQuery& filter) const {
+    ConnectionSnapshot result;
+    snapshot_requested_.store(true, std::memory_order_relaxed);
+    EpochGuard guard;
+    const ConnectionSnapshot* snapshot = snapshot_.load(std::memory_order_acquire);
+    if (!snapshot) return result;
+
+    result.taken_at = snapshot->taken_at;
+    for (const auto& row : snapshot->rows) {
+        if (result.rows.size() >= filter.limit) break;
+        if (filter.matches(row, snapshot->taken_at)) {
+            result.rows.push_back(row);
+        }
+    }
+    return result;
+}
+
+bool ConnectionManager::describe_connection(int id, std::ostream& os) {
+    std::lock_guard<std::mutex> lock(connections_mutex_);
+    for (const auto& pair : connections_) {
+        if (pair.second->get_id() == id) {
+            pair.second->describe(os);
+            return true;
+        }
+    }
+    return false;
 }
 
-void ConnectionManager::cleanup_marked_connections() {
-    std::vector<ConnectionKey> to_cleanup;
+void ConnectionManager::set_port_policy(PortPolicy port_policy) {
+    port_policies_.push_back(std::make_unique<PortPolicy>(std::move(port_policy)));
+}
+
+bool ConnectionManager::write_checkpoint() {
+    if (checkpoint_file_.empty()) return false;
+
+    std::vector<CheckpointRecord> records;
     {
-        std::lock_guard<std::mutex> lock(cleanup_mutex_);
-        to_cleanup.swap(marked_for_cleanup_);
+        std::lock_guard<std::mutex> lock(connections_mutex_);
+        records.resize(connections_.size());
+        size_t count = 0;
+        for (const auto& pair : connections_) {
+            pair.second->save(records[count++]);
+        }
     }
 
-    if (to_cleanup.empty()) return;
+    // Started an interval ago, so normally long done
+    if (checkpoint_thread_.joinable()) {
+        checkpoint_thread_.join();
+    }
+    checkpoint_thread_ = std::thread([path = checkpoint_file_, records = std::move(records),
+                                      taken_at = PacketClock::now()] {
+        CheckpointWriter writer;
+        if (writer.open(path, records.size(), taken_at)) {
+            std::copy(records.begin(), records.end(), writer.records());
+            writer.commit(records.size());
+        }
+    });
+    return true;
+}
 
+size_t ConnectionManager::restore_checkpoint() {
+    CheckpointReader reader;
+    if (checkpoint_file_.empty() || !reader.open(checkpoint_file_)) {
+        return 0;
+    }
+
+    // Log entries and idle timers carry the checkpoint's packet time
+    PacketClock::set(reader.taken_at());
     std::lock_guard<std::mutex> lock(connections_mutex_);
-    for (const auto& key : to_cleanup) {
-        auto it = connections_.find(key);
-        if (it != connections_.end() && it->second->should_clean_up()) {
-            connections_.erase(it);
+    connections_.reserve(connections_.size() + reader.size());
+    size_t restored = 0;
+    for (size_t i = 0; i < reader.size(); ++i) {
+        const CheckpointRecord& record = reader[i];
+        if (record.client_state > static_cast<uint8_t>(TCPState::TIME_WAIT) ||
+            record.server_state > static_cast<uint8_t>(TCPState::TIME_WAIT)) {
+            continue;
+        }
+        char client_ip[INET_ADDRSTRLEN] = {0}, server_ip[INET_ADDRSTRLEN] = {0};
+        inet_ntop(AF_INET, &record.flow.client_ip, client_ip, sizeof(client_ip));
+        inet_ntop(AF_INET, &record.flow.server_ip, server_ip, sizeof(server_ip));
+        ConnectionKey key(client_ip, record.flow.client_port, server_ip, record.flow.server_port);
+        if (connections_.count(key)) continue;
+
+        auto conn = std::make_unique<Connection>(key, record.id, record.flow);
+        if (record.flags & CHECKPOINT_REASSEMBLY) {
+            for (const auto& factory : port_policies_.back()->lookup(key.dst_port)) {
+                conn->add_candidate(factory);
+            }
         }
+        conn->restore(record);
+        negative_cache_.add_tracked(NegativeFlowCache::hash(key));
+        connections_[key] = std::move(conn);
+        next_id_ = std::max(next_id_, record.id + 1);
+        ++restored;
+    }
+    MetricsRegistry::get_instance().add(MetricCounter::CONNECTIONS_RESTORED, restored);
+    return restored;
+}
+
+ConnectionRow ConnectionManager::make_row(const Connection& conn) {
+    ConnectionRow row;
+    const ConnInfo& info = conn.get_info();
+    const ConnSummary& summary = conn.get_summary();
+    row.flow = info.flow;
+    row.id = conn.get_id();
+    row.first_seen = info.first_seen;
+    row.last_seen = summary.last_seen;
+    row.packets = summary.packets;
+    row.bytes = summary.bytes;
+    row.client_state = conn.get_client_state();
+    row.server_state = conn.get_server_state();
+    row.compacted = conn.get_compact_summary() != nullptr;
+    return row;
+}
+
+void ConnectionManager::start_sweep() {
+    negative_cache_.age();
+    // Rows are copied only for a reader
+    if (snapshots_enabled_.load(std::memory_order_relaxed) ||
+        snapshot_requested_.exchange(false, std::memory_order_relaxed)) {
+        pending_snapshot_ = std::make_unique<ConnectionSnapshot>();
     }
+    sweep_buckets_ = 0;
+    sweeping_ = true;
 }
 
-void ConnectionManager::cleanup_thread_func() {
-    while (running_) {
-        cleanup_marked_connections();
-        std::this_thread::sleep_for(std::chrono::seconds(cleanup_interval_seconds_));
+bool ConnectionManager::sweep_slice(PacketClock::time_point now, size_t max_buckets) {
+    auto& epochs = EpochManager::get_instance();
+    std::lock_guard<std::mutex> lock(connections_mutex_);
+    // A rehash moves connections between buckets, so the sweep starts over
+    // rather than miss some and see others twice
+    if (connections_.bucket_count() != sweep_buckets_) {
+        sweep_buckets_ = connections_.bucket_count();
+        sweep_bucket_ = 0;
+        negative_cache_.begin_rebuild(connections_.size());
+        if (pending_snapshot_) {
+            pending_snapshot_->rows.clear();
+            pending_snapshot_->rows.reserve(connections_.size());
+        }
+    }
+
+    size_t end = sweep_bucket_ + std::min(max_buckets, sweep_buckets_ - sweep_bucket_);
+    for (; sweep_bucket_ < end; ++sweep_bucket_) {
+        for (auto it = connections_.begin(sweep_bucket_); it != connections_.end(sweep_bucket_); ++it) {
+            if (it->second->should_clean_up(now)) {
+                epochs.retire(std::move(it->second));
+                expired_.push_back(it->first);
+            } else {
+                negative_cache_.add_surviving(NegativeFlowCache::hash(it->first));
+                if (pending_snapshot_) {
+                    pending_snapshot_->rows.push_back(make_row(*it->second));
+                }
+            }
+        }
+    }
+    for (const auto& key : expired_) {
+        connections_.erase(key);
+    }
+    expired_.clear();
+    return sweep_bucket_ < sweep_buckets_;
+}
+
+void ConnectionManager::finish_sweep(PacketClock::time_point now) {
+    sweeping_ = false;
+    negative_cache_.end_rebuild();
+    if (!pending_snapshot_) return;
+
+    pending_snapshot_->taken_at = now;
+    const ConnectionSnapshot* previous = snapshot_.exchange(pending_snapshot_.release(), std::memory_order_seq_cst);
+    EpochManager::get_instance().retire(std::unique_ptr<const ConnectionSnapshot>(previous));
+}
+
+void ConnectionManager::set_idle_wake(std::function<void()> wake) {
+    std::lock_guard<std::mutex> lock(reaper_mutex_);
+    idle_wake_ = std::move(wake);
+}
+
+void ConnectionManager::expire_idle() {
+    if (!idle_pending_.exchange(false)) return;
+
+    auto now = last_packet_ + PacketClock::duration(idle_us_.load(std::memory_order_relaxed));
+    PacketClock::set(now);
+    if (!sweeping_) {
+        start_sweep();
+    }
+    // Nothing else wants the capture thread while the link is quiet
+    while (sweep_slice(now, SIZE_MAX)) {
+    }
+    finish_sweep(now);
+    next_cleanup_ = now + cleanup_interval_;
+}
+
+void ConnectionManager::reap_loop() {
+    auto& epochs = EpochManager::get_instance();
+    auto quiet_interval = std::chrono::duration_cast<std::chrono::steady_clock::duration>(cleanup_interval_);
+    uint64_t seen = 0;
+    auto last_packet = std::chrono::steady_clock::now();
+    auto next_wake = last_packet + quiet_interval;
+
+    std::unique_lock<std::mutex> lock(reaper_mutex_);
+    while (!reaper_cv_.wait_for(lock, REAP_INTERVAL, [this] { return reaper_stop_; })) {
+        // Swept connections are destroyed here, not on the capture thread
+        lock.unlock();
+        epochs.reclaim();
+        lock.lock();
+
+        auto wall = std::chrono::steady_clock::now();
+        uint64_t packets = packets_seen_.load(std::memory_order_relaxed);
+        if (packets != seen) {
+            seen = packets;
+            last_packet = wall;
+            next_wake = wall + quiet_interval;
+        } else if (idle_wake_ && seen > 0 && wall >= next_wake) {
+            idle_us_.store(std::chrono::duration_cast<PacketClock::duration>(wall - last_packet).count(),
+                std::memory_order_relaxed);
+            idle_pending_.store(true);
+            idle_wake_();
+            next_wake = wall + quiet_interval;
+        }
     }
 }
@@ -1,5 +1,7 @@
 #include "conn/packet_processor.hpp"
 #include "log/packet_log_entry.hpp"
+#include "misc/packet_clock.hpp"
+#include "misc/metrics_registry.hpp"
 #include <netinet/tcp.h>
 #include <arpa/inet.h>
 #include <chrono>
@@ -51,13 +53,29 @@ bool PacketProcessor::extract_packet(const u_char* packet, const size_t packet_l
 }
 
 void PacketProcessor::handle_packet(const struct pcap_pkthdr* header, const u_char* packet) {
-    if (!validate_packet(header, packet)) return;
+    auto& metrics = MetricsRegistry::get_instance();
+    metrics.add(MetricCounter::PACKETS_RECEIVED);
+    metrics.add(MetricCounter::BYTES_RECEIVED, header->len);
 
     ConnectionKey key;
     PacketKey pkey;
-    if (!extract_packet(packet, header->len, key, pkey)) return;
+    {
+        StageTimer timer(MetricStage::DECODE);
+        if (!validate_packet(header, packet)) {
+            metrics.add(MetricCounter::PACKETS_INVALID);
+            return;
+        }
+        PacketClock::advance(header->ts);
+
+        if (!extract_packet(packet, header->len, key, pkey)) {
+            metrics.add(MetricCounter::PACKETS_MALFORMED);
+            return;
+        }
+    }
 
-    packet_log_.log(std::make_shared<PacketLogEntry>(key, pkey));
+    if (packet_log_.is_enabled()) {
+        packet_log_.log(std::make_shared<PacketLogEntry>(key, pkey));
+    }
     connection_manager_.process_packet(key, pkey);
 }
 
@@ -120,10 +120,8 @@ bool TcpStateMachine::should_enter_time_wait(TCPState current, uint8_t flags, bo
     }
 }
 
-bool TcpStateMachine::should_clean_up(const ConnState& client_state, const ConnState& server_state, 
-                                    const std::chrono::steady_clock::time_point& last_update) const     {
-    auto now = std::chrono::steady_clock::now();
-
+bool TcpStateMachine::should_clean_up(const ConnState& client_state, const ConnState& server_state,
+                                    PacketClock::time_point last_update, PacketClock::time_point now) const {
     // 1. If both sides have definitively reached CLOSED state
     if (client_state.state == TCPState::CLOSED && server_state.state == TCPState::CLOSED) {
         return true;
@@ -0,0 +1,66 @@
+#include "http/delimiter_scan.hpp"
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define TCP_TRACKER_X86_SCAN 1
+#endif
+
+namespace {
+
+const uint8_t* find_line_feed_scalar(const uint8_t* begin, const uint8_t* end) {
+    const void* found = std::memchr(begin, '\n', end - begin);
+    return found ? static_cast<const uint8_t*>(found) : end;
+}
+
+#ifdef TCP_TRACKER_X86_SCAN
+
+__attribute__((target("sse2")))
+const uint8_t* find_line_feed_sse2(const uint8_t* begin, const uint8_t* end) {
+    const __m128i needle = _mm_set1_epi8('\n');
+    const uint8_t* p = begin;
+    for (; end - p >= 16; p += 16) {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(block, needle));
+        if (mask != 0) {
+            return p + __builtin_ctz(mask);
+        }
+    }
+    return find_line_feed_scalar(p, end);
+}
+
+__attribute__((target("avx2")))
+const uint8_t* find_line_feed_avx2(const uint8_t* begin, const uint8_t* end) {
+    const __m256i needle = _mm256_set1_epi8('\n');
+    const uint8_t* p = begin;
+    for (; end - p >= 32; p += 32) {
+        __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, needle)));
+        if (mask != 0) {
+            return p + __builtin_ctz(mask);
+        }
+    }
+    return find_line_feed_sse2(p, end);
+}
+
+#endif
+
+using ScanFunction = const uint8_t* (*)(const uint8_t*, const uint8_t*);
+
+ScanFunction select_scan() {
+#ifdef TCP_TRACKER_X86_SCAN
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return &find_line_feed_avx2;
+    if (__builtin_cpu_supports("sse2")) return &find_line_feed_sse2;
+#endif
+    return &find_line_feed_scalar;
+}
+
+// Chosen once at startup, before any packet is seen
+const ScanFunction scan = select_scan();
+
+} // namespace
+
+const uint8_t* find_line_feed(const uint8_t* begin, const uint8_t* end) {
+    return scan(begin, end);
+}
@@ -0,0 +1,157 @@
+#include "http/http_analyzer.hpp"
+#include "log/conn_log_entry.hpp"
+#include "misc/event_bus.hpp"
+#include "misc/fnv1a.hpp"
+#include <chrono>
+#include <cstring>
+#include <sstream>
+
+ProbeResult probe_http(Direction dir, const uint8_t* data, size_t len) {
+    auto matches = [data, len](const char* token, size_t token_len) {
+        size_t n = len < token_len ? len : token_len;
+        if (std::memcmp(data, token, n) != 0) return ProbeResult::NO_MATCH;
+        return n == token_len ? ProbeResult::MATCH : ProbeResult::NEED_MORE;
+    };
+
+    if (dir == Direction::SERVER_TO_CLIENT) {
+        return matches(HTTP_VERSION_PREFIX, HTTP_VERSION_PREFIX_LEN);
+    }
+
+    // "METHOD "; every method name is shorter than PROBE_BYTES
+    ProbeResult result = ProbeResult::NO_MATCH;
+    for (const char* method : HTTP_METHOD_NAMES) {
+        size_t method_len = std::strlen(method);
+        ProbeResult name = matches(method, method_len);
+        if (name == ProbeResult::MATCH) {
+            if (len == method_len) return ProbeResult::NEED_MORE;
+            if (data[method_len] == ' ') return ProbeResult::MATCH;
+        } else if (name == ProbeResult::NEED_MORE) {
+            result = ProbeResult::NEED_MORE;
+        }
+    }
+    return result;
+}
+
+HttpAnalyzer::HttpAnalyzer()
+    : http_log_(LogManager::get_instance().get_registered_log("http.log")),
+    request_parser_(true, *this),
+    response_parser_(false, *this) {
+}
+
+ParseHint HttpAnalyzer::on_data(Direction dir, const uint8_t* data, size_t len) {
+    if (finished_) {
+        return ParseHint::done();
+    }
+
+    HttpParser& parser = dir == Direction::CLIENT_TO_SERVER ? request_parser_ : response_parser_;
+    if (!parser.feed(data, len)) {
+        finish();
+    }
+    if (finished_) {
+        return ParseHint::done();
+    }
+
+    // Request bodies are parsed so a request completes with its last byte,
+    // which is where response latency is measured from
+    if (dir == Direction::SERVER_TO_CLIENT) {
+        uint64_t skip = response_parser_.skip_body();
+        if (skip > 0) {
+            return ParseHint::skip(skip);
+        }
+    }
+    return ParseHint::more();
+}
+
+void HttpAnalyzer::on_connection_reset() {
+    finish();
+}
+
+void HttpAnalyzer::on_connection_closed() {
+    // Completes a response delimited by the connection close
+    response_parser_.on_end();
+    finish();
+}
+
+HttpBodyRule HttpAnalyzer::on_headers(const HttpMessage& message) {
+    if (message.is_request || pending_count_ == 0) {
+        return HttpBodyRule::NORMAL;
+    }
+
+    const HttpMessage& request = pending_[pending_head_].request;
+    if (message.status == 101 ||
+        (request.method == HttpMethod::CONNECT && message.status >= 200 && message.status < 300)) {
+        // Whatever follows is not HTTP; this response is still recorded
+        request_parser_.enter_tunnel();
+        finish();
+        return HttpBodyRule::TUNNEL;
+    }
+    return request.method == HttpMethod::HEAD ? HttpBodyRule::NO_BODY : HttpBodyRule::NORMAL;
+}
+
+void HttpAnalyzer::on_message_complete(const HttpMessage& message) {
+    if (message.is_request) {
+        if (pending_count_ == MAX_PIPELINE) {
+            finish();
+            return;
+        }
+        PendingRequest& pending = pending_[(pending_head_ + pending_count_) % MAX_PIPELINE];
+        pending.request = message;
+        pending.sent = PacketClock::now();
+        ++pending_count_;
+        return;
+    }
+
+    // Interim responses precede the final one for the same request
+    if (message.status >= 100 && message.status < 200 && message.status != 101) {
+        return;
+    }
+    if (pending_count_ == 0) {
+        // Response without a request we saw, e.g. adopted mid-stream
+        return;
+    }
+
+    const PendingRequest& pending = pending_[pending_head_];
+    record_transaction(pending, message);
+    pending_head_ = (pending_head_ + 1) % MAX_PIPELINE;
+    --pending_count_;
+}
+
+void HttpAnalyzer::record_transaction(const PendingRequest& pending, const HttpMessage& response) {
+    ++transactions_;
+    auto latency = response.start - pending.sent;
+    HttpMetrics::get_instance().record(info_->flow.server_port, pending.request, response, latency);
+
+    if (EventBus::get_instance().is_running()) {
+        AnalyzerEvent event;
+        event.type = AnalyzerEventType::HTTP_TRANSACTION;
+        event.flow = info_->flow;
+        event.time_us = response.start.time_since_epoch().count();
+        const char* host = pending.request.host;
+        event.http_transaction.host_id =
+            host[0] ? fnv1a_32_lower(reinterpret_cast<const uint8_t*>(host), std::strlen(host)) : 0;
+        event.http_transaction.method = static_cast<uint8_t>(pending.request.method);
+        event.http_transaction.status = response.status;
+        event.http_transaction.latency_us = static_cast<uint32_t>(latency.count() > 0 ? latency.count() : 0);
+        event.http_transaction.request_bytes = pending.request.wire_bytes;
+        event.http_transaction.response_bytes = response.wire_bytes;
+        event.http_transaction.body_bytes = response.body_bytes;
+        EventBus::get_instance().publish(event);
+    }
+
+    if (http_log_.is_enabled()) {
+        std::ostringstream oss;
+        oss << get_http_method_name(pending.request.method) << " " << pending.request.host
+            << " status " << response.status
+            << " req " << pending.request.wire_bytes
+            << " resp " << response.wire_bytes
+            << " body " << response.body_bytes
+            << (response.chunked ? " chunked" : "")
+            << " latency_us "
+            << std::chrono::duration_cast<std::chrono::microseconds>(latency).count();
+        http_log_.log(std::make_shared<ConnLogEntry>(*info_->key, oss.str()));
+    }
+}
+
+void HttpAnalyzer::finish() {
+    finished_ = true;
+}
@@ -0,0 +1,44 @@
+#include "http/http_metrics.hpp"
+#include <string>
+
+HttpMetrics& HttpMetrics::get_instance() {
+    static HttpMetrics instance;
+    return instance;
+}
+
+void HttpMetrics::record(uint16_t server_port, const HttpMessage& request, const HttpMessage& response,
+    PacketClock::duration latency) {
+    PortMetrics& metrics = ports_.get(server_port);
+    metrics.requests[static_cast<size_t>(request.method)].fetch_add(1, std::memory_order_relaxed);
+    metrics.responses[http_status_class(response.status)].fetch_add(1, std::memory_order_relaxed);
+    metrics.request_bytes.fetch_add(request.wire_bytes, std::memory_order_relaxed);
+    metrics.response_bytes.fetch_add(response.wire_bytes, std::memory_order_relaxed);
+    metrics.response_size.record(response.body_bytes);
+    // Capture timestamps can step backwards; clamp instead of wrapping
+    metrics.latency.record(latency.count() > 0 ? latency.count() : 0);
+}
+
+void HttpMetrics::report(std::ostream& os) const {
+    for_each_port([&os](uint16_t port, const PortMetrics& metrics) {
+        if (metrics.latency.count() == 0) {
+            return;
+        }
+        os << "HTTP port " << (port ? std::to_string(port) : std::string("other"));
+        for (size_t i = 0; i < static_cast<size_t>(HttpMethod::COUNT); ++i) {
+            uint64_t count = metrics.requests[i].load(std::memory_order_relaxed);
+            if (count != 0) {
+                os << " " << get_http_method_name(static_cast<HttpMethod>(i)) << "=" << count;
+            }
+        }
+        for (size_t i = 1; i < HTTP_STATUS_CLASSES; ++i) {
+            os << " " << i << "xx=" << metrics.responses[i].load(std::memory_order_relaxed);
+        }
+        os << " other=" << metrics.responses[HTTP_STATUS_CLASS_OTHER].load(std::memory_order_relaxed)
+           << " req_bytes=" << metrics.request_bytes.load(std::memory_order_relaxed)
+           << " resp_bytes=" << metrics.response_bytes.load(std::memory_order_relaxed)
+           << " body p50=" << metrics.response_size.percentile(0.5)
+           << " p99=" << metrics.response_size.percentile(0.99)
+           << " latency_us p50=" << metrics.latency.percentile(0.5)
+           << " p99=" << metrics.latency.percentile(0.99) << "\n";
+    });
+}
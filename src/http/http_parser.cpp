@@ -0,0 +1,327 @@
+#include "http/http_parser.hpp"
+#include "http/delimiter_scan.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+char to_lower(char c) {
+    return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+// name must be lower case
+bool equals_ignore_case(const char* data, size_t len, const char* name) {
+    size_t name_len = std::strlen(name);
+    if (len != name_len) return false;
+    for (size_t i = 0; i < len; ++i) {
+        if (to_lower(data[i]) != name[i]) return false;
+    }
+    return true;
+}
+
+// token must be lower case
+bool contains_ignore_case(const char* data, size_t len, const char* token) {
+    size_t token_len = std::strlen(token);
+    for (size_t i = 0; i + token_len <= len; ++i) {
+        if (equals_ignore_case(data + i, token_len, token)) return true;
+    }
+    return false;
+}
+
+bool is_blank(char c) {
+    return c == ' ' || c == '\t';
+}
+
+// "HTTP/1.x" at data, returns x
+bool parse_version(const char* data, size_t len, uint8_t& minor) {
+    if (len != HTTP_VERSION_PREFIX_LEN + 1) return false;
+    if (std::memcmp(data, HTTP_VERSION_PREFIX, HTTP_VERSION_PREFIX_LEN) != 0) return false;
+    char digit = data[HTTP_VERSION_PREFIX_LEN];
+    if (digit < '0' || digit > '9') return false;
+    minor = static_cast<uint8_t>(digit - '0');
+    return true;
+}
+
+} // namespace
+
+HttpParser::HttpParser(bool is_request, Listener& listener)
+    : is_request_(is_request), listener_(listener) {
+    message_.is_request = is_request_;
+}
+
+bool HttpParser::is_line_state(State state) {
+    return state == State::START_LINE || state == State::HEADERS || state == State::CHUNK_SIZE ||
+           state == State::CHUNK_DATA_END || state == State::TRAILERS;
+}
+
+bool HttpParser::feed(const uint8_t* data, size_t len) {
+    const uint8_t* p = data;
+    const uint8_t* end = data + len;
+
+    while (p < end) {
+        if (is_line_state(state_)) {
+            if (message_.wire_bytes == 0) {
+                message_.start = PacketClock::now();
+            }
+
+            const uint8_t* lf = find_line_feed(p, end);
+            size_t line_len = lf - p;
+            if (partial_line_.size() + line_len > HTTP_MAX_LINE_LEN) {
+                state_ = State::ERROR;
+                return false;
+            }
+            if (lf == end) {
+                partial_line_.append(reinterpret_cast<const char*>(p), line_len);
+                message_.wire_bytes += line_len;
+                return true;
+            }
+
+            const char* line = reinterpret_cast<const char*>(p);
+            if (!partial_line_.empty()) {
+                partial_line_.append(line, line_len);
+                line = partial_line_.data();
+                line_len = partial_line_.size();
+            }
+            message_.wire_bytes += (lf + 1) - p;
+            p = lf + 1;
+
+            if (line_len > 0 && line[line_len - 1] == '\r') {
+                --line_len;
+            }
+            bool ok = handle_line(line, line_len);
+            partial_line_.clear();
+            if (!ok) {
+                state_ = State::ERROR;
+                return false;
+            }
+            continue;
+        }
+
+        switch (state_) {
+            case State::BODY:
+            case State::CHUNK_DATA: {
+                size_t take = static_cast<size_t>(std::min<uint64_t>(remaining_, end - p));
+                p += take;
+                remaining_ -= take;
+                message_.body_bytes += take;
+                message_.wire_bytes += take;
+                if (remaining_ == 0) {
+                    if (state_ == State::BODY) {
+                        complete_message();
+                    } else {
+                        state_ = State::CHUNK_DATA_END;
+                    }
+                }
+                break;
+            }
+            case State::BODY_UNTIL_CLOSE:
+                message_.body_bytes += end - p;
+                message_.wire_bytes += end - p;
+                return true;
+            case State::TUNNEL:
+                return true;
+            default:
+                return false;
+        }
+    }
+    return true;
+}
+
+void HttpParser::on_end() {
+    if (state_ == State::BODY_UNTIL_CLOSE) {
+        complete_message();
+    }
+}
+
+uint64_t HttpParser::skip_body() {
+    if ((state_ != State::BODY && state_ != State::CHUNK_DATA) || remaining_ == 0) {
+        return 0;
+    }
+
+    uint64_t skipped = remaining_;
+    message_.body_bytes += skipped;
+    message_.wire_bytes += skipped;
+    remaining_ = 0;
+    if (state_ == State::BODY) {
+        complete_message();
+    } else {
+        state_ = State::CHUNK_DATA_END;
+    }
+    return skipped;
+}
+
+bool HttpParser::handle_line(const char* line, size_t len) {
+    switch (state_) {
+        case State::START_LINE:
+            // Empty lines before a start line are allowed (RFC 9112 Section 2.2)
+            if (len == 0) return true;
+            if (!(is_request_ ? parse_request_line(line, len) : parse_status_line(line, len))) {
+                return false;
+            }
+            state_ = State::HEADERS;
+            return true;
+        case State::HEADERS:
+            if (len == 0) {
+                finish_headers();
+                return true;
+            }
+            return parse_header(line, len);
+        case State::CHUNK_SIZE:
+            return parse_chunk_size(line, len);
+        case State::CHUNK_DATA_END:
+            if (len != 0) return false;
+            state_ = State::CHUNK_SIZE;
+            return true;
+        case State::TRAILERS:
+            if (len == 0) complete_message();
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool HttpParser::parse_request_line(const char* line, size_t len) {
+    // method SP request-target SP HTTP-version
+    const char* method_end = static_cast<const char*>(std::memchr(line, ' ', len));
+    if (!method_end || method_end == line) return false;
+    size_t method_len = method_end - line;
+
+    message_.method = HttpMethod::UNKNOWN;
+    for (size_t i = 0; i < HTTP_KNOWN_METHODS; ++i) {
+        if (std::strlen(HTTP_METHOD_NAMES[i]) == method_len &&
+            std::memcmp(line, HTTP_METHOD_NAMES[i], method_len) == 0) {
+            message_.method = static_cast<HttpMethod>(i);
+            break;
+        }
+    }
+    if (message_.method == HttpMethod::UNKNOWN) {
+        for (size_t i = 0; i < method_len; ++i) {
+            if (line[i] < 'A' || line[i] > 'Z') return false;
+        }
+    }
+
+    size_t version_pos = len;
+    while (version_pos > 0 && line[version_pos - 1] != ' ') {
+        --version_pos;
+    }
+    if (version_pos <= method_len + 1) return false;  // No request-target
+    return parse_version(line + version_pos, len - version_pos, message_.version_minor);
+}
+
+bool HttpParser::parse_status_line(const char* line, size_t len) {
+    // HTTP-version SP 3DIGIT [SP reason-phrase]
+    size_t status_pos = HTTP_VERSION_PREFIX_LEN + 2;
+    if (len < status_pos + 3 || line[status_pos - 1] != ' ') return false;
+    if (!parse_version(line, status_pos - 1, message_.version_minor)) return false;
+
+    uint16_t status = 0;
+    for (size_t i = status_pos; i < status_pos + 3; ++i) {
+        if (line[i] < '0' || line[i] > '9') return false;
+        status = static_cast<uint16_t>(status * 10 + (line[i] - '0'));
+    }
+    if (len > status_pos + 3 && line[status_pos + 3] != ' ') return false;
+    message_.status = status;
+    return true;
+}
+
+bool HttpParser::parse_header(const char* line, size_t len) {
+    // Obsolete line folding continues the previous value; none we track
+    if (is_blank(line[0])) return true;
+
+    const char* colon = static_cast<const char*>(std::memchr(line, ':', len));
+    if (!colon || colon == line) return false;
+    size_t name_len = colon - line;
+
+    const char* value = colon + 1;
+    const char* value_end = line + len;
+    while (value < value_end && is_blank(*value)) ++value;
+    while (value_end > value && is_blank(value_end[-1])) --value_end;
+    size_t value_len = value_end - value;
+
+    if (equals_ignore_case(line, name_len, "content-length")) {
+        // 19 digits always fit in 64 bits
+        if (value_len == 0 || value_len > 19) return false;
+        uint64_t length = 0;
+        for (size_t i = 0; i < value_len; ++i) {
+            if (value[i] < '0' || value[i] > '9') return false;
+            length = length * 10 + (value[i] - '0');
+        }
+        message_.has_content_length = true;
+        message_.content_length = length;
+    } else if (equals_ignore_case(line, name_len, "transfer-encoding")) {
+        // Chunked is always the final coding when present
+        const char* chunked = "chunked";
+        size_t chunked_len = std::strlen(chunked);
+        message_.chunked = value_len >= chunked_len &&
+            equals_ignore_case(value_end - chunked_len, chunked_len, chunked);
+    } else if (equals_ignore_case(line, name_len, "host")) {
+        size_t copy_len = std::min(value_len, HTTP_MAX_HOST_LEN);
+        std::memcpy(message_.host, value, copy_len);
+        message_.host[copy_len] = '\0';
+    } else if (equals_ignore_case(line, name_len, "connection")) {
+        message_.connection_close = contains_ignore_case(value, value_len, "close");
+    }
+    return true;
+}
+
+bool HttpParser::parse_chunk_size(const char* line, size_t len) {
+    // chunk-size [chunk-ext]; 15 hex digits always fit in 64 bits
+    uint64_t size = 0;
+    size_t digits = 0;
+    for (; digits < len; ++digits) {
+        char c = to_lower(line[digits]);
+        uint64_t nibble;
+        if (c >= '0' && c <= '9') nibble = c - '0';
+        else if (c >= 'a' && c <= 'f') nibble = c - 'a' + 10;
+        else break;
+        if (digits == 15) return false;
+        size = (size << 4) | nibble;
+    }
+    if (digits == 0) return false;
+    if (digits < len && line[digits] != ';' && !is_blank(line[digits])) return false;
+
+    if (size == 0) {
+        state_ = State::TRAILERS;
+    } else {
+        remaining_ = size;
+        state_ = State::CHUNK_DATA;
+    }
+    return true;
+}
+
+void HttpParser::finish_headers() {
+    HttpBodyRule rule = listener_.on_headers(message_);
+    if (rule == HttpBodyRule::TUNNEL) {
+        complete_message();
+        state_ = State::TUNNEL;
+        return;
+    }
+
+    if (!is_request_) {
+        // RFC 9112 Section 6.3: these responses never carry a body
+        uint16_t status = message_.status;
+        if (rule == HttpBodyRule::NO_BODY || status < 200 || status == 204 || status == 304) {
+            complete_message();
+            return;
+        }
+    }
+
+    // Transfer-Encoding overrides Content-Length
+    if (message_.chunked) {
+        state_ = State::CHUNK_SIZE;
+    } else if (message_.has_content_length && message_.content_length > 0) {
+        remaining_ = message_.content_length;
+        state_ = State::BODY;
+    } else if (message_.has_content_length || is_request_) {
+        complete_message();
+    } else {
+        state_ = State::BODY_UNTIL_CLOSE;
+    }
+}
+
+void HttpParser::complete_message() {
+    listener_.on_message_complete(message_);
+    message_ = HttpMessage();
+    message_.is_request = is_request_;
+    state_ = State::START_LINE;
+}
@@ -5,9 +5,9 @@
 
 Log::Log(const std::string& filename, bool enabled, bool print_out, const FlushPolicy& policy)
     : filename_(filename), enabled_(enabled), print_out_(print_out), policy_(policy), 
-    update_count_(0), last_flush_time_(std::chrono::steady_clock::now()) {
+    update_count_(0), last_flush_time_(PacketClock::now()) {
     if (enabled_) {
-        file_.open(filename_, std::ios::app);
+        open_locked();
         if (!file_.is_open()) {
             std::cerr << "Failed to open log file: " << filename_ << std::endl;
         }
@@ -15,7 +15,7 @@ Log::Log(const std::string& filename, bool enabled, bool print_out, const FlushP
 }
 
 Log::~Log() {
-    if (enabled_ && file_.is_open()) {
+    if (file_.is_open()) {
         flush();
         file_.close();
     }
@@ -23,8 +23,9 @@ Log::~Log() {
 
 Log::Log(Log&& other) noexcept
     : filename_(std::move(other.filename_)),
-    enabled_(other.enabled_),
-    print_out_(other.print_out_),
+    enabled_(other.enabled_.load()),
+    print_out_(other.print_out_.load()),
+    open_(other.open_.load()),
     policy_(other.policy_),
     file_(std::move(other.file_)),
     buffer_(std::move(other.buffer_)),
@@ -36,8 +37,9 @@ Log& Log::operator=(Log&& other) noexcept {
     if (this != &other) {
         std::lock_guard<std::mutex> lock(mutex_);
         filename_ = std::move(other.filename_);
-        enabled_ = other.enabled_;
-        print_out_ = other.print_out_;
+        enabled_ = other.enabled_.load();
+        print_out_ = other.print_out_.load();
+        open_ = other.open_.load();
         policy_ = other.policy_;
         file_ = std::move(other.file_);
         buffer_ = std::move(other.buffer_);
@@ -52,9 +54,9 @@ bool Log::operator==(const std::string& rhs) const {
 }
 
 void Log::log(const std::shared_ptr<LogEntry>& entry) {
-    if (!enabled_ || !file_.is_open()) return;
+    if (!is_enabled()) return;
 
-    if (print_out_) {
+    if (is_print_out()) {
         std::cout << entry->format() << std::endl;
     }
 
@@ -63,16 +65,37 @@ void Log::log(const std::shared_ptr<LogEntry>& entry) {
     update_count_++;
 
     auto elapsed = std::chrono::duration_cast<std::chrono::minutes>(
-        std::chrono::steady_clock::now() - last_flush_time_).count();
+        PacketClock::now() - last_flush_time_).count();
     if (update_count_ >= policy_.max_updates || elapsed >= policy_.max_minutes) {
-        flush();
+        flush_locked();
         update_count_ = 0;
-        last_flush_time_ = std::chrono::steady_clock::now();
+        last_flush_time_ = PacketClock::now();
+    }
+}
+
+bool Log::set_enabled(bool enabled) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (enabled && !file_.is_open()) {
+        open_locked();
+        if (!file_.is_open()) {
+            std::cerr << "Failed to open log file: " << filename_ << std::endl;
+            return false;
+        }
     }
+    if (!enabled) {
+        flush_locked();
+    }
+    // The file stays open: writers may be past the check already
+    enabled_.store(enabled, std::memory_order_release);
+    return true;
 }
 
 void Log::flush() {
     std::lock_guard<std::mutex> lock(mutex_);
+    flush_locked();
+}
+
+void Log::flush_locked() {
     if (!file_.is_open() || buffer_.empty()) return;
 
     check_size_and_truncate();
@@ -90,12 +113,13 @@ void Log::truncate() {
 
     if (enabled_ && file_.is_open()) {
         file_.close();
+        open_.store(false, std::memory_order_release);
     }
     std::ofstream ofs(filename_, std::ios::trunc);
     ofs << "Log truncated at start of new session\n";
     ofs.close();
     if (enabled_) {
-        file_.open(filename_, std::ios::app);
+        open_locked();
         if (!file_.is_open()) {
             std::cerr << "Failed to reopen log file after truncation: " << filename_ << std::endl;
         }
@@ -108,6 +132,11 @@ void Log::check_size_and_truncate() {
         std::ofstream ofs(filename_, std::ios::trunc);
         ofs << "Log truncated due to size limit\n";
         ofs.close();
-        file_.open(filename_, std::ios::app);
+        open_locked();
     }
 }
+
+void Log::open_locked() {
+    file_.open(filename_, std::ios::app);
+    open_.store(file_.is_open(), std::memory_order_release);
+}
@@ -5,14 +5,15 @@
 UTCOffset* UTCOffset::instance_ = nullptr;
 
 LogEntry::LogEntry()
-    : utc_offset_(UTCOffset::get_instance()->get_offset()), timestamp_(std::chrono::system_clock::now()) {}
+    : utc_offset_(UTCOffset::get_instance()->get_offset()), timestamp_(PacketClock::now()) {}
 
 LogEntry::LogEntry(const ConnectionKey& key)
-    : key_(key), utc_offset_(UTCOffset::get_instance()->get_offset()), timestamp_(std::chrono::system_clock::now()) {}
+    : key_(key), utc_offset_(UTCOffset::get_instance()->get_offset()), timestamp_(PacketClock::now()) {}
 
 std::string LogEntry::get_timestamp() const {
     std::ostringstream oss;
-	auto time_t_val = std::chrono::system_clock::to_time_t(timestamp_);
+	// pcap timestamps count from the Unix epoch, as system_clock does
+	time_t time_t_val = std::chrono::duration_cast<std::chrono::seconds>(timestamp_.time_since_epoch()).count();
     oss << "[" << std::put_time(std::gmtime(&time_t_val), "%Y-%m-%d %H:%M:%S.")
         << std::setfill('0') << std::setw(6) 
         << std::chrono::duration_cast<std::chrono::microseconds>(timestamp_.time_since_epoch()).count() % 1000000
@@ -3,9 +3,14 @@
 #include <iostream>
 
 std::vector<std::string> to_register_logs = {
-    "packet", "tcp", "reassm", "reassm_data", "tls"
+    "packet", "tcp", "reassm", "reassm_data", "tls", "http"
 };
 
+// Their writers are chosen at startup (the TLS sink type) or give up on a
+// connection while the log is off (ReassmAnalyzer), so switching them on
+// or off later would not take effect
+const std::vector<std::string> startup_only_logs = {"reassm_data", "tls"};
+
 LogManager& LogManager::get_instance() {
     static LogManager instance;
     return instance;
@@ -64,3 +69,29 @@ Log& LogManager::get_registered_log(const std::string& filename) {
 
     return dummy_log;
 }
+
+
+bool LogManager::set_enabled(const std::string& channel, bool enabled) {
+    if (std::find(startup_only_logs.begin(), startup_only_logs.end(), channel) != startup_only_logs.end()) {
+        return false;
+    }
+    auto log = std::find(registered_logs_.begin(), registered_logs_.end(), channel + ".log");
+    return log != registered_logs_.end() && log->set_enabled(enabled);
+}
+
+bool LogManager::set_print_out(const std::string& channel, bool print_out) {
+    auto log = std::find(registered_logs_.begin(), registered_logs_.end(), channel + ".log");
+    if (log == registered_logs_.end()) {
+        return false;
+    }
+    log->set_print_out(print_out);
+    return true;
+}
+
+void LogManager::describe(std::ostream& os) {
+    for (auto& log : registered_logs_) {
+        const std::string& filename = log.get_filename();
+        os << filename.substr(0, filename.rfind(".log")) << " " << (log.is_enabled() ? "on" : "off")
+           << " " << (log.is_print_out() ? "print" : "quiet") << "\n";
+    }
+}
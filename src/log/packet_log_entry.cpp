@@ -3,26 +3,27 @@
 #include <iomanip>
 
 PacketLogEntry::PacketLogEntry(const ConnectionKey& key, const PacketKey& pkey)
-    : LogEntry(key), pkey_(pkey) {
+    : LogEntry(key), total_len_(pkey.total_len), flags_(pkey.tcp->th_flags),
+    payload_(pkey.payload, pkey.payload + pkey.payload_len) {
 }
 
 std::string PacketLogEntry::format() const {
     std::ostringstream oss;
     oss << get_timestamp() << get_direction();
-    oss << "len:" << pkey_.total_len <<  "," << pkey_.payload_len << ",";
+    oss << "len:" << total_len_ <<  "," << payload_.size() << ",";
 
     // TCP
     oss << "tcp:"; 
-    if (pkey_.tcp->th_flags & TH_FIN) oss << "fin ";
-    if (pkey_.tcp->th_flags & TH_SYN) oss << "syn ";
-    if (pkey_.tcp->th_flags & TH_RST) oss << "rst ";
-    if (pkey_.tcp->th_flags & TH_PUSH) oss << "psh ";
-    if (pkey_.tcp->th_flags & TH_ACK) oss << "ack ";
-    if (pkey_.tcp->th_flags & TH_URG) oss << "urg ";
+    if (flags_ & TH_FIN) oss << "fin ";
+    if (flags_ & TH_SYN) oss << "syn ";
+    if (flags_ & TH_RST) oss << "rst ";
+    if (flags_ & TH_PUSH) oss << "psh ";
+    if (flags_ & TH_ACK) oss << "ack ";
+    if (flags_ & TH_URG) oss << "urg ";
 
     // Payload
-    if (pkey_.payload_len) oss << std::endl;
-    oss << get_formatted_buffer(pkey_.payload, pkey_.payload_len);
+    if (payload_.size()) oss << std::endl;
+    oss << get_formatted_buffer(payload_.data(), payload_.size());
     return oss.str();
 }
 
@@ -45,6 +45,7 @@ std::string ReassemblyLogEntry::format() const {
             break;
         case ReassmEvent::DATA_IGNORED_FIN:
         case ReassmEvent::DATA_IGNORED_INIT:
+        case ReassmEvent::DATA_IGNORED_IDLE:
             oss << " | Seq:" << segment_seq_ << " Len:" << segment_len_;
             break;
         default:
@@ -68,6 +69,7 @@ std::string ReassemblyLogEntry::event_type_to_string(ReassmEvent type) const {
         case ReassmEvent::SEQ_INITIALIZED: return "INIT";
         case ReassmEvent::DATA_IGNORED_FIN: return "IGN_FIN";
         case ReassmEvent::DATA_IGNORED_INIT: return "IGN_INIT";
+        case ReassmEvent::DATA_IGNORED_IDLE: return "IGN_IDLE";
         case ReassmEvent::SEGMENT_INVALID: return "INVALID";
         case ReassmEvent::SEGMENT_OUT_OF_ORDER: return "OUT_OF_ORDER";
         default: return "UNK";
@@ -1,5 +1,6 @@
 #include "main/args_parser.hpp"
 #include <iostream>
+#include <cstring>
 
 void check_default_argments(ProgramOptions& options)
 {
@@ -29,6 +30,13 @@ void parse_filter_arguments(int argc, char* argv[], int& i, ProgramOptions& opti
             std::cerr << "Error: -f requires a filter string" << std::endl;
             exit(1);
         }
+    } else if (strcmp(argv[i], "-r") == 0) {
+        if (i + 1 < argc) {
+            options.read_file = argv[++i];
+        } else {
+            std::cerr << "Error: -r requires a pcap file path" << std::endl;
+            exit(1);
+        }
     }
 }
 
@@ -44,6 +52,41 @@ void parse_log_arguments(int argc, char* argv[], int& i, ProgramOptions& options
         if (i + 1 < argc && argv[i + 1][0] != '-') {
             parse_extra_arguments(std::string(argv[++i]), options.enabled_print_out_logs);
         }
+    } else if (strcmp(argv[i], "-E") == 0) {
+        if (i + 1 < argc) {
+            options.event_file = argv[++i];
+        } else {
+            std::cerr << "Error: -E requires an event file path" << std::endl;
+            exit(1);
+        }
+    } else if (strcmp(argv[i], "-S") == 0) {
+        if (i + 1 < argc) {
+            options.stream_dir = argv[++i];
+        } else {
+            std::cerr << "Error: -S requires a stream capture directory" << std::endl;
+            exit(1);
+        }
+    } else if (strcmp(argv[i], "-M") == 0) {
+        if (i + 1 < argc) {
+            options.metrics_endpoint = argv[++i];
+        } else {
+            std::cerr << "Error: -M requires a metrics endpoint like unix:/tmp/tcp_tracker.sock or http:9100" << std::endl;
+            exit(1);
+        }
+    } else if (strcmp(argv[i], "-m") == 0) {
+        if (i + 1 < argc) {
+            options.metrics_snapshot = argv[++i];
+        } else {
+            std::cerr << "Error: -m requires a metrics snapshot file path" << std::endl;
+            exit(1);
+        }
+    } else if (strcmp(argv[i], "-C") == 0) {
+        if (i + 1 < argc) {
+            options.control_socket = argv[++i];
+        } else {
+            std::cerr << "Error: -C requires a control socket path" << std::endl;
+            exit(1);
+        }
     }
 }
 
@@ -55,6 +98,15 @@ void parse_tcp_arguments(int argc, char* argv[], int& i, ProgramOptions& options
             std::cerr << "Error: -c requires an integer" << std::endl;
             exit(1);
         }
+    } else if (strcmp(argv[i], "-K") == 0) {
+        if (i + 1 < argc) {
+            options.checkpoint_file = argv[++i];
+        } else {
+            std::cerr << "Error: -K requires a checkpoint file path" << std::endl;
+            exit(1);
+        }
+    } else if (strcmp(argv[i], "-J") == 0) {
+        options.adopt_mid_stream = true;
     }
 }
 
@@ -66,6 +118,20 @@ void parse_reassm_arguments(int argc, char* argv[], int& i, ProgramOptions& opti
             std::cerr << "Error: -a requires analyzers string split with ','" << std::endl;
             exit(1);
         }
+    } else if (strcmp(argv[i], "-P") == 0) {
+        if (i + 1 < argc) {
+            options.port_policy = argv[++i];
+        } else {
+            std::cerr << "Error: -P requires a port policy like \"443,8443:tls;80:http\"" << std::endl;
+            exit(1);
+        }
+    } else if (strcmp(argv[i], "-w") == 0) {
+        if (i + 1 < argc) {
+            options.analyzer_workers = atoi(argv[++i]);
+        } else {
+            std::cerr << "Error: -w requires a number of analyzer worker threads" << std::endl;
+            exit(1);
+        }
     }
 }
 
@@ -75,6 +141,7 @@ ProgramOptions parse_arguments(int argc, char* argv[]) {
     for (int i = 1; i < argc; ++i) {
         parse_filter_arguments(argc, argv, i, options);
         parse_log_arguments(argc, argv, i, options);
+        parse_tcp_arguments(argc, argv, i, options);
         parse_reassm_arguments(argc, argv, i, options);
     }
     check_default_argments(options);
@@ -84,7 +151,8 @@ ProgramOptions parse_arguments(int argc, char* argv[]) {
 }
 
 void print_parsed_message(const ProgramOptions& options) {
-    std::cout << "Starting tcp state tracking on en1 with filter " << options.filter << 
+    std::cout << "Starting tcp state tracking on " <<
+        (options.read_file.empty() ? std::string("en1") : options.read_file) << " with filter " << options.filter << 
         ", debug " << std::string(options.debug_mode ? "on" : "off") << 
         ", flush every 1000 updates or 5 minutes, debounce " <<
         std::to_string(options.cleanup_interval_seconds) + " s" << std::endl;
@@ -94,6 +162,42 @@ void print_parsed_message(const ProgramOptions& options) {
         std::cout << name << std::endl;
     }
 
+    if (!options.port_policy.empty()) {
+        std::cout << "Port policy: " << options.port_policy << std::endl;
+    }
+
+    if (!options.event_file.empty()) {
+        std::cout << "Event file: " << options.event_file << std::endl;
+    }
+
+    if (!options.stream_dir.empty()) {
+        std::cout << "Stream capture directory: " << options.stream_dir << std::endl;
+    }
+
+    if (!options.metrics_endpoint.empty()) {
+        std::cout << "Metrics endpoint: " << options.metrics_endpoint << std::endl;
+    }
+
+    if (!options.metrics_snapshot.empty()) {
+        std::cout << "Metrics snapshot: " << options.metrics_snapshot << std::endl;
+    }
+
+    if (options.adopt_mid_stream) {
+        std::cout << "Adopting mid-stream connections" << std::endl;
+    }
+
+    if (!options.checkpoint_file.empty()) {
+        std::cout << "Checkpoint file: " << options.checkpoint_file << std::endl;
+    }
+
+    if (!options.control_socket.empty()) {
+        std::cout << "Control socket: " << options.control_socket << std::endl;
+    }
+
+    if (options.analyzer_workers > 0) {
+        std::cout << "Analyzer workers: " << options.analyzer_workers << std::endl;
+    }
+
     std::cout << "Active print out modules:" << std::endl;
     for (const auto& name : options.enabled_print_out_logs) {
         std::cout << name << std::endl;
@@ -0,0 +1,359 @@
+#include "main/control_server.hpp"
+#include "main/pcap_handler.hpp"
+#include "conn/connection_manager.hpp"
+#include "log/log_manager.hpp"
+#include "reassm/analyzer_registry.hpp"
+#include "reassm/port_policy.hpp"
+#include <arpa/inet.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+namespace {
+
+// Bounds how long stop() waits for the control thread
+constexpr int POLL_SLICE_MS = 200;
+constexpr size_t MAX_LINE_LEN = 4096;
+
+constexpr const char* HELP =
+    "list [state=NAME] [port=N] [min_age=SEC] [max_age=SEC] [limit=N]\n"
+    "    connections of the latest snapshot\n"
+    "show ID               TCP, reassembly and analyzer state of one connection\n"
+    "log [CHANNEL on|off|print|quiet]\n"
+    "                      show or switch a log channel; tls and reassm_data\n"
+    "                      stay on or off for the whole run\n"
+    "filter EXPR           replace the BPF filter\n"
+    "analyzers NAME,...|none\n"
+    "                      analyzers of new connections, on every port\n"
+    "policy [SPEC]         show or replace the port policy, as -P\n"
+    "quit\n";
+
+bool send_all(int fd, const std::string& text) {
+    const char* data = text.data();
+    size_t len = text.size();
+    while (len > 0) {
+        ssize_t sent = ::send(fd, data, len, MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        data += sent;
+        len -= static_cast<size_t>(sent);
+    }
+    return true;
+}
+
+std::string format_ip(uint32_t ip) {
+    char text[INET_ADDRSTRLEN] = {0};
+    inet_ntop(AF_INET, &ip, text, sizeof(text));
+    return text;
+}
+
+bool parse_state(const std::string& name, TCPState& state) {
+    for (int s = static_cast<int>(TCPState::CLOSED); s <= static_cast<int>(TCPState::TIME_WAIT); ++s) {
+        if (TcpStateMachine::state_to_string(static_cast<TCPState>(s)) == name) {
+            state = static_cast<TCPState>(s);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool parse_seconds(const std::string& text, PacketClock::duration& value) {
+    char* end = nullptr;
+    double seconds = std::strtod(text.c_str(), &end);
+    if (end == text.c_str() || *end != '\0' || seconds < 0) return false;
+    value = std::chrono::duration_cast<PacketClock::duration>(std::chrono::duration<double>(seconds));
+    return true;
+}
+
+std::string rest_of_line(std::istream& args) {
+    std::string rest;
+    std::getline(args >> std::ws, rest);
+    return rest;
+}
+
+} // namespace
+
+ControlServer::~ControlServer() {
+    stop();
+}
+
+bool ControlServer::start(const std::string& path) {
+    sockaddr_un addr{};
+    if (path.empty() || path.size() >= sizeof(addr.sun_path)) {
+        std::cerr << "Invalid control socket path: " << path << std::endl;
+        return false;
+    }
+    addr.sun_family = AF_UNIX;
+    std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+
+    // A socket left by an earlier run would make bind fail; anything else
+    // at the path is not ours to remove
+    struct stat st;
+    if (::lstat(path.c_str(), &st) == 0 && S_ISSOCK(st.st_mode)) {
+        ::unlink(path.c_str());
+    }
+    listen_fd_ = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listen_fd_ < 0 || ::bind(listen_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 ||
+        ::listen(listen_fd_, 4) < 0) {
+        std::cerr << "Failed to listen on control socket " << path << ": " << std::strerror(errno) << std::endl;
+        if (listen_fd_ >= 0) {
+            ::close(listen_fd_);
+            listen_fd_ = -1;
+        }
+        return false;
+    }
+    path_ = path;
+    // list reads the snapshots
+    connection_manager_.enable_snapshots();
+    running_ = true;
+    thread_ = std::thread(&ControlServer::serve_loop, this);
+    return true;
+}
+
+void ControlServer::stop() {
+    {
+        // A command still waiting fails instead of timing out
+        std::lock_guard<std::mutex> lock(job_mutex_);
+        capture_done_ = true;
+        job_ = nullptr;
+    }
+    job_cv_.notify_all();
+
+    if (!running_.exchange(false)) {
+        return;
+    }
+    thread_.join();
+    ::close(listen_fd_);
+    listen_fd_ = -1;
+    ::unlink(path_.c_str());
+}
+
+void ControlServer::run_pending() {
+    std::lock_guard<std::mutex> lock(job_mutex_);
+    if (job_) {
+        job_();
+        job_ = nullptr;
+        job_cv_.notify_all();
+    }
+}
+
+std::string ControlServer::on_capture_thread(const std::function<void()>& job) {
+    bool ran = false;
+    std::unique_lock<std::mutex> lock(job_mutex_);
+    if (capture_done_) {
+        return "capture has ended";
+    }
+    job_ = [&] { job(); ran = true; };
+    pcap_breakloop(handle_);
+    // The job runs under job_mutex_, so it is never abandoned halfway
+    job_cv_.wait_for(lock, std::chrono::milliseconds(COMMAND_TIMEOUT_MS), [this] { return !job_; });
+    if (!ran) {
+        job_ = nullptr;
+        return capture_done_ ? "capture has ended" : "capture thread did not respond";
+    }
+    return "";
+}
+
+void ControlServer::serve_loop() {
+    while (running_.load(std::memory_order_relaxed)) {
+        pollfd pfd{listen_fd_, POLLIN, 0};
+        if (::poll(&pfd, 1, POLL_SLICE_MS) <= 0 || !(pfd.revents & POLLIN)) {
+            continue;
+        }
+        int client = ::accept4(listen_fd_, nullptr, nullptr, SOCK_CLOEXEC);
+        if (client >= 0) {
+            serve(client);
+            ::close(client);
+        }
+    }
+}
+
+void ControlServer::serve(int client) {
+    std::string pending;
+    char buf[512];
+    while (running_.load(std::memory_order_relaxed)) {
+        size_t end;
+        while ((end = pending.find('\n')) != std::string::npos) {
+            std::string line = pending.substr(0, end);
+            pending.erase(0, end + 1);
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+            if (line == "quit") return;
+
+            std::ostringstream out;
+            std::string error = execute(line, out);
+            out << (error.empty() ? "ok" : "error: " + error) << "\n";
+            if (!send_all(client, out.str())) return;
+        }
+        if (pending.size() > MAX_LINE_LEN) {
+            send_all(client, "error: line too long\n");
+            return;
+        }
+
+        pollfd pfd{client, POLLIN, 0};
+        if (::poll(&pfd, 1, POLL_SLICE_MS) <= 0) {
+            continue;
+        }
+        ssize_t n = ::recv(client, buf, sizeof(buf), 0);
+        if (n <= 0) return;
+        pending.append(buf, static_cast<size_t>(n));
+    }
+}
+
+std::string ControlServer::execute(const std::string& line, std::ostream& out) {
+    std::istringstream args(line);
+    std::string command;
+    args >> command;
+
+    if (command.empty()) return "";
+    if (command == "help") {
+        out << HELP;
+        return "";
+    }
+    if (command == "list") return list(args, out);
+    if (command == "show") return show(args, out);
+    if (command == "log") return set_log(args, out);
+    if (command == "filter") return set_filter(rest_of_line(args), out);
+    if (command == "analyzers") return set_analyzers(args, out);
+    if (command == "policy") return set_policy(rest_of_line(args), out);
+    return "unknown command " + command + ", try help";
+}
+
+std::string ControlServer::list(std::istream& args, std::ostream& out) {
+    ConnectionQuery filter;
+    std::string arg;
+    while (args >> arg) {
+        size_t eq = arg.find('=');
+        std::string name = arg.substr(0, eq);
+        std::string value = eq == std::string::npos ? "" : arg.substr(eq + 1);
+        if (name == "state") {
+            TCPState state;
+            if (!parse_state(value, state)) return "unknown state " + value;
+            filter.state = state;
+        } else if (name == "port") {
+            int port = std::atoi(value.c_str());
+            if (port <= 0 || port > 65535) return "invalid port " + value;
+            filter.port = static_cast<uint16_t>(port);
+        } else if (name == "min_age") {
+            if (!parse_seconds(value, filter.min_age)) return "invalid age " + value;
+        } else if (name == "max_age") {
+            if (!parse_seconds(value, filter.max_age)) return "invalid age " + value;
+        } else if (name == "limit") {
+            filter.limit = static_cast<size_t>(std::strtoull(value.c_str(), nullptr, 10));
+        } else {
+            return "unknown filter " + name;
+        }
+    }
+
+    ConnectionSnapshot snapshot = connection_manager_.query(filter);
+    for (const auto& row : snapshot.rows) {
+        double age = std::chrono::duration<double>(snapshot.taken_at - row.first_seen).count();
+        out << row.id << " " << format_ip(row.flow.client_ip) << ":" << row.flow.client_port
+            << " -> " << format_ip(row.flow.server_ip) << ":" << row.flow.server_port
+            << " cli " << TcpStateMachine::state_to_string(row.client_state)
+            << " srv " << TcpStateMachine::state_to_string(row.server_state)
+            << " age " << std::fixed << std::setprecision(1) << age << "s"
+            << " packets " << row.packets[0] << "/" << row.packets[1]
+            << " bytes " << row.bytes[0] << "/" << row.bytes[1]
+            << (row.compacted ? " compacted" : "") << "\n";
+    }
+    out << snapshot.rows.size() << " connections\n";
+    return "";
+}
+
+std::string ControlServer::show(std::istream& args, std::ostream& out) {
+    int id = 0;
+    if (!(args >> id)) return "usage: show ID";
+
+    bool found = false;
+    std::string error = on_capture_thread([&] { found = connection_manager_.describe_connection(id, out); });
+    if (!error.empty()) return error;
+    return found ? "" : "no connection " + std::to_string(id);
+}
+
+std::string ControlServer::set_log(std::istream& args, std::ostream& out) {
+    auto& logs = LogManager::get_instance();
+    std::string channel, mode;
+    if (!(args >> channel)) {
+        logs.describe(out);
+        return "";
+    }
+    args >> mode;
+
+    bool known;
+    if (mode == "on" || mode == "off") {
+        known = logs.set_enabled(channel, mode == "on");
+    } else if (mode == "print" || mode == "quiet") {
+        known = logs.set_print_out(channel, mode == "print");
+    } else {
+        return "usage: log CHANNEL on|off|print|quiet";
+    }
+    return known ? "" : "cannot switch log " + channel;
+}
+
+std::string ControlServer::set_filter(const std::string& filter, std::ostream& out) {
+    if (filter.empty()) return "usage: filter EXPR";
+
+    bool installed = false;
+    std::ostringstream err;
+    std::string error = on_capture_thread([&] { installed = install_filter(handle_, filter, err); });
+    if (!error.empty()) return error;
+    if (!installed) {
+        std::string text = err.str();
+        return text.substr(0, text.find_last_not_of('\n') + 1);
+    }
+    out << "filter " << filter << "\n";
+    return "";
+}
+
+std::string ControlServer::set_analyzers(std::istream& args, std::ostream& out) {
+    std::string list;
+    if (!(args >> list)) return "usage: analyzers NAME,...|none";
+
+    std::vector<std::string> names;
+    if (list != "none") {
+        std::istringstream items(list);
+        std::string name;
+        while (std::getline(items, name, ',')) {
+            if (!AnalyzerRegistry::get_instance().is_analyzer_registered(name)) {
+                return "unknown analyzer " + name;
+            }
+            names.push_back(name);
+        }
+    }
+
+    PortPolicy policy;
+    policy.assign_all(names);
+    return set_policy_on_capture_thread(std::move(policy), out);
+}
+
+std::string ControlServer::set_policy(const std::string& spec, std::ostream& out) {
+    if (spec.empty()) {
+        std::string description;
+        std::string error = on_capture_thread([&] { description = connection_manager_.get_port_policy().describe(); });
+        if (error.empty()) out << description;
+        return error;
+    }
+
+    PortPolicy policy;
+    if (!policy.parse(spec)) return "malformed policy " + spec;
+    return set_policy_on_capture_thread(std::move(policy), out);
+}
+
+std::string ControlServer::set_policy_on_capture_thread(PortPolicy policy, std::ostream& out) {
+    std::string description = policy.describe();
+    std::string error = on_capture_thread([&] { connection_manager_.set_port_policy(std::move(policy)); });
+    if (error.empty()) out << description;
+    return error;
+}
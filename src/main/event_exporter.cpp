@@ -0,0 +1,75 @@
+#include "main/event_exporter.hpp"
+#include "conn/tcp_state_machine.hpp"
+#include "definitions/http_types.hpp"
+#include "tls/handshake_metrics.hpp"
+#include <arpa/inet.h>
+#include <iomanip>
+#include <iostream>
+
+namespace {
+
+void write_endpoint(std::ostream& os, uint32_t ip, uint16_t port) {
+    char buf[INET_ADDRSTRLEN] = {};
+    inet_ntop(AF_INET, &ip, buf, sizeof(buf));
+    os << buf << ":" << port;
+}
+
+} // namespace
+
+bool EventExporter::open(const std::string& path) {
+    file_ = std::make_shared<std::ofstream>(path, std::ios::out | std::ios::app);
+    if (!file_->is_open()) {
+        std::cerr << "Failed to open event file: " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void EventExporter::operator()(const AnalyzerEvent* events, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        write(events[i]);
+    }
+    file_->flush();
+}
+
+void EventExporter::write(const AnalyzerEvent& event) {
+    std::ostream& os = *file_;
+    os << event.time_us << " ";
+    write_endpoint(os, event.flow.client_ip, event.flow.client_port);
+    os << " ";
+    write_endpoint(os, event.flow.server_ip, event.flow.server_port);
+
+    switch (event.type) {
+        case AnalyzerEventType::TLS_HANDSHAKE_DONE: {
+            const auto& tls = event.tls_handshake_done;
+            os << " tls_handshake_done sni=" << std::hex << std::setw(8) << std::setfill('0') << tls.sni_id
+               << " version=" << std::setw(4) << tls.version
+               << " cipher=" << std::setw(4) << tls.cipher << std::dec << std::setfill(' ')
+               << " kind=" << get_handshake_kind_name(static_cast<TLSHandshakeKind>(tls.kind))
+               << " rtt_us=" << tls.rtt_us;
+            break;
+        }
+        case AnalyzerEventType::HTTP_TRANSACTION: {
+            const auto& http = event.http_transaction;
+            os << " http_transaction host=" << std::hex << std::setw(8) << std::setfill('0') << http.host_id
+               << std::dec << std::setfill(' ')
+               << " method=" << get_http_method_name(static_cast<HttpMethod>(http.method))
+               << " status=" << http.status
+               << " latency_us=" << http.latency_us
+               << " req_bytes=" << http.request_bytes
+               << " resp_bytes=" << http.response_bytes
+               << " body_bytes=" << http.body_bytes;
+            break;
+        }
+        case AnalyzerEventType::CONN_CLOSED: {
+            const auto& closed = event.conn_closed;
+            os << " conn_closed cli=" << TcpStateMachine::state_to_string(static_cast<TCPState>(closed.client_state))
+               << " srv=" << TcpStateMachine::state_to_string(static_cast<TCPState>(closed.server_state))
+               << " duration_ms=" << closed.duration_ms
+               << " c2s_packets=" << closed.packets[0] << " c2s_bytes=" << closed.bytes[0]
+               << " s2c_packets=" << closed.packets[1] << " s2c_bytes=" << closed.bytes[1];
+            break;
+        }
+    }
+    os << "\n";
+}
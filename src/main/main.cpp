@@ -1,11 +1,21 @@
 #include "main/args_parser.hpp"
 #include "main/pcap_handler.hpp"
+#include "main/event_exporter.hpp"
+#include "main/metrics_exporter.hpp"
+#include "main/control_server.hpp"
 #include "conn/packet_processor.hpp"
 #include "conn/connection_manager.hpp"  
 #include "reassm/analyzer_registrar.hpp"
+#include "reassm/analyzer_worker_pool.hpp"
+#include "capture/stream_writer.hpp"
 #include "log/log_manager.hpp"
+#include "misc/event_bus.hpp"
+#include "tls/alert_counters.hpp"
+#include "tls/handshake_metrics.hpp"
+#include "http/http_metrics.hpp"
 #include <iostream>
 #include <cstring>
+#include <csignal>
 
 // Global variables for signal handling
 static std::atomic<bool> running(true);
@@ -27,7 +37,7 @@ void setup_signal_handlers() {
 int main(int argc, char* argv[]) {
     ProgramOptions options = parse_arguments(argc, argv);
 
-    pcap_t* handle = initialize_pcap(options.filter);
+    pcap_t* handle = initialize_pcap(options.filter, options.read_file);
     if (!handle) {
         std::cerr << "Initialize pcap failed" << std::endl;
         return -1;
@@ -40,14 +50,84 @@ int main(int argc, char* argv[]) {
         return -1;    
     }
 
-    ConnectionManager conn_manager(options.cleanup_interval_seconds, 
-        AnalyzerRegistrar::create_analyzers(options.enabled_analyzers));
-    PacketProcessor processor(conn_manager); //todo:a way to terminate stuck processor
+    PortPolicy port_policy;
+    auto analyzers = AnalyzerRegistrar::create_analyzers(options.enabled_analyzers);
+    if (options.port_policy.empty()) {
+        port_policy.assign_all(analyzers);
+    } else if (!port_policy.parse(options.port_policy)) {
+        return -1;
+    }
+
+    if (!options.event_file.empty()) {
+        EventExporter exporter;
+        if (!exporter.open(options.event_file)) {
+            return -1;
+        }
+        EventBus::get_instance().subscribe(exporter);
+    }
+    EventBus::get_instance().start();
+
+    if (!options.stream_dir.empty() && !StreamWriter::get_instance().start(options.stream_dir)) {
+        return -1;
+    }
+
+    MetricsExporter metrics_exporter;
+    if ((!options.metrics_endpoint.empty() || !options.metrics_snapshot.empty()) &&
+        !metrics_exporter.start(options.metrics_endpoint, options.metrics_snapshot)) {
+        return -1;
+    }
+
+    if (options.analyzer_workers > 0) {
+        AnalyzerWorkerPool::get_instance().start(options.analyzer_workers);
+    }
+
+    {
+        ConnectionManager conn_manager(options.cleanup_interval_seconds, std::move(port_policy));
+        conn_manager.set_adopt_mid_stream(options.adopt_mid_stream);
+        // A replay has no quiet periods; its packet time alone drives expiry
+        if (options.read_file.empty()) {
+            conn_manager.set_idle_wake([handle] { pcap_breakloop(handle); });
+        }
+        if (!options.checkpoint_file.empty()) {
+            conn_manager.set_checkpoint_file(options.checkpoint_file);
+            std::cout << "Restored " << conn_manager.restore_checkpoint() << " connections" << std::endl;
+        }
+        PacketProcessor processor(conn_manager); //todo:a way to terminate stuck processor
+        ControlServer control(conn_manager, handle);
+        if (!options.control_socket.empty() && !control.start(options.control_socket)) {
+            return -1;
+        }
+
+        setup_signal_handlers();
+        pcap_handle = handle;  // Set global handle for signal handler
+        // Control commands and expiry on a quiet link break the loop to run
+        // on this thread; a signal ends it
+        run_packet_capture(handle, reinterpret_cast<u_char*>(&processor), [&] {
+            control.run_pending();
+            conn_manager.expire_idle();
+            return running.load();
+        });
+        pcap_handle = nullptr; // Reset global handle
+        control.stop();
+        pcap_close(handle);
+        conn_manager.write_checkpoint();
+
+        // Drain queued analyzer work before reading its results
+        AnalyzerWorkerPool::get_instance().stop();
+    }
+    // Connections still open were closed above; deliver their close events
+    // and write out their streams and index records
+    EventBus::get_instance().stop();
+    StreamWriter::get_instance().stop();
+    // Last snapshot sees every connection closed
+    metrics_exporter.stop();
 
-    setup_signal_handlers();
-    pcap_handle = handle;  // Set global handle for signal handler
-    run_packet_capture(handle, reinterpret_cast<u_char*>(&processor));
-    pcap_handle = nullptr; // Reset global handle
+    AnalyzerWorkerPool::get_instance().report(std::cout);
+    HandshakeMetrics::get_instance().report(std::cout);
+    AlertCounters::get_instance().report(std::cout);
+    HttpMetrics::get_instance().report(std::cout);
+    StreamWriter::get_instance().report(std::cout);
+    EventBus::get_instance().report(std::cout);
 
     return 0;
 }
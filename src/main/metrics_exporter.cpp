@@ -0,0 +1,189 @@
+#include "main/metrics_exporter.hpp"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+namespace {
+
+constexpr const char* UNIX_PREFIX = "unix:";
+constexpr const char* HTTP_PREFIX = "http:";
+// Bounds how long stop() waits for the scraper thread
+constexpr int POLL_SLICE_MS = 200;
+constexpr size_t MAX_REQUEST_LEN = 4096;
+
+bool send_all(int fd, const char* data, size_t len) {
+    while (len > 0) {
+        ssize_t sent = ::send(fd, data, len, MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        data += sent;
+        len -= static_cast<size_t>(sent);
+    }
+    return true;
+}
+
+} // namespace
+
+MetricsExporter::~MetricsExporter() {
+    stop();
+}
+
+bool MetricsExporter::start(const std::string& endpoint, const std::string& snapshot_file) {
+    if (endpoint.rfind(UNIX_PREFIX, 0) == 0) {
+        if (!listen_unix(endpoint.substr(std::strlen(UNIX_PREFIX)))) return false;
+    } else if (endpoint.rfind(HTTP_PREFIX, 0) == 0) {
+        if (!listen_http(endpoint.substr(std::strlen(HTTP_PREFIX)))) return false;
+    } else if (!endpoint.empty()) {
+        std::cerr << "Metrics endpoint must be unix:PATH or http:PORT, got " << endpoint << std::endl;
+        return false;
+    }
+
+    snapshot_file_ = snapshot_file;
+    snapshot_ = std::make_unique<MetricsRegistry::Snapshot>();
+    MetricsRegistry::get_instance().enable_timing();
+    running_ = true;
+    thread_ = std::thread(&MetricsExporter::scrape_loop, this);
+    return true;
+}
+
+void MetricsExporter::stop() {
+    if (!running_.exchange(false)) {
+        return;
+    }
+    thread_.join();
+    if (!snapshot_file_.empty()) {
+        write_snapshot(render());
+    }
+    if (listen_fd_ >= 0) {
+        ::close(listen_fd_);
+        listen_fd_ = -1;
+    }
+    if (!unix_path_.empty()) {
+        ::unlink(unix_path_.c_str());
+    }
+}
+
+bool MetricsExporter::listen_unix(const std::string& path) {
+    sockaddr_un addr{};
+    if (path.empty() || path.size() >= sizeof(addr.sun_path)) {
+        std::cerr << "Invalid metrics socket path: " << path << std::endl;
+        return false;
+    }
+    addr.sun_family = AF_UNIX;
+    std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+
+    listen_fd_ = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    // A socket file left by an earlier run would make bind fail
+    ::unlink(path.c_str());
+    if (listen_fd_ < 0 || ::bind(listen_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 ||
+        ::listen(listen_fd_, 8) < 0) {
+        std::cerr << "Failed to listen on metrics socket " << path << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    unix_path_ = path;
+    return true;
+}
+
+bool MetricsExporter::listen_http(const std::string& port) {
+    int number = std::atoi(port.c_str());
+    if (number <= 0 || number > 65535) {
+        std::cerr << "Invalid metrics port: " << port << std::endl;
+        return false;
+    }
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(number));
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    listen_fd_ = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    int reuse = 1;
+    if (listen_fd_ < 0 || ::setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse)) < 0 ||
+        ::bind(listen_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 ||
+        ::listen(listen_fd_, 8) < 0) {
+        std::cerr << "Failed to listen on metrics port " << port << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    http_ = true;
+    return true;
+}
+
+void MetricsExporter::scrape_loop() {
+    auto next_snapshot = std::chrono::steady_clock::now();
+    while (running_.load(std::memory_order_relaxed)) {
+        auto now = std::chrono::steady_clock::now();
+        if (!snapshot_file_.empty() && now >= next_snapshot) {
+            write_snapshot(render());
+            next_snapshot = now + std::chrono::milliseconds(SCRAPE_INTERVAL_MS);
+        }
+
+        if (listen_fd_ < 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(POLL_SLICE_MS));
+            continue;
+        }
+        pollfd pfd{listen_fd_, POLLIN, 0};
+        if (::poll(&pfd, 1, POLL_SLICE_MS) <= 0 || !(pfd.revents & POLLIN)) {
+            continue;
+        }
+        int client = ::accept4(listen_fd_, nullptr, nullptr, SOCK_CLOEXEC);
+        if (client >= 0) {
+            // Aggregated per request, so scrapes are never stale
+            serve(client, render());
+            ::close(client);
+        }
+    }
+}
+
+std::string MetricsExporter::render() {
+    MetricsRegistry::get_instance().scrape(*snapshot_);
+    std::ostringstream oss;
+    MetricsRegistry::write_prometheus(*snapshot_, oss);
+    return oss.str();
+}
+
+void MetricsExporter::serve(int client, const std::string& text) {
+    if (http_) {
+        // Any request gets the metrics; read up to the end of its headers
+        timeval timeout{0, POLL_SLICE_MS * 1000};
+        ::setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        std::string request;
+        char buf[512];
+        while (request.find("\r\n\r\n") == std::string::npos && request.size() < MAX_REQUEST_LEN) {
+            ssize_t n = ::recv(client, buf, sizeof(buf), 0);
+            if (n <= 0) break;
+            request.append(buf, static_cast<size_t>(n));
+        }
+        std::string header = "HTTP/1.0 200 OK\r\n"
+                             "Content-Type: text/plain; version=0.0.4\r\n"
+                             "Content-Length: " + std::to_string(text.size()) + "\r\n"
+                             "Connection: close\r\n\r\n";
+        if (!send_all(client, header.data(), header.size())) return;
+    }
+    send_all(client, text.data(), text.size());
+}
+
+void MetricsExporter::write_snapshot(const std::string& text) {
+    // Readers never see a half written file
+    std::string tmp = snapshot_file_ + ".tmp";
+    {
+        std::ofstream file(tmp, std::ios::trunc);
+        if (!file.is_open()) {
+            std::cerr << "Failed to write metrics snapshot: " << tmp << std::endl;
+            return;
+        }
+        file << text;
+    }
+    std::rename(tmp.c_str(), snapshot_file_.c_str());
+}
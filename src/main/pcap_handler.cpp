@@ -3,27 +3,39 @@
 #include <csignal>
 #include <iostream>
 
-pcap_t* initialize_pcap(const std::string& filter) {
+pcap_t* initialize_pcap(const std::string& filter, const std::string& read_file) {
     char errbuf[PCAP_ERRBUF_SIZE];
-    pcap_t* handle = pcap_open_live("en1", BUFSIZ, 1, 1000, errbuf);
+    pcap_t* handle = read_file.empty() ? pcap_open_live("en1", BUFSIZ, 1, 1000, errbuf)
+                                       : pcap_open_offline(read_file.c_str(), errbuf);
     if (!handle) {
-        std::cerr << "Couldn't open device: " << errbuf << std::endl;
+        std::cerr << "Couldn't open " << (read_file.empty() ? "device" : read_file) << ": " << errbuf << std::endl;
         return nullptr;
     }
 
-    struct bpf_program fp;
-    if (pcap_compile(handle, &fp, filter.c_str(), 0, PCAP_NETMASK_UNKNOWN) == -1 ||
-        pcap_setfilter(handle, &fp) == -1) {
-        std::cerr << "Couldn't install filter: " << pcap_geterr(handle) << std::endl;
+    if (!install_filter(handle, filter, std::cerr)) {
         pcap_close(handle);
         return nullptr;
     }
     return handle;
 }
 
-void run_packet_capture(pcap_t* handle, u_char* processor) {
-    pcap_loop(handle, 0, packet_callback, processor);
-    pcap_close(handle);    // Cleanup after pcap_loop returns
+bool install_filter(pcap_t* handle, const std::string& filter, std::ostream& err) {
+    struct bpf_program fp;
+    if (pcap_compile(handle, &fp, filter.c_str(), 0, PCAP_NETMASK_UNKNOWN) == -1) {
+        err << "Couldn't compile filter: " << pcap_geterr(handle) << std::endl;
+        return false;
+    }
+    bool installed = pcap_setfilter(handle, &fp) != -1;
+    if (!installed) {
+        err << "Couldn't install filter: " << pcap_geterr(handle) << std::endl;
+    }
+    pcap_freecode(&fp);
+    return installed;
+}
+
+void run_packet_capture(pcap_t* handle, u_char* processor, const std::function<bool()>& on_break) {
+    while (pcap_loop(handle, 0, packet_callback, processor) == PCAP_ERROR_BREAK && on_break && on_break()) {
+    }
 
     std::cout << "Program terminated cleanly" << std::endl;
 }
@@ -0,0 +1,81 @@
+#include "misc/epoch_manager.hpp"
+#include <algorithm>
+#include <iterator>
+#include <thread>
+
+EpochManager& EpochManager::get_instance() {
+    static EpochManager instance;
+    return instance;
+}
+
+EpochManager::ReaderSlot& EpochManager::local() {
+    static thread_local ReaderSlot* slot = nullptr;
+    if (!slot) {
+        std::lock_guard<std::mutex> lock(readers_mutex_);
+        readers_.push_back(std::make_unique<ReaderSlot>());
+        slot = readers_.back().get();
+    }
+    return *slot;
+}
+
+void EpochManager::retire_node(std::unique_ptr<Retired> node) {
+    // Readers entering after this increment can no longer reach the object
+    node->epoch = epoch_.fetch_add(1, std::memory_order_seq_cst);
+    node->retired_at = PacketClock::now();
+    std::lock_guard<std::mutex> lock(retired_mutex_);
+    retired_.push_back(std::move(node));
+}
+
+uint64_t EpochManager::oldest_reader() const {
+    uint64_t oldest = UINT64_MAX;
+    std::lock_guard<std::mutex> lock(readers_mutex_);
+    for (const auto& slot : readers_) {
+        uint64_t epoch = slot->epoch.load(std::memory_order_seq_cst);
+        if (epoch != 0) oldest = std::min(oldest, epoch);
+    }
+    return oldest;
+}
+
+void EpochManager::reclaim() {
+    uint64_t oldest = oldest_reader();
+    std::vector<std::unique_ptr<Retired>> freed;
+    {
+        std::lock_guard<std::mutex> lock(retired_mutex_);
+        auto keep = std::partition(retired_.begin(), retired_.end(),
+            [oldest](const std::unique_ptr<Retired>& node) { return node->epoch >= oldest; });
+        std::move(keep, retired_.end(), std::back_inserter(freed));
+        retired_.erase(keep, retired_.end());
+    }
+    // Destructors run outside the lock; they may retire more. Whatever they
+    // log or publish is stamped with the time the object was retired, not
+    // with this thread's clock
+    auto clock = PacketClock::now();
+    for (auto& node : freed) {
+        PacketClock::set(node->retired_at);
+        node.reset();
+    }
+    PacketClock::set(clock);
+}
+
+void EpochManager::synchronize() {
+    uint64_t target = epoch_.fetch_add(1, std::memory_order_seq_cst);
+    while (oldest_reader() <= target) {
+        std::this_thread::yield();
+    }
+    reclaim();
+}
+
+EpochGuard::EpochGuard() : slot_(EpochManager::get_instance().local()) {
+    if (slot_.depth++ == 0) {
+        slot_.epoch.store(EpochManager::get_instance().epoch_.load(std::memory_order_seq_cst),
+                          std::memory_order_seq_cst);
+        // The slot must be visible before any shared pointer is loaded
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+    }
+}
+
+EpochGuard::~EpochGuard() {
+    if (--slot_.depth == 0) {
+        slot_.epoch.store(0, std::memory_order_release);
+    }
+}
@@ -0,0 +1,87 @@
+#include "misc/event_bus.hpp"
+#include <chrono>
+
+EventBus& EventBus::get_instance() {
+    static EventBus instance;
+    return instance;
+}
+
+EventBus::~EventBus() {
+    stop();
+}
+
+void EventBus::subscribe(Subscriber subscriber) {
+    subscribers_.push_back(std::move(subscriber));
+}
+
+void EventBus::start() {
+    if (subscribers_.empty() || running_) {
+        return;
+    }
+    running_ = true;
+    thread_ = std::thread(&EventBus::dispatch_loop, this);
+}
+
+void EventBus::stop() {
+    running_ = false;
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+EventBus::Ring& EventBus::local_ring() {
+    // The bus is a process-wide singleton, so one ring per thread suffices
+    static thread_local Ring* ring = nullptr;
+    if (!ring) {
+        std::lock_guard<std::mutex> lock(rings_mutex_);
+        rings_.push_back(std::make_unique<Ring>(RING_CAPACITY));
+        ring = rings_.back().get();
+    }
+    return *ring;
+}
+
+size_t EventBus::drain() {
+    {
+        std::lock_guard<std::mutex> lock(rings_mutex_);
+        for (size_t i = drain_rings_.size(); i < rings_.size(); ++i) {
+            drain_rings_.push_back(rings_[i].get());
+        }
+    }
+
+    AnalyzerEvent batch[BATCH_SIZE];
+    size_t delivered = 0;
+    for (Ring* ring : drain_rings_) {
+        size_t count = 0;
+        while (count < BATCH_SIZE && ring->try_pop(batch[count])) {
+            ++count;
+        }
+        if (count == 0) {
+            continue;
+        }
+        for (const auto& subscriber : subscribers_) {
+            subscriber(batch, count);
+        }
+        delivered += count;
+    }
+    return delivered;
+}
+
+void EventBus::dispatch_loop() {
+    while (running_.load(std::memory_order_acquire)) {
+        if (drain() == 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+    // Publishers see running_ cleared; hand over what they queued before
+    while (drain() > 0) {
+    }
+}
+
+void EventBus::report(std::ostream& os) const {
+    if (subscribers_.empty()) {
+        return;
+    }
+    os << "Event bus subscribers=" << subscribers_.size()
+       << " published=" << published_.load(std::memory_order_relaxed)
+       << " dropped=" << dropped_.load(std::memory_order_relaxed) << "\n";
+}
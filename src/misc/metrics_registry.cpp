@@ -0,0 +1,96 @@
+#include "misc/metrics_registry.hpp"
+#include <iterator>
+
+namespace {
+
+struct MetricName {
+    const char* name;
+    const char* help;
+};
+
+constexpr MetricName COUNTER_NAMES[] = {
+    {"tcp_tracker_packets_received_total", "Packets handed over by pcap"},
+    {"tcp_tracker_bytes_received_total", "Wire bytes of the packets handed over by pcap"},
+    {"tcp_tracker_packets_invalid_total", "Packets too short or not TCP"},
+    {"tcp_tracker_packets_malformed_total", "Packets whose headers did not add up"},
+    {"tcp_tracker_connections_created_total", "Connections opened on a SYN"},
+    {"tcp_tracker_connection_misses_total", "Packets of connections not seen from their SYN"},
+    {"tcp_tracker_segments_out_of_order_total", "Segments buffered ahead of the expected sequence"},
+    {"tcp_tracker_connections_restored_total", "Connections loaded from a checkpoint"},
+    {"tcp_tracker_connections_adopted_total", "Connections adopted mid-stream, without a SYN"},
+    {"tcp_tracker_negative_cache_hits_total", "Packets of untracked flows dropped before the connection table lookup"},
+    {"tcp_tracker_negative_cache_false_positives_total", "Negative cache hits on tracked connections, caught by the tracked-flow filter"},
+};
+static_assert(std::size(COUNTER_NAMES) == static_cast<size_t>(MetricCounter::COUNT), "One name per counter");
+
+constexpr MetricName GAUGE_NAMES[] = {
+    {"tcp_tracker_connections_active", "Connections currently tracked"},
+    {"tcp_tracker_reassembly_buffered_bytes", "Out-of-order payload bytes held by reassembly"},
+    {"tcp_tracker_reassembly_buffered_segments", "Out-of-order segments held by reassembly"},
+};
+static_assert(std::size(GAUGE_NAMES) == static_cast<size_t>(MetricGauge::COUNT), "One name per gauge");
+
+constexpr const char* STAGE_NAMES[] = {"decode", "lookup", "reassembly", "analyzer"};
+static_assert(std::size(STAGE_NAMES) == static_cast<size_t>(MetricStage::COUNT), "One name per stage");
+
+constexpr double QUANTILES[] = {0.5, 0.9, 0.99, 0.999};
+
+} // namespace
+
+MetricsRegistry& MetricsRegistry::get_instance() {
+    static MetricsRegistry instance;
+    return instance;
+}
+
+MetricsRegistry::ThreadMetrics& MetricsRegistry::local() {
+    // The registry is a process-wide singleton, so one block per thread suffices
+    static thread_local ThreadMetrics* metrics = nullptr;
+    if (!metrics) {
+        std::lock_guard<std::mutex> lock(threads_mutex_);
+        threads_.push_back(std::make_unique<ThreadMetrics>());
+        metrics = threads_.back().get();
+    }
+    return *metrics;
+}
+
+void MetricsRegistry::scrape(Snapshot& snapshot) const {
+    snapshot = Snapshot();
+    std::lock_guard<std::mutex> lock(threads_mutex_);
+    for (const auto& metrics : threads_) {
+        for (size_t i = 0; i < snapshot.counters.size(); ++i) {
+            snapshot.counters[i] += metrics->counters[i].load(std::memory_order_relaxed);
+        }
+        for (size_t i = 0; i < snapshot.gauges.size(); ++i) {
+            snapshot.gauges[i] += metrics->gauges[i].load(std::memory_order_relaxed);
+        }
+        for (size_t i = 0; i < snapshot.stages.size(); ++i) {
+            snapshot.stages[i].add(metrics->stages[i]);
+        }
+    }
+}
+
+void MetricsRegistry::write_prometheus(const Snapshot& snapshot, std::ostream& os) {
+    for (size_t i = 0; i < snapshot.counters.size(); ++i) {
+        os << "# HELP " << COUNTER_NAMES[i].name << " " << COUNTER_NAMES[i].help << "\n"
+           << "# TYPE " << COUNTER_NAMES[i].name << " counter\n"
+           << COUNTER_NAMES[i].name << " " << snapshot.counters[i] << "\n";
+    }
+    for (size_t i = 0; i < snapshot.gauges.size(); ++i) {
+        os << "# HELP " << GAUGE_NAMES[i].name << " " << GAUGE_NAMES[i].help << "\n"
+           << "# TYPE " << GAUGE_NAMES[i].name << " gauge\n"
+           << GAUGE_NAMES[i].name << " " << snapshot.gauges[i] << "\n";
+    }
+
+    const char* latency = "tcp_tracker_stage_latency_seconds";
+    os << "# HELP " << latency << " Wall time per packet or chunk of each processing stage\n"
+       << "# TYPE " << latency << " summary\n";
+    for (size_t i = 0; i < snapshot.stages.size(); ++i) {
+        const HdrSnapshot& stage = snapshot.stages[i];
+        for (double q : QUANTILES) {
+            os << latency << "{stage=\"" << STAGE_NAMES[i] << "\",quantile=\"" << q << "\"} "
+               << stage.percentile(q) * 1e-9 << "\n";
+        }
+        os << latency << "_sum{stage=\"" << STAGE_NAMES[i] << "\"} " << stage.sum * 1e-9 << "\n"
+           << latency << "_count{stage=\"" << STAGE_NAMES[i] << "\"} " << stage.count << "\n";
+    }
+}
@@ -1,6 +1,11 @@
 #include "reassm/analyzer_registrar.hpp"
 #include "tls/tls_analyzer.hpp"
 #include "reassm/reassm_analyzer.hpp"
+#include "http/http_analyzer.hpp"
+#include "capture/stream_capture_analyzer.hpp"
+#ifdef TCP_TRACKER_STATIC_ANALYZERS
+#include "reassm/static_analyzers.hpp"
+#endif
 #include <iostream>
 
 std::vector<std::string> AnalyzerRegistrar::create_analyzers(const std::vector<std::string>& enabled_analyzers) {
@@ -10,13 +15,10 @@ std::vector<std::string> AnalyzerRegistrar::create_analyzers(const std::vector<s
     // Register all available analyzers
     register_default_analyzers();
 
-    // Create dummy key for initial analyzer creation
-    ConnectionKey dummy_key;
-
     // Create enabled analyzers
     for (const auto& analyzer_name : enabled_analyzers) {
         if (registry.is_analyzer_registered(analyzer_name)) {
-            if (auto analyzer = registry.create_analyzer(analyzer_name, dummy_key)) {
+            if (auto analyzer = registry.create_analyzer(analyzer_name)) {
                 checked_analyzers.push_back(analyzer_name);
             } else {
                 std::cerr << "Warning: Failed to create analyzer: " 
@@ -34,40 +36,97 @@ std::vector<std::string> AnalyzerRegistrar::create_analyzers(const std::vector<s
 void AnalyzerRegistrar::register_default_analyzers() {
     register_tls_analyzer();
     register_reassm_analyzer();
+    register_http_analyzer();
+    register_stream_analyzer();
 }
 
 void AnalyzerRegistrar::register_tls_analyzer() {
-    auto creator = [](const ConnectionKey& key) {
-        return std::make_shared<TLSAnalyzer>(key);
-    };
+    // Pick the logging instantiation once; without tls.log the whole TLS
+    // stack is built against NullTLSSink
+    bool logging = LogManager::get_instance().get_registered_log("tls.log").is_enabled();
+    AnalyzerRegistry::AnalyzerCreator creator;
+    if (logging) {
+        creator = []() -> std::shared_ptr<IProtocolAnalyzer> {
+            return std::make_shared<TLSAnalyzer<TLSLogSink>>();
+        };
+    } else {
+        creator = []() -> std::shared_ptr<IProtocolAnalyzer> {
+            return std::make_shared<TLSAnalyzer<NullTLSSink>>();
+        };
+    }
     
+    int static_slot = -1;
+#ifdef TCP_TRACKER_STATIC_ANALYZERS
+    // The static slot has logging compiled out; with tls.log the dynamic
+    // factory above is used instead
+    if (!logging) {
+        static_slot = StaticAnalyzers::slot_of<TLSAnalyzer<NullTLSSink>>();
+    }
+#endif
+
     AnalyzerRegistry::get_instance().register_analyzer(
         "tls",
         creator,
-        "TLS protocol analyzer for tracking handshake and state"
+        "TLS protocol analyzer for tracking handshake and state",
+        &probe_tls,
+        static_slot
     );
 }
 
 void AnalyzerRegistrar::register_reassm_analyzer() {
-    auto reassm_creator = [](const ConnectionKey& key) {
-        return std::make_shared<ReassmAnalyzer>(key);
+    AnalyzerRegistry::AnalyzerCreator reassm_creator = []() -> std::shared_ptr<IProtocolAnalyzer> {
+        return std::make_shared<ReassmAnalyzer>();
     };
 
+    int static_slot = -1;
+#ifdef TCP_TRACKER_STATIC_ANALYZERS
+    static_slot = StaticAnalyzers::slot_of<ReassmAnalyzer>();
+#endif
+
     AnalyzerRegistry::get_instance().register_analyzer(
         "reassm",
         reassm_creator,
-        "Reassembly debug analyzer for tracking TCP stream reassembly"
+        "Reassembly debug analyzer for tracking TCP stream reassembly",
+        nullptr,
+        static_slot
+    );
+}
+
+void AnalyzerRegistrar::register_http_analyzer() {
+    AnalyzerRegistry::AnalyzerCreator http_creator = []() -> std::shared_ptr<IProtocolAnalyzer> {
+        return std::make_shared<HttpAnalyzer>();
+    };
+
+    AnalyzerRegistry::get_instance().register_analyzer(
+        "http",
+        http_creator,
+        "HTTP/1.x analyzer for request/response sizes, status and latency",
+        &probe_http
+    );
+}
+
+void AnalyzerRegistrar::register_stream_analyzer() {
+    AnalyzerRegistry::AnalyzerCreator stream_creator = []() -> std::shared_ptr<IProtocolAnalyzer> {
+        return std::make_shared<StreamCaptureAnalyzer>();
+    };
+
+    AnalyzerRegistry::get_instance().register_analyzer(
+        "stream",
+        stream_creator,
+        "Raw reassembled stream capture, one file per direction (see -S)"
     );
 }
 
 void AnalyzerRegistrar::register_custom_analyzer(
     const std::string& name,
     AnalyzerRegistry::AnalyzerCreator creator,
-    const std::string& description) {
+    const std::string& description,
+    AnalyzerProbe probe) {
     
     AnalyzerRegistry::get_instance().register_analyzer(
         name,
-        std::move(creator),
-        description
+        creator,
+        description,
+        probe
     );
 }
@@ -9,24 +9,39 @@ AnalyzerRegistry& AnalyzerRegistry::get_instance() {
 void AnalyzerRegistry::register_analyzer(
     const std::string& name,
     AnalyzerCreator creator,
-    const std::string& description) {
+    const std::string& description,
+    AnalyzerProbe probe,
+    int static_slot) {
     
     if (creator == nullptr) {
         throw std::invalid_argument("Creator function cannot be null");
     }
 
-    analyzers_[name] = AnalyzerInfo{std::move(creator), description};
+    analyzers_[name] = AnalyzerInfo{creator, description, probe, static_slot};
+}
+
+std::vector<AnalyzerRegistry::AnalyzerFactory>
+AnalyzerRegistry::get_factories(const std::vector<std::string>& analyzer_names) const {
+    std::vector<AnalyzerFactory> factories;
+
+    for (const auto& name : analyzer_names) {
+        auto it = analyzers_.find(name);
+        if (it != analyzers_.end()) {
+            factories.push_back(AnalyzerFactory{name, it->second.creator, it->second.probe, it->second.static_slot});
+        }
+    }
+
+    return factories;
 }
 
 std::vector<std::shared_ptr<IProtocolAnalyzer>> 
 AnalyzerRegistry::create_analyzers(
-    const ConnectionKey& key,
     const std::vector<std::string>& analyzer_names) const {
     
     std::vector<std::shared_ptr<IProtocolAnalyzer>> analyzers;
     
     for (const auto& name : analyzer_names) {
-        if (auto analyzer = create_analyzer(name, key)) {
+        if (auto analyzer = create_analyzer(name)) {
             analyzers.push_back(std::move(analyzer));
         }
     }
@@ -35,16 +50,14 @@ AnalyzerRegistry::create_analyzers(
 }
 
 std::shared_ptr<IProtocolAnalyzer> 
-AnalyzerRegistry::create_analyzer(
-    const std::string& name,
-    const ConnectionKey& key) const {
+AnalyzerRegistry::create_analyzer(const std::string& name) const {
     
     auto it = analyzers_.find(name);
     if (it == analyzers_.end()) {
         return nullptr;
     }
     
-    return it->second.creator(key);
+    return it->second.creator();
 }
 
 std::vector<std::string> 
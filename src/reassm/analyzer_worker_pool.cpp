@@ -0,0 +1,149 @@
+#include "reassm/analyzer_worker_pool.hpp"
+#include "reassm/protocol_handler.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+AnalyzerWorkerPool& AnalyzerWorkerPool::get_instance() {
+    static AnalyzerWorkerPool instance;
+    return instance;
+}
+
+AnalyzerWorkerPool::~AnalyzerWorkerPool() {
+    stop();
+}
+
+void AnalyzerWorkerPool::start(size_t workers) {
+    if (workers == 0 || !workers_.empty()) {
+        return;
+    }
+
+    size_t buffer_count = workers * BUFFERS_PER_WORKER;
+    storage_ = std::make_unique<AnalyzerBuffer[]>(buffer_count);
+    free_buffers_.reserve(buffer_count);
+    for (size_t i = 0; i < buffer_count; ++i) {
+        free_buffers_.push_back(&storage_[i]);
+    }
+
+    running_ = true;
+    for (size_t i = 0; i < workers; ++i) {
+        // Any buffer may come back through any worker
+        workers_.push_back(std::make_unique<Worker>(buffer_count));
+    }
+    for (auto& worker : workers_) {
+        worker->thread = std::thread(&AnalyzerWorkerPool::worker_loop, this, std::ref(*worker));
+    }
+}
+
+void AnalyzerWorkerPool::stop() {
+    running_ = false;
+    for (auto& worker : workers_) {
+        if (worker->thread.joinable()) {
+            worker->thread.join();
+        }
+    }
+}
+
+bool AnalyzerWorkerPool::post_data(size_t worker, ProtocolHandler* handler, Direction dir,
+    const uint8_t* data, size_t len) {
+    if (!running_.load(std::memory_order_relaxed)) {
+        return false;
+    }
+    Worker& target = *workers_[worker];
+    size_t chunks = (len + AnalyzerBuffer::SIZE - 1) / AnalyzerBuffer::SIZE;
+    if (free_buffers_.size() < chunks) {
+        reclaim_buffers();
+    }
+    if (free_buffers_.size() < chunks || target.tasks.capacity() - target.tasks.size() < chunks) {
+        chunks_dropped_.fetch_add(chunks, std::memory_order_relaxed);
+        return false;
+    }
+
+    for (size_t offset = 0; offset < len; offset += AnalyzerBuffer::SIZE) {
+        AnalyzerTask task;
+        task.handler = handler;
+        task.buffer = free_buffers_.back();
+        task.len = static_cast<uint16_t>(std::min(AnalyzerBuffer::SIZE, len - offset));
+        task.type = AnalyzerTask::Type::DATA;
+        task.dir = dir;
+        task.time = PacketClock::now();
+        std::memcpy(task.buffer->data, data + offset, task.len);
+        free_buffers_.pop_back();
+
+        handler->pending_.fetch_add(1, std::memory_order_relaxed);
+        target.tasks.try_push(task);  // Space checked above, only this thread pushes
+    }
+    tasks_posted_.fetch_add(chunks, std::memory_order_relaxed);
+    return true;
+}
+
+bool AnalyzerWorkerPool::post_event(size_t worker, ProtocolHandler* handler, AnalyzerTask::Type type) {
+    if (!running_.load(std::memory_order_relaxed)) {
+        return false;
+    }
+    AnalyzerTask task;
+    task.handler = handler;
+    task.type = type;
+    task.time = PacketClock::now();
+
+    handler->pending_.fetch_add(1, std::memory_order_relaxed);
+    if (!workers_[worker]->tasks.try_push(task)) {
+        handler->pending_.fetch_sub(1, std::memory_order_relaxed);
+        chunks_dropped_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    tasks_posted_.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+size_t AnalyzerWorkerPool::reclaim_buffers() {
+    size_t reclaimed = 0;
+    AnalyzerBuffer* buffer = nullptr;
+    for (auto& worker : workers_) {
+        while (worker->returned.try_pop(buffer)) {
+            free_buffers_.push_back(buffer);
+            ++reclaimed;
+        }
+    }
+    return reclaimed;
+}
+
+void AnalyzerWorkerPool::worker_loop(Worker& worker) {
+    AnalyzerTask task;
+    size_t idle_rounds = 0;
+    while (true) {
+        if (worker.tasks.try_pop(task)) {
+            idle_rounds = 0;
+            ProtocolHandler* handler = task.handler;
+            PacketClock::set(task.time);
+            handler->run_task(task);
+            if (task.buffer) {
+                // Sized for every buffer in the pool, cannot fail
+                worker.returned.try_push(task.buffer);
+            }
+            // Last touch of the handler; its owner may now destroy it
+            handler->pending_.fetch_sub(1, std::memory_order_release);
+            continue;
+        }
+
+        // Queue drained; exit only once no more work can arrive
+        if (!running_.load(std::memory_order_acquire)) {
+            break;
+        }
+        if (++idle_rounds < 64) {
+            std::this_thread::yield();
+        } else {
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+        }
+    }
+}
+
+void AnalyzerWorkerPool::report(std::ostream& os) const {
+    if (workers_.empty()) {
+        return;
+    }
+    os << "Analyzer workers " << workers_.size()
+       << " tasks=" << tasks_posted_.load(std::memory_order_relaxed)
+       << " dropped=" << chunks_dropped_.load(std::memory_order_relaxed)
+       << " degraded_connections=" << degraded_connections_.load(std::memory_order_relaxed) << "\n";
+}
@@ -0,0 +1,164 @@
+#include "reassm/port_policy.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+
+namespace {
+
+std::vector<std::string> split(const std::string& text, char separator) {
+    std::vector<std::string> parts;
+    std::stringstream ss(text);
+    std::string part;
+    while (std::getline(ss, part, separator)) {
+        if (!part.empty()) {
+            parts.push_back(part);
+        }
+    }
+    return parts;
+}
+
+} // namespace
+
+PortPolicy::PortPolicy()
+    : table_(PORT_COUNT, 0), explicit_ports_(PORT_COUNT, false), lists_(1), names_(1) {
+}
+
+void PortPolicy::assign_all(const std::vector<std::string>& analyzer_names) {
+    uint8_t index = 0;
+    if (intern(analyzer_names, index)) {
+        std::fill(table_.begin(), table_.end(), index);
+    }
+}
+
+bool PortPolicy::parse(const std::string& spec) {
+    std::vector<std::string> entries = split(spec, ';');
+
+    // Wildcard entries first so explicit ports override them
+    for (int pass = 0; pass < 2; ++pass) {
+        for (const auto& item : entries) {
+            size_t colon = item.find(':');
+            if (colon == std::string::npos) {
+                std::cerr << "Error: port policy entry '" << item << "' lacks ':'" << std::endl;
+                return false;
+            }
+
+            std::vector<std::pair<uint16_t, uint16_t>> ranges;
+            bool wildcard = false;
+            if (!parse_ports(item.substr(0, colon), ranges, wildcard)) {
+                std::cerr << "Error: bad port list in port policy entry '" << item << "'" << std::endl;
+                return false;
+            }
+            if (wildcard != (pass == 0)) {
+                continue;
+            }
+
+            std::vector<std::string> analyzer_names = split(item.substr(colon + 1), ',');
+            uint8_t index = 0;
+            if (!intern(analyzer_names, index)) {
+                return false;
+            }
+
+            if (wildcard) {
+                std::fill(table_.begin(), table_.end(), index);
+            }
+            for (const auto& [first, last] : ranges) {
+                std::fill(table_.begin() + first, table_.begin() + last + 1, index);
+                std::fill(explicit_ports_.begin() + first, explicit_ports_.begin() + last + 1, true);
+            }
+        }
+    }
+    return true;
+}
+
+std::string PortPolicy::describe() const {
+    std::ostringstream oss;
+    size_t port = 0;
+    while (port < PORT_COUNT) {
+        size_t end = port;
+        while (end + 1 < PORT_COUNT && table_[end + 1] == table_[port]) {
+            ++end;
+        }
+        if (table_[port] != 0) {
+            oss << port;
+            if (end != port) {
+                oss << "-" << end;
+            }
+            oss << ":" << names_[table_[port]] << std::endl;
+        }
+        port = end + 1;
+    }
+    return oss.str();
+}
+
+bool PortPolicy::intern(const std::vector<std::string>& analyzer_names, uint8_t& index) {
+    FactoryList factories = AnalyzerRegistry::get_instance().get_factories(analyzer_names);
+    if (factories.size() != analyzer_names.size()) {
+        std::cerr << "Warning: Unknown analyzer type in port policy" << std::endl;
+    }
+
+    std::string joined;
+    for (const auto& factory : factories) {
+        joined += (joined.empty() ? "" : ",") + factory.name;
+    }
+    if (joined.empty()) {
+        index = 0;
+        return true;
+    }
+
+    for (size_t i = 1; i < names_.size(); ++i) {
+        if (names_[i] == joined) {
+            index = static_cast<uint8_t>(i);
+            return true;
+        }
+    }
+    if (lists_.size() == MAX_LISTS) {
+        std::cerr << "Error: port policy has more than " << MAX_LISTS - 1 << " analyzer sets" << std::endl;
+        return false;
+    }
+
+    lists_.push_back(std::move(factories));
+    names_.push_back(joined);
+    index = static_cast<uint8_t>(lists_.size() - 1);
+    return true;
+}
+
+bool PortPolicy::parse_ports(const std::string& ports, std::vector<std::pair<uint16_t, uint16_t>>& ranges, bool& wildcard) {
+    std::vector<std::string> items = split(ports, ',');
+    if (items.empty()) {
+        return false;
+    }
+
+    for (const auto& item : items) {
+        if (item == "*") {
+            wildcard = true;
+            continue;
+        }
+        size_t dash = item.find('-');
+        uint16_t first = 0;
+        uint16_t last = 0;
+        if (!parse_port(item.substr(0, dash), first)) {
+            return false;
+        }
+        last = first;
+        if (dash != std::string::npos && (!parse_port(item.substr(dash + 1), last) || last < first)) {
+            return false;
+        }
+        ranges.emplace_back(first, last);
+    }
+    // '*' stands alone
+    return !wildcard || ranges.empty();
+}
+
+bool PortPolicy::parse_port(const std::string& text, uint16_t& port) {
+    if (text.empty()) {
+        return false;
+    }
+    char* end = nullptr;
+    unsigned long value = std::strtoul(text.c_str(), &end, 10);
+    if (*end != '\0' || value > 65535) {
+        return false;
+    }
+    port = static_cast<uint16_t>(value);
+    return true;
+}
@@ -1,32 +1,283 @@
 #include "reassm/protocol_handler.hpp"
+#include "misc/metrics_registry.hpp"
+#include <cstring>
 #include <iostream>
 #include <iomanip>
+#include <thread>
+
+ProtocolHandler::~ProtocolHandler() {
+    wait_for_worker();
+}
+
+void ProtocolHandler::wait_for_worker() const {
+    while (pending_.load(std::memory_order_acquire) != 0) {
+        std::this_thread::yield();
+    }
+}
+
+void ProtocolHandler::AnalyzerSlot::feed(Direction dir, const uint8_t* data, size_t len) {
+    gates[static_cast<size_t>(dir)].feed(data, len, [&](const uint8_t* d, size_t n) {
+        return analyzer->on_data(dir, d, n);
+    });
+}
 
 void ProtocolHandler::add_analyzer(std::shared_ptr<IProtocolAnalyzer> analyzer) {
-    analyzers_.push_back(std::move(analyzer));
+    analyzer->on_open(info_);
+    analyzers_.push_back(AnalyzerSlot{std::move(analyzer), {}});
+    idle_.store(false, std::memory_order_relaxed);
+}
+
+void ProtocolHandler::add_candidate(const AnalyzerRegistry::AnalyzerFactory& factory) {
+    if (!factory.probe || info_.mid_stream) {
+        attach(factory, false);
+    } else {
+        candidates_.push_back(&factory);
+    }
+    idle_.store(compute_idle(), std::memory_order_relaxed);
+}
+
+template <typename Feed>
+void ProtocolHandler::replay_probed(Feed feed) const {
+    size_t total = probe_len_[0] + probe_len_[1];
+    std::array<size_t, 2> offset{};
+    for (size_t i = 0; i < total;) {
+        // A run of bytes from one direction
+        size_t side = (probe_order_ >> i) & 1;
+        size_t run = 1;
+        while (i + run < total && ((probe_order_ >> (i + run)) & 1) == side) {
+            ++run;
+        }
+        feed(static_cast<Direction>(side), probe_buffer_[side].data() + offset[side], run);
+        offset[side] += run;
+        i += run;
+    }
+}
+
+void ProtocolHandler::attach(const AnalyzerRegistry::AnalyzerFactory& factory, bool replay) {
+#ifdef TCP_TRACKER_STATIC_ANALYZERS
+    if (factory.static_slot >= 0) {
+        // Most connections never attach one, so the pipeline is only
+        // allocated for those that do
+        if (!static_analyzers_) {
+            static_analyzers_ = std::make_unique<StaticAnalyzers>();
+        }
+        if (static_analyzers_->emplace(factory.static_slot, info_)) {
+            if (replay) {
+                replay_probed([&](Direction dir, const uint8_t* data, size_t len) {
+                    static_analyzers_->on_data(factory.static_slot, dir, data, len);
+                });
+            }
+            return;
+        }
+    }
+#endif
+    if (auto analyzer = factory.creator()) {
+        add_analyzer(std::move(analyzer));
+        if (replay) {
+            replay_probed([this](Direction dir, const uint8_t* data, size_t len) {
+                analyzers_.back().feed(dir, data, len);
+            });
+        }
+    }
 }
 
 void ProtocolHandler::remove_analyzer(const std::shared_ptr<IProtocolAnalyzer>& analyzer) {
     analyzers_.erase(
-        std::remove(analyzers_.begin(), analyzers_.end(), analyzer),
+        std::remove_if(analyzers_.begin(), analyzers_.end(),
+            [&analyzer](const AnalyzerSlot& slot) { return slot.analyzer == analyzer; }),
         analyzers_.end()
     );
 }
 
 void ProtocolHandler::notify_data(Direction dir, const uint8_t* data, size_t len) {
-    for (const auto& analyzer : analyzers_) {
-        analyzer->on_data(dir, data, len);
+    if (worker_ < 0) {
+        deliver_data(dir, data, len);
+    } else if (!degraded_ &&
+               !AnalyzerWorkerPool::get_instance().post_data(worker_, this, dir, data, len)) {
+        degrade();
     }
 }
 
 void ProtocolHandler::notify_reset() {
-    for (const auto& analyzer : analyzers_) {
-        analyzer->on_connection_reset();
+    if (worker_ < 0) {
+        deliver_reset();
+    } else if (!degraded_ &&
+               !AnalyzerWorkerPool::get_instance().post_event(worker_, this, AnalyzerTask::Type::RESET)) {
+        degrade();
     }
 }
 
 void ProtocolHandler::notify_closed() {
-    for (const auto& analyzer : analyzers_) {
-        analyzer->on_connection_closed();
+    if (worker_ < 0) {
+        deliver_closed();
+    } else if (!degraded_ &&
+               !AnalyzerWorkerPool::get_instance().post_event(worker_, this, AnalyzerTask::Type::CLOSED)) {
+        degrade();
+    }
+}
+
+void ProtocolHandler::notify_close() {
+    // The worker queues are fed by the capture thread only, so the last
+    // call is made here instead of being posted
+    wait_for_worker();
+#ifdef TCP_TRACKER_STATIC_ANALYZERS
+    if (static_analyzers_) {
+        static_analyzers_->on_close(summary_);
+    }
+#endif
+    for (const auto& slot : analyzers_) {
+        slot.analyzer->on_close(summary_);
+    }
+}
+
+void ProtocolHandler::describe(std::ostream& os) const {
+    wait_for_worker();
+    os << "analyzers: " << analyzers_.size() << " attached, " << candidates_.size() << " probing"
+       << (worker_ < 0 ? std::string(", inline") : ", worker " + std::to_string(worker_))
+       << (degraded_ ? ", degraded" : "") << (compute_idle() ? ", idle" : "") << "\n";
+    for (const auto* candidate : candidates_) {
+        os << "probing: " << candidate->name << "\n";
+    }
+#ifdef TCP_TRACKER_STATIC_ANALYZERS
+    if (static_analyzers_) {
+        static_analyzers_->describe(os);
+    }
+#endif
+    for (const auto& slot : analyzers_) {
+        slot.analyzer->describe(os);
+    }
+}
+
+bool ProtocolHandler::compact(CompactSummary& summary) {
+    // Queued tasks still reference the analyzers; a degraded handler no
+    // longer feeds them, whatever they report
+    if (pending_.load(std::memory_order_acquire) != 0 || (!degraded_ && !compute_idle())) {
+        return false;
+    }
+
+#ifdef TCP_TRACKER_STATIC_ANALYZERS
+    if (static_analyzers_) {
+        static_analyzers_->summarize(summary);
+        static_analyzers_->on_close(summary_);
+        static_analyzers_.reset();
+    }
+#endif
+    for (const auto& slot : analyzers_) {
+        slot.analyzer->summarize(summary);
+        slot.analyzer->on_close(summary_);
+    }
+    // Give the memory back rather than keeping the capacity
+    std::vector<AnalyzerSlot>().swap(analyzers_);
+    std::vector<const AnalyzerRegistry::AnalyzerFactory*>().swap(candidates_);
+    idle_.store(true, std::memory_order_relaxed);
+    return true;
+}
+
+void ProtocolHandler::degrade() {
+    degraded_ = true;
+    AnalyzerWorkerPool::get_instance().record_degraded();
+}
+
+void ProtocolHandler::run_task(const AnalyzerTask& task) {
+    switch (task.type) {
+        case AnalyzerTask::Type::DATA:
+            deliver_data(task.dir, task.buffer->data, task.len);
+            break;
+        case AnalyzerTask::Type::RESET:
+            deliver_reset();
+            break;
+        case AnalyzerTask::Type::CLOSED:
+            deliver_closed();
+            break;
+    }
+    idle_.store(compute_idle(), std::memory_order_release);
+}
+
+void ProtocolHandler::deliver_data(Direction dir, const uint8_t* data, size_t len) {
+    StageTimer timer(MetricStage::ANALYZER);
+    if (!candidates_.empty()) {
+        probe(dir, data, len);
+    }
+
+#ifdef TCP_TRACKER_STATIC_ANALYZERS
+    if (static_analyzers_) {
+        static_analyzers_->on_data(dir, data, len);
+    }
+#endif
+    for (auto& slot : analyzers_) {
+        if (!slot.is_finished()) {
+            slot.feed(dir, data, len);
+        }
+    }
+}
+
+void ProtocolHandler::probe(Direction dir, const uint8_t* data, size_t len) {
+    auto& buffer = probe_buffer_[static_cast<size_t>(dir)];
+    size_t buffered = probe_len_[static_cast<size_t>(dir)];
+    size_t copy = std::min(len, PROBE_BYTES - buffered);
+    std::memcpy(buffer.data() + buffered, data, copy);
+
+    for (auto it = candidates_.begin(); it != candidates_.end();) {
+        ProbeResult result = (*it)->probe(dir, buffer.data(), buffered + copy);
+        // A probe undecided after PROBE_BYTES never matches
+        if (result == ProbeResult::NEED_MORE && buffered + copy < PROBE_BYTES) {
+            ++it;
+            continue;
+        }
+
+        if (result == ProbeResult::MATCH) {
+            // Replay the earlier bytes of both directions, so a side that
+            // spoke first is not lost; the caller delivers the rest
+            attach(**it, true);
+        }
+        it = candidates_.erase(it);
+    }
+
+    // Counted only now, as they are not part of a replay
+    if (dir == Direction::SERVER_TO_CLIENT && copy > 0) {
+        probe_order_ |= ((uint32_t{1} << copy) - 1) << (probe_len_[0] + probe_len_[1]);
+    }
+    probe_len_[static_cast<size_t>(dir)] += copy;
+}
+
+void ProtocolHandler::deliver_reset() {
+#ifdef TCP_TRACKER_STATIC_ANALYZERS
+    if (static_analyzers_) {
+        static_analyzers_->on_connection_reset();
+    }
+#endif
+    for (const auto& slot : analyzers_) {
+        slot.analyzer->on_connection_reset();
+    }
+}
+
+void ProtocolHandler::deliver_closed() {
+#ifdef TCP_TRACKER_STATIC_ANALYZERS
+    if (static_analyzers_) {
+        static_analyzers_->on_connection_closed();
+    }
+#endif
+    for (const auto& slot : analyzers_) {
+        slot.analyzer->on_connection_closed();
+    }
+}
+
+bool ProtocolHandler::is_idle() const {
+    if (worker_ < 0) {
+        return compute_idle();
+    }
+    return degraded_ || idle_.load(std::memory_order_acquire);
+}
+
+bool ProtocolHandler::compute_idle() const {
+    if (!candidates_.empty()) {
+        return false;
+    }
+#ifdef TCP_TRACKER_STATIC_ANALYZERS
+    if (static_analyzers_ && !static_analyzers_->is_finished()) {
+        return false;
     }
+#endif
+    return std::all_of(analyzers_.begin(), analyzers_.end(),
+        [](const AnalyzerSlot& slot) { return slot.is_finished(); });
 }
@@ -1,26 +1,61 @@
 #include "reassm/reassembly.hpp"
 #include "conn/connection_key.hpp"
 #include "log/reassembly_log_entry.hpp"
+#include "misc/metrics_registry.hpp"
 #include <algorithm>
 #include <vector>
 
-Reassembly::Reassembly(const ConnectionKey& key, Direction dir)
+Reassembly::Reassembly(const ConnectionKey& key, Direction dir, ProtocolHandler& protocol_handler)
     : key_(key),
       direction_(dir),
+      protocol_handler_(protocol_handler),
       next_seq_(0),
       initial_seq_set_(false),
       fin_received_(false)
 {}
 
 Reassembly::~Reassembly() {
+    clear_buffered();
     reassm_log_.flush(); // Ensure logs are written on destruction
 }
 
 void Reassembly::log_event(ReassmEvent type, uint32_t seq, size_t len) {
+    if (!reassm_log_.is_enabled()) {
+        return;  // Skip building entries nobody writes
+    }
     reassm_log_.log(std::make_shared<ReassemblyLogEntry>(
         key_, direction_, type, seq, len, next_seq_));
 }
 
+void Reassembly::track_buffered(int64_t bytes, int64_t segments) {
+    buffered_bytes_ += bytes;
+    auto& metrics = MetricsRegistry::get_instance();
+    metrics.add(MetricGauge::REASSEMBLY_BUFFERED_BYTES, bytes);
+    metrics.add(MetricGauge::REASSEMBLY_BUFFERED_SEGMENTS, segments);
+}
+
+void Reassembly::clear_buffered() {
+    if (!out_of_order_segments_.empty()) {
+        track_buffered(-static_cast<int64_t>(buffered_bytes_),
+                       -static_cast<int64_t>(out_of_order_segments_.size()));
+        out_of_order_segments_.clear();
+    }
+}
+
+void Reassembly::describe(std::ostream& os) const {
+    os << "reassembly " << (direction_ == Direction::CLIENT_TO_SERVER ? "cli->srv" : "srv->cli") << ": ";
+    if (!initial_seq_set_) {
+        os << "not initialized";
+    } else {
+        os << "next seq " << next_seq_;
+    }
+    os << ", buffered " << out_of_order_segments_.size() << " segments " << buffered_bytes_ << " bytes";
+    if (!out_of_order_segments_.empty()) {
+        os << " from seq " << out_of_order_segments_.begin()->first;
+    }
+    os << (fin_received_ ? ", fin" : "") << "\n";
+}
+
 void Reassembly::set_initial_seq(uint32_t isn) {
     if (!initial_seq_set_) {
         next_seq_ = isn;
@@ -37,7 +72,7 @@ void Reassembly::reset() {
         protocol_handler_.notify_reset();
     }
 
-    out_of_order_segments_.clear();
+    clear_buffered();
     next_seq_ = 0;
     initial_seq_set_ = false;
     fin_received_ = false;
@@ -54,9 +89,17 @@ void Reassembly::fin_received() {
 }
 
 void Reassembly::process(uint32_t seq, const uint8_t* payload, size_t payload_len, bool syn_flag, bool fin_flag) {
+    StageTimer timer(MetricStage::REASSEMBLY);
 
     log_event(ReassmEvent::SEGMENT_RECEIVED, seq, payload_len);
 
+    // No analyzer wants the payload: header-only tracking
+    if (protocol_handler_.is_idle()) {
+        clear_buffered();
+        log_event(ReassmEvent::DATA_IGNORED_IDLE, seq, payload_len);
+        return;
+    }
+
     if (!initial_seq_set_) {
         log_event(ReassmEvent::DATA_IGNORED_INIT, seq, payload_len);
         return; // Cannot process data if sequence isn't initialized
@@ -119,8 +162,13 @@ void Reassembly::process(uint32_t seq, const uint8_t* payload, size_t payload_le
          // Simple buffering: Overwrite if segment with same start SEQ exists.
          // TODO: Add logic here to avoid buffering segments that overlap existing buffer entries partially.
          // For now, simple insert/assign:
+        auto existing = out_of_order_segments_.find(seq);
+        int64_t replaced = existing != out_of_order_segments_.end() ? existing->second.size() : 0;
         out_of_order_segments_.insert_or_assign(seq,
             std::vector<uint8_t>(current_payload, current_payload + current_payload_len));
+        track_buffered(static_cast<int64_t>(current_payload_len) - replaced,
+                       existing != out_of_order_segments_.end() ? 0 : 1);
+        MetricsRegistry::get_instance().add(MetricCounter::SEGMENTS_OUT_OF_ORDER);
     }
     // Else: Segment has zero payload length (pure ACK or FIN handled below)
 
@@ -160,6 +208,7 @@ void Reassembly::deliver_contiguous() {
                                     segment_data.size());
 
         next_seq_ += static_cast<uint32_t>(segment_data.size());
+        track_buffered(-static_cast<int64_t>(segment_data.size()), -1);
 
         // Remove the delivered segment and advance iterator safely
         it = out_of_order_segments_.erase(it);
@@ -4,15 +4,16 @@
 #include <iomanip>
 #include <sstream>
 
-ReassmAnalyzer::ReassmAnalyzer(const ConnectionKey& key)
-    : key_(key) {
-}
-
 ReassmAnalyzer::~ReassmAnalyzer() {
     reassm_analyzer_log_.flush();
 }
 
-void ReassmAnalyzer::on_data(Direction dir, const uint8_t* data, size_t len) {
+ParseHint ReassmAnalyzer::on_data(Direction dir, const uint8_t* data, size_t len) {
+    // Nothing to dump into
+    if (!reassm_analyzer_log_.is_enabled()) {
+        return ParseHint::done();
+    }
+
     std::stringstream ss;
     
     // Log basic info
@@ -41,13 +42,14 @@ void ReassmAnalyzer::on_data(Direction dir, const uint8_t* data, size_t len) {
     ss << std::endl;
 
     // Log the formatted output
-    reassm_analyzer_log_.log(std::make_shared<ConnLogEntry>(key_, ss.str()));
+    reassm_analyzer_log_.log(std::make_shared<ConnLogEntry>(*info_->key, ss.str()));
+    return ParseHint::more();
 }
 
 void ReassmAnalyzer::on_connection_reset() {
-    reassm_analyzer_log_.log(std::make_shared<ConnLogEntry>(key_, "Connection Reset"));
+    reassm_analyzer_log_.log(std::make_shared<ConnLogEntry>(*info_->key, "Connection Reset"));
 }
 
 void ReassmAnalyzer::on_connection_closed() {
-    reassm_analyzer_log_.log(std::make_shared<ConnLogEntry>(key_, "Connection Closed"));
+    reassm_analyzer_log_.log(std::make_shared<ConnLogEntry>(*info_->key, "Connection Closed"));
 }
@@ -0,0 +1,38 @@
+#include "tls/alert_counters.hpp"
+#include <string>
+
+AlertCounters& AlertCounters::get_instance() {
+    static AlertCounters instance;
+    return instance;
+}
+
+void AlertCounters::record(uint16_t server_port, const TLSAlert& alert) {
+    PortCounters& counters = ports_.get(server_port);
+    size_t index = alert.opaque ? OPAQUE : static_cast<size_t>(alert.description);
+    counters.by_description[index].fetch_add(1, std::memory_order_relaxed);
+    if (!alert.opaque && alert.level == TLSAlertLevel::FATAL) {
+        counters.fatal.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void AlertCounters::report(std::ostream& os) const {
+    for_each_port([&os](uint16_t port, const PortCounters& counters) {
+        std::string line;
+        for (size_t i = 0; i <= OPAQUE; ++i) {
+            uint64_t count = counters.by_description[i].load(std::memory_order_relaxed);
+            if (count == 0) {
+                continue;
+            }
+            std::string name = i == OPAQUE ? "opaque" : get_alert_description(static_cast<uint8_t>(i));
+            if (name == "unknown") {
+                name += "_" + std::to_string(i);
+            }
+            line += " " + name + "=" + std::to_string(count);
+        }
+        if (line.empty()) {
+            return;
+        }
+        os << "TLS alerts port " << (port ? std::to_string(port) : std::string("other"))
+           << " fatal=" << counters.fatal.load(std::memory_order_relaxed) << line << "\n";
+    });
+}
@@ -0,0 +1,67 @@
+#include "tls/certificate_cache.hpp"
+
+CertificateCache& CertificateCache::get_instance() {
+    static CertificateCache instance;
+    return instance;
+}
+
+std::shared_ptr<const CertificateEntry> CertificateCache::lookup(const uint8_t* der, size_t len, bool& hit) {
+    Sha256::Digest digest = Sha256::digest(der, len);
+    Shard& shard = shard_for(digest);
+
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.index.find(digest);
+        if (it != shard.index.end()) {
+            shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+            hits_.fetch_add(1, std::memory_order_relaxed);
+            hit = true;
+            return *it->second;
+        }
+    }
+
+    // Parse outside the shard lock; a racing miss on the same digest just
+    // replaces the entry with an identical one
+    auto entry = std::make_shared<CertificateEntry>();
+    entry->digest = digest;
+    entry->der_len = len;
+    entry->parsed = X509Parser::parse(der, len, entry->info);
+    misses_.fetch_add(1, std::memory_order_relaxed);
+    hit = false;
+
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.index.find(digest);
+    if (it != shard.index.end()) {
+        shard.lru.erase(it->second);
+        shard.index.erase(it);
+    }
+    shard.lru.push_front(entry);
+    shard.index.emplace(digest, shard.lru.begin());
+
+    size_t capacity = shard_capacity_.load(std::memory_order_relaxed);
+    while (shard.lru.size() > capacity) {
+        shard.index.erase(shard.lru.back()->digest);
+        shard.lru.pop_back();
+    }
+    return entry;
+}
+
+void CertificateCache::set_capacity(size_t capacity) {
+    size_t per_shard = (capacity + SHARD_COUNT - 1) / SHARD_COUNT;
+    shard_capacity_.store(per_shard > 0 ? per_shard : 1, std::memory_order_relaxed);
+}
+
+std::vector<std::shared_ptr<const CertificateEntry>> CertificateCache::snapshot() const {
+    std::vector<std::shared_ptr<const CertificateEntry>> entries;
+    for (const auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        entries.insert(entries.end(), shard.lru.begin(), shard.lru.end());
+    }
+    return entries;
+}
+
+double CertificateCache::get_hit_ratio() const {
+    uint64_t hits = get_hits();
+    uint64_t total = hits + get_misses();
+    return total ? static_cast<double>(hits) / total : 0.0;
+}
@@ -0,0 +1,32 @@
+#include "tls/handshake_metrics.hpp"
+
+HandshakeMetrics& HandshakeMetrics::get_instance() {
+    static HandshakeMetrics instance;
+    return instance;
+}
+
+void HandshakeMetrics::record(uint16_t server_port, TLSHandshakeKind kind,
+    PacketClock::duration handshake_rtt, PacketClock::duration server_think_time) {
+    PortMetrics& metrics = ports_.get(server_port);
+    metrics.handshakes[static_cast<size_t>(kind)].fetch_add(1, std::memory_order_relaxed);
+    // Capture timestamps can step backwards; clamp instead of wrapping
+    metrics.handshake_rtt.record(handshake_rtt.count() > 0 ? handshake_rtt.count() : 0);
+    metrics.server_think_time.record(server_think_time.count() > 0 ? server_think_time.count() : 0);
+}
+
+void HandshakeMetrics::report(std::ostream& os) const {
+    for_each_port([&os](uint16_t port, const PortMetrics& metrics) {
+        if (metrics.handshake_rtt.count() == 0) {
+            return;
+        }
+        os << "TLS handshakes port " << (port ? std::to_string(port) : std::string("other"));
+        for (size_t i = 0; i < static_cast<size_t>(TLSHandshakeKind::COUNT); ++i) {
+            os << " " << get_handshake_kind_name(static_cast<TLSHandshakeKind>(i)) << "="
+               << metrics.handshakes[i].load(std::memory_order_relaxed);
+        }
+        os << " rtt_us p50=" << metrics.handshake_rtt.percentile(0.5)
+           << " p99=" << metrics.handshake_rtt.percentile(0.99)
+           << " think_us p50=" << metrics.server_think_time.percentile(0.5)
+           << " p99=" << metrics.server_think_time.percentile(0.99) << "\n";
+    });
+}
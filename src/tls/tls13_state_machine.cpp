@@ -0,0 +1,152 @@
+#include "tls/tls13_state_machine.hpp"
+#include "tls/tls_event_sink.hpp"
+#include <sstream>
+
+template <typename Sink>
+TLS13StateMachine<Sink>::TLS13StateMachine(Sink sink)
+    : state_(TLS13State::INIT), sink_(std::move(sink)) {
+}
+
+template <typename Sink>
+bool TLS13StateMachine<Sink>::process_handshake(Direction dir, TLSHandshakeType msg_type) {
+    if constexpr (Sink::enabled) {
+        std::ostringstream oss;
+        oss << "Processing TLS 1.3 handshake: " << static_cast<int>(msg_type)
+            << " (" << get_tls_handshake_type_name(msg_type) << ")";
+        sink_(oss.str());
+    }
+
+    switch (state_) {
+        case TLS13State::INIT:
+        case TLS13State::HELLO_RETRY_REQUEST_RECEIVED:
+            // Initial ClientHello, or the second one answering a HelloRetryRequest
+            if (dir == Direction::CLIENT_TO_SERVER && msg_type == TLSHandshakeType::CLIENT_HELLO) {
+                update_state(TLS13State::CLIENT_HELLO_SENT);
+                return true;
+            }
+            break;
+
+        case TLS13State::CLIENT_HELLO_SENT:
+            if (dir == Direction::SERVER_TO_CLIENT && msg_type == TLSHandshakeType::SERVER_HELLO) {
+                update_state(TLS13State::SERVER_HELLO_RECEIVED);
+                return true;
+            }
+            break;
+
+        default:
+            break;
+    }
+
+    return fail("Invalid state transition on handshake message");
+}
+
+template <typename Sink>
+bool TLS13StateMachine<Sink>::process_hello_retry_request(Direction dir) {
+    if constexpr (Sink::enabled) {
+        sink_("Processing HelloRetryRequest");
+    }
+
+    // At most one HelloRetryRequest per handshake (RFC 8446 Section 4.1.4)
+    if (state_ == TLS13State::CLIENT_HELLO_SENT && dir == Direction::SERVER_TO_CLIENT && !hello_retried_) {
+        hello_retried_ = true;
+        update_state(TLS13State::HELLO_RETRY_REQUEST_RECEIVED);
+        return true;
+    }
+
+    return fail("Unexpected HelloRetryRequest");
+}
+
+template <typename Sink>
+bool TLS13StateMachine<Sink>::process_change_cipher_spec(Direction dir) {
+    // Dummy record sent for middlebox compatibility, carries no state
+    if constexpr (Sink::enabled) {
+        sink_(std::string("Ignoring compatibility ChangeCipherSpec from ") +
+            (dir == Direction::CLIENT_TO_SERVER ? "client" : "server"));
+    }
+    return state_ != TLS13State::ERROR;
+}
+
+template <typename Sink>
+bool TLS13StateMachine<Sink>::process_encrypted_record(Direction dir, size_t len) {
+    switch (state_) {
+        case TLS13State::CLIENT_HELLO_SENT:
+        case TLS13State::SERVER_HELLO_RECEIVED:
+            if (dir == Direction::CLIENT_TO_SERVER) {
+                // 0-RTT early data may precede the server flight
+                if constexpr (Sink::enabled) {
+                    sink_("Encrypted early data from client");
+                }
+                return true;
+            }
+            if (state_ == TLS13State::SERVER_HELLO_RECEIVED) {
+                update_state(TLS13State::SERVER_FLIGHT_RECEIVED);
+                return true;
+            }
+            break;
+
+        case TLS13State::SERVER_FLIGHT_RECEIVED:
+            if (dir == Direction::CLIENT_TO_SERVER) {
+                // 0-RTT records and EndOfEarlyData keep coming until the
+                // client has the whole server flight and sends its Finished
+                if (early_data_ && len != finished_len_) {
+                    if constexpr (Sink::enabled) {
+                        sink_("Encrypted early data from client");
+                    }
+                    return true;
+                }
+                // Otherwise the first client record under handshake keys holds its Finished
+                update_state(TLS13State::HANDSHAKE_COMPLETE);
+            }
+            // Further server records continue Certificate..Finished
+            return true;
+
+        case TLS13State::HANDSHAKE_COMPLETE:
+            return true;
+
+        default:
+            break;
+    }
+
+    return fail("Unexpected encrypted record");
+}
+
+template <typename Sink>
+bool TLS13StateMachine<Sink>::process_alert(Direction dir) {
+    return fail(dir == Direction::CLIENT_TO_SERVER ? "Client alert" : "Server alert");
+}
+
+template <typename Sink>
+void TLS13StateMachine<Sink>::reset() {
+    state_ = TLS13State::INIT;
+    hello_retried_ = false;
+    early_data_ = false;
+    finished_len_ = 0;
+    if constexpr (Sink::enabled) {
+        sink_("TLS 1.3 state machine reset to INIT");
+    }
+}
+
+template <typename Sink>
+bool TLS13StateMachine<Sink>::fail(const char* what) {
+    if constexpr (Sink::enabled) {
+        sink_(std::string(what) + " in state: " + get_tls13_state_name(state_));
+    }
+    update_state(TLS13State::ERROR);
+    return false;
+}
+
+template <typename Sink>
+void TLS13StateMachine<Sink>::update_state(TLS13State new_state) {
+    if constexpr (Sink::enabled) {
+        std::ostringstream oss;
+        oss << "TLS 1.3 state transition: " << static_cast<int>(state_)
+            << " (" << get_tls13_state_name(state_) << ")"
+            << " -> " << static_cast<int>(new_state) << " ("
+            << get_tls13_state_name(new_state) << ")";
+        sink_(oss.str());
+    }
+    state_ = new_state;
+}
+
+template class TLS13StateMachine<TLSLogSink>;
+template class TLS13StateMachine<NullTLSSink>;
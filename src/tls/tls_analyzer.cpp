@@ -1,31 +1,66 @@
 #include "tls/tls_analyzer.hpp"
-#include "log/conn_log_entry.hpp"
+#include "log/log_manager.hpp"
+#include "misc/event_bus.hpp"
+#include <algorithm>
 #include <iostream>
 #include <iomanip>
 #include <sstream>
 
-TLSAnalyzer::TLSAnalyzer(const ConnectionKey& key)
-    : key_(key),
-    client_buffer_([this](const std::string& msg) {
-        tls_log_.log(std::make_shared<ConnLogEntry>(key_, msg));
-    }),
-    server_buffer_([this](const std::string& msg) {
-        tls_log_.log(std::make_shared<ConnLogEntry>(key_, msg));
-    }),
-    state_machine_([this](const std::string& msg) {
-        tls_log_.log(std::make_shared<ConnLogEntry>(key_, msg));
-    }) {
+ProbeResult probe_tls(Direction dir, const uint8_t* data, size_t len) {
+    // Record header: handshake, major version 3, minor version up to TLS 1.3
+    if (len >= 1 && data[0] != TLS_CONTENT_TYPE_HANDSHAKE) return ProbeResult::NO_MATCH;
+    if (len >= 2 && data[1] != TLS_MAJOR_VERSION) return ProbeResult::NO_MATCH;
+    if (len >= 3 && data[2] > TLS_MINOR_VERSION_1_3) return ProbeResult::NO_MATCH;
+    if (len < TLS_RECORD_HEADER_LEN + 1) return ProbeResult::NEED_MORE;
+
+    size_t record_len = (data[3] << 8) | data[4];
+    if (record_len == 0 || record_len > TLS_MAX_RECORD_LEN) return ProbeResult::NO_MATCH;
+
+    auto expected = dir == Direction::CLIENT_TO_SERVER ? TLSHandshakeType::CLIENT_HELLO
+                                                       : TLSHandshakeType::SERVER_HELLO;
+    return data[TLS_RECORD_HEADER_LEN] == static_cast<uint8_t>(expected) ? ProbeResult::MATCH
+                                                                         : ProbeResult::NO_MATCH;
 }
 
-TLSAnalyzer::~TLSAnalyzer() {
-    tls_log_.flush();
+template <typename Sink>
+TLSAnalyzer<Sink>::TLSAnalyzer()
+    : state_machine_(sink_),
+    tls13_state_machine_(sink_),
+    client_buffer_(sink_),
+    server_buffer_(sink_) {
 }
 
-void TLSAnalyzer::on_data(Direction dir, const uint8_t* data, size_t len) {
-    std::ostringstream oss;
-    oss << "[TLSAnalyzer] on_data: " << (dir == Direction::CLIENT_TO_SERVER ? "Client->Server" : "Server->Client")
-        << " (" << len << " bytes)";
-    tls_log_.log(std::make_shared<ConnLogEntry>(key_, oss.str()));
+template <typename Sink>
+TLSAnalyzer<Sink>::~TLSAnalyzer() {
+    if constexpr (Sink::enabled) {
+        LogManager::get_instance().get_registered_log("tls.log").flush();
+    }
+}
+
+template <typename Sink>
+void TLSAnalyzer<Sink>::on_open(const ConnInfo& info) {
+    info_ = &info;
+    // Each component logs through its own copy of the sink
+    sink_.bind(*info.key);
+    state_machine_.bind(*info.key);
+    tls13_state_machine_.bind(*info.key);
+    client_buffer_.bind(*info.key);
+    server_buffer_.bind(*info.key);
+    if (info.mid_stream) {
+        mid_stream_ = true;
+        client_buffer_.resync();
+        server_buffer_.resync();
+    }
+}
+
+template <typename Sink>
+ParseHint TLSAnalyzer<Sink>::on_data(Direction dir, const uint8_t* data, size_t len) {
+    if constexpr (Sink::enabled) {
+        std::ostringstream oss;
+        oss << "[TLSAnalyzer] on_data: " << (dir == Direction::CLIENT_TO_SERVER ? "Client->Server" : "Server->Client")
+            << " (" << len << " bytes)";
+        sink_(oss.str());
+    }
 
     // Add data to appropriate buffer
     auto& buffer = (dir == Direction::CLIENT_TO_SERVER) ? 
@@ -35,21 +70,114 @@ void TLSAnalyzer::on_data(Direction dir, const uint8_t* data, size_t len) {
     
     // Process complete records
     TLSContentType type;
-    std::vector<uint8_t> fragment;
-    while (buffer.try_extract_record(type, fragment)) {
-        handle_record(dir, type, fragment);
+    const uint8_t* fragment;
+    size_t fragment_len;
+    while (!lost_track_ && buffer.try_extract_record(type, fragment, fragment_len)) {
+        handle_record(dir, type, fragment, fragment_len);
+    }
+    if (buffer.resync_failed()) {
+        lost_track_ = true;
+    }
+
+    if (!handshake_recorded_ && is_handshake_complete()) {
+        record_handshake();
+    }
+
+    if (is_finished()) {
+        return ParseHint::done();
     }
+    size_t needed = buffer.bytes_needed();
+    return needed > 0 ? ParseHint::need(needed) : ParseHint::more();
 }
 
-void TLSAnalyzer::handle_record(Direction dir, TLSContentType type,
-    const std::vector<uint8_t>& fragment) {
+template <typename Sink>
+void TLSAnalyzer<Sink>::summarize(CompactSummary& summary) const {
+    summary.sni_id = client_hello_.server_name_id;
+    summary.tls_version = negotiated_version_ ? static_cast<uint16_t>(*negotiated_version_) : 0;
+    summary.cipher = cipher_suite_;
+    summary.tls_kind = static_cast<uint8_t>(get_handshake_kind());
+    if (is_handshake_complete()) {
+        summary.flags |= COMPACT_TLS_COMPLETE;
+    } else if (is_handshake_failed()) {
+        summary.flags |= COMPACT_TLS_FAILED;
+    }
+    if (handshake_recorded_ && timestamps_.client_hello != PacketClock::time_point{}) {
+        auto handshake_rtt = timestamps_.finished - timestamps_.client_hello;
+        summary.handshake_us = static_cast<uint32_t>(handshake_rtt.count() > 0 ? handshake_rtt.count() : 0);
+    }
+}
+
+template <typename Sink>
+void TLSAnalyzer<Sink>::describe(std::ostream& os) const {
+    os << "tls: version " << (negotiated_version_ ? get_tls_version_name(static_cast<uint16_t>(*negotiated_version_)) : "unknown")
+       << ", state " << (is_tls13() ? get_tls13_state_name(get_tls13_state()) : get_tls12_state_name(get_state()))
+       << ", kind " << get_handshake_kind_name(get_handshake_kind())
+       << ", cipher 0x" << std::hex << cipher_suite_ << std::dec
+       << ", sni id " << client_hello_.server_name_id
+       << ", certificates " << certificates_.size()
+       << (lost_track_ ? ", lost track mid-stream" : "") << "\n";
+    os << "tls: encrypted cli " << (client_encrypted_ ? "yes" : "no") << " srv " << (server_encrypted_ ? "yes" : "no")
+       << ", partial record bytes cli " << client_buffer_.buffered() << " srv " << server_buffer_.buffered()
+       << ", partial handshake bytes cli " << client_handshake_.size() << " srv " << server_handshake_.size();
+    if (alert_) {
+        os << ", last alert " << (alert_->opaque ? std::string("encrypted")
+                                                 : get_alert_description(static_cast<uint8_t>(alert_->description)));
+    }
+    os << "\n";
+}
+
+template <typename Sink>
+bool TLSAnalyzer<Sink>::is_handshake_complete() const {
+    if (is_tls13()) {
+        return tls13_state_machine_.is_handshake_complete();
+    }
+    // The server Finished ends a full TLS 1.2 handshake
+    TLS12State state = state_machine_.get_state();
+    return state == TLS12State::FINISHED_RECEIVED || state == TLS12State::HANDSHAKE_COMPLETE;
+}
+
+template <typename Sink>
+TLSHandshakeKind TLSAnalyzer<Sink>::get_handshake_kind() const {
+    if (!resumed_) {
+        return TLSHandshakeKind::FULL;
+    }
+    // TLS 1.3 resumption is always PSK based (RFC 8446 Section 2.2)
+    if (is_tls13() || client_hello_.session_ticket) {
+        return TLSHandshakeKind::TICKET_RESUMPTION;
+    }
+    return TLSHandshakeKind::SESSION_ID_RESUMPTION;
+}
+
+template <typename Sink>
+bool TLSAnalyzer<Sink>::is_handshake_failed() const {
+    if (is_tls13()) {
+        return tls13_state_machine_.get_state() == TLS13State::ERROR;
+    }
+    TLS12State state = state_machine_.get_state();
+    return state == TLS12State::ERROR || state == TLS12State::ALERT_RECEIVED;
+}
+
+template <typename Sink>
+void TLSAnalyzer<Sink>::handle_record(Direction dir, TLSContentType type,
+    const uint8_t* fragment, size_t len) {
+    if (mid_stream_) {
+        if (type != TLSContentType::HANDSHAKE) {
+            if constexpr (Sink::enabled) {
+                sink_("Joined mid-stream after the handshake, nothing to track");
+            }
+            lost_track_ = true;
+            return;
+        }
+        mid_stream_ = false;
+    }
+
     switch (type) {
         case TLSContentType::HANDSHAKE:
-            handle_handshake(dir, fragment);
+            handle_handshake(dir, fragment, len);
             break;
             
         case TLSContentType::ALERT:
-            handle_alert(dir, fragment);
+            handle_alert(dir, fragment, len);
             break;
             
         case TLSContentType::CHANGE_CIPHER_SPEC:
@@ -57,37 +185,308 @@ void TLSAnalyzer::handle_record(Direction dir, TLSContentType type,
             break;
             
         case TLSContentType::APPLICATION_DATA:
-            // Ignore application data in this implementation
+            handle_application_data(dir, len);
+            break;
+
+        default:
             break;
     }
 }
 
-void TLSAnalyzer::handle_handshake(Direction dir, const std::vector<uint8_t>& data) {
-    if (data.empty()) {
+template <typename Sink>
+void TLSAnalyzer<Sink>::handle_handshake(Direction dir, const uint8_t* data, size_t data_len) {
+    if (data_len == 0) {
+        return;
+    }
+
+    if (encrypted(dir)) {
+        // Encrypted Finished; the type byte is ciphertext
+        state_machine_.process_encrypted_handshake(dir);
         return;
     }
 
-    TLSHandshakeType msg_type = static_cast<TLSHandshakeType>(data[0]);
-    state_machine_.process_handshake(dir, msg_type);
+    // Parse straight from the record unless a message is already pending
+    auto& pending = (dir == Direction::CLIENT_TO_SERVER) ? client_handshake_ : server_handshake_;
+    if (!pending.empty()) {
+        pending.insert(pending.end(), data, data + data_len);
+    }
+    const uint8_t* buf = pending.empty() ? data : pending.data();
+    size_t len = pending.empty() ? data_len : pending.size();
+
+    size_t offset = 0;
+    while (len - offset >= TLS_HANDSHAKE_HEADER_LEN) {
+        const uint8_t* msg = buf + offset;
+        size_t msg_len = (msg[1] << 16) | (msg[2] << 8) | msg[3];
+        if (len - offset - TLS_HANDSHAKE_HEADER_LEN < msg_len) {
+            break;
+        }
+        handle_handshake_message(dir, static_cast<TLSHandshakeType>(msg[0]),
+            msg + TLS_HANDSHAKE_HEADER_LEN, msg_len);
+        offset += TLS_HANDSHAKE_HEADER_LEN + msg_len;
+    }
+
+    // Keep the trailing partial message for the next record
+    if (pending.empty()) {
+        pending.assign(data + offset, data + data_len);
+    } else {
+        pending.erase(pending.begin(), pending.begin() + offset);
+    }
 }
 
-void TLSAnalyzer::handle_alert(Direction dir, const std::vector<uint8_t>& data) {
-    if (data.size() < 2) {
-        return;  // Alert message must be at least 2 bytes
+template <typename Sink>
+void TLSAnalyzer<Sink>::handle_handshake_message(Direction dir, TLSHandshakeType type,
+    const uint8_t* body, size_t len) {
+    if (type == TLSHandshakeType::SERVER_HELLO) {
+        handle_server_hello(dir, body, len);
+        return;
+    }
+
+    // TLS 1.3 certificates travel encrypted
+    if (type == TLSHandshakeType::CERTIFICATE && dir == Direction::SERVER_TO_CLIENT && !is_tls13()) {
+        handle_certificate(body, len);
+    }
+
+    if (type == TLSHandshakeType::CLIENT_HELLO) {
+        last_client_hello_ = PacketClock::now();
+        if (timestamps_.client_hello == PacketClock::time_point{}) {
+            timestamps_.client_hello = last_client_hello_;
+        }
+        TLSHelloInfo info;
+        if (TLSHelloParser::parse_client_hello(body, len, info)) {
+            client_hello_ = info;
+            tls13_state_machine_.set_early_data(info.early_data);
+            if constexpr (Sink::enabled) {
+                sink_("ClientHello offers up to " + get_tls_version_name(info.max_offered_version) +
+                      (info.session_ticket ? ", session ticket" : "") +
+                      (info.session_id_len ? ", session ID" : "") +
+                      (info.early_data ? ", early data" : ""));
+            }
+        }
+    }
+
+    // Until the ServerHello picks a version both state machines follow the handshake
+    if (!negotiated_version_ || !is_tls13()) {
+        state_machine_.process_handshake(dir, type);
+    }
+    if (!negotiated_version_ || is_tls13()) {
+        tls13_state_machine_.process_handshake(dir, type);
+    }
+}
+
+template <typename Sink>
+void TLSAnalyzer<Sink>::handle_server_hello(Direction dir, const uint8_t* body, size_t len) {
+    TLSHelloInfo info;
+    if (!TLSHelloParser::parse_server_hello(body, len, info)) {
+        if constexpr (Sink::enabled) {
+            sink_("Malformed ServerHello");
+        }
+        state_machine_.process_handshake(dir, TLSHandshakeType::SERVER_HELLO);
+        return;
+    }
+
+    negotiated_version_ = static_cast<TLSVersion>(info.selected_version);
+    if (!info.hello_retry_request) {
+        timestamps_.server_hello = PacketClock::now();
+        cipher_suite_ = info.cipher_suite;
+        resumed_ = is_tls13() && info.pre_shared_key;
+    }
+
+    if constexpr (Sink::enabled) {
+        std::ostringstream oss;
+        oss << (info.hello_retry_request ? "HelloRetryRequest" : "ServerHello")
+            << " selects " << get_tls_version_name(info.selected_version)
+            << ", cipher suite 0x" << std::hex << std::setw(4) << std::setfill('0') << info.cipher_suite;
+        sink_(oss.str());
+    }
+
+    if (is_tls13()) {
+        if (info.hello_retry_request) {
+            tls13_state_machine_.process_hello_retry_request(dir);
+        } else {
+            tls13_state_machine_.set_cipher_suite(info.cipher_suite);
+            tls13_state_machine_.process_handshake(dir, TLSHandshakeType::SERVER_HELLO);
+        }
+    } else {
+        state_machine_.process_handshake(dir, TLSHandshakeType::SERVER_HELLO);
+    }
+}
+
+template <typename Sink>
+void TLSAnalyzer<Sink>::handle_certificate(const uint8_t* body, size_t len) {
+    // certificate_list<0..2^24-1> of ASN.1Cert<1..2^24-1> (RFC 5246 Section 7.4.2)
+    if (len < 3) {
+        return;
+    }
+    size_t list_len = (body[0] << 16) | (body[1] << 8) | body[2];
+    size_t end = std::min(len, 3 + list_len);
+    size_t offset = 3;
+
+    certificates_.clear();
+    auto& cache = CertificateCache::get_instance();
+    while (end - offset >= 3) {
+        size_t cert_len = (body[offset] << 16) | (body[offset + 1] << 8) | body[offset + 2];
+        offset += 3;
+        if (cert_len == 0 || end - offset < cert_len) {
+            break;
+        }
+
+        bool hit = false;
+        certificates_.push_back(cache.lookup(body + offset, cert_len, hit));
+        offset += cert_len;
+
+        if constexpr (Sink::enabled) {
+            const auto& entry = *certificates_.back();
+            std::ostringstream oss;
+            oss << "Certificate[" << certificates_.size() - 1 << "] sha256="
+                << Sha256::to_hex(entry.digest) << (hit ? " (cached)" : " (parsed)");
+            if (entry.parsed) {
+                oss << " subject=" << entry.info.subject << " issuer=" << entry.info.issuer
+                    << " not_before=" << entry.info.not_before << " not_after=" << entry.info.not_after;
+                for (const auto& name : entry.info.san) {
+                    oss << " san=" << name;
+                }
+            } else {
+                oss << " undecodable";
+            }
+            sink_(oss.str());
+        }
+    }
+
+    if constexpr (Sink::enabled) {
+        std::ostringstream oss;
+        oss << "Certificate chain of " << certificates_.size() << ", cache hit ratio "
+            << std::fixed << std::setprecision(3) << cache.get_hit_ratio();
+        sink_(oss.str());
     }
-    
-    tls_log_.log(std::make_shared<ConnLogEntry>(key_, "[Temp] TLS ERROR State"));
-    // For now, any alert moves us to ERROR state; 
-    // decrpty and seve alert info; todo, also cipher spec info.
-    // state_machine_.process_alert(dir); 
 }
 
-void TLSAnalyzer::handle_change_cipher_spec(Direction dir) {
+template <typename Sink>
+void TLSAnalyzer<Sink>::handle_alert(Direction dir, const uint8_t* data, size_t len) {
+    TLSAlert alert{TLSAlertLevel::FATAL, TLSAlertDescription::CLOSE_NOTIFY};
+    if (encrypted(dir)) {
+        // Protected by the record layer, level and description unreadable
+        alert.opaque = true;
+    } else if (len >= TLS_ALERT_LEN) {
+        alert.level = static_cast<TLSAlertLevel>(data[0]);
+        alert.description = static_cast<TLSAlertDescription>(data[1]);
+    } else {
+        return;
+    }
+    alert_ = alert;
+    AlertCounters::get_instance().record(info_->flow.server_port, alert);
+
+    if constexpr (Sink::enabled) {
+        std::ostringstream oss;
+        oss << "Alert from " << (dir == Direction::CLIENT_TO_SERVER ? "client" : "server") << ": ";
+        if (alert.opaque) {
+            oss << "opaque (encrypted)";
+        } else {
+            oss << get_alert_level_name(data[0]) << " " << get_alert_description(data[1])
+                << " (" << static_cast<int>(data[1]) << ")";
+        }
+        sink_(oss.str());
+    }
+
+    // A warning other than close_notify leaves the handshake running; TLS 1.3
+    // treats every alert but user_canceled as terminating (RFC 8446 Section 6)
+    bool terminating = alert.opaque || alert.level == TLSAlertLevel::FATAL ||
+                       alert.description == TLSAlertDescription::CLOSE_NOTIFY ||
+                       (is_tls13() && alert.description != TLSAlertDescription::USER_CANCELED);
+    if (!terminating) {
+        return;
+    }
+    if (!negotiated_version_ || !is_tls13()) {
+        state_machine_.process_alert(dir);
+    }
+    if (!negotiated_version_ || is_tls13()) {
+        tls13_state_machine_.process_alert(dir);
+    }
+}
+
+template <typename Sink>
+void TLSAnalyzer<Sink>::handle_change_cipher_spec(Direction dir) {
+    if (timestamps_.change_cipher_spec == PacketClock::time_point{}) {
+        timestamps_.change_cipher_spec = PacketClock::now();
+    }
+    // With 0-RTT the client's compatibility record follows the ClientHello,
+    // ahead of the ServerHello (RFC 8446 Appendix D.4)
+    bool early = !negotiated_version_ && dir == Direction::CLIENT_TO_SERVER && client_hello_.early_data;
+    if (is_tls13() || early) {
+        tls13_state_machine_.process_change_cipher_spec(dir);
+        return;
+    }
     state_machine_.process_change_cipher_spec(dir);
+    encrypted(dir) = true;
+    if (state_machine_.get_state() == TLS12State::ABBREVIATED_CHANGE_CIPHER_SPEC_RECEIVED) {
+        resumed_ = true;
+    }
 }
 
-void TLSAnalyzer::reset() {
+template <typename Sink>
+void TLSAnalyzer<Sink>::handle_application_data(Direction dir, size_t len) {
+    // TLS 1.2 application data carries nothing the state machine tracks
+    if (!negotiated_version_ || is_tls13()) {
+        tls13_state_machine_.process_encrypted_record(dir, len);
+    }
+}
+
+template <typename Sink>
+void TLSAnalyzer<Sink>::record_handshake() {
+    handshake_recorded_ = true;
+    timestamps_.finished = PacketClock::now();
+    // Joined mid-handshake, nothing to measure from
+    if (timestamps_.client_hello == PacketClock::time_point{}) {
+        return;
+    }
+
+    auto handshake_rtt = timestamps_.finished - timestamps_.client_hello;
+    auto server_think_time = timestamps_.server_hello - last_client_hello_;
+    HandshakeMetrics::get_instance().record(info_->flow.server_port, get_handshake_kind(), handshake_rtt, server_think_time);
+
+    if (EventBus::get_instance().is_running()) {
+        AnalyzerEvent event;
+        event.type = AnalyzerEventType::TLS_HANDSHAKE_DONE;
+        event.flow = info_->flow;
+        event.time_us = timestamps_.finished.time_since_epoch().count();
+        event.tls_handshake_done.sni_id = client_hello_.server_name_id;
+        event.tls_handshake_done.version = negotiated_version_ ? static_cast<uint16_t>(*negotiated_version_) : 0;
+        event.tls_handshake_done.cipher = cipher_suite_;
+        event.tls_handshake_done.kind = static_cast<uint8_t>(get_handshake_kind());
+        event.tls_handshake_done.rtt_us = static_cast<uint32_t>(handshake_rtt.count() > 0 ? handshake_rtt.count() : 0);
+        EventBus::get_instance().publish(event);
+    }
+
+    if constexpr (Sink::enabled) {
+        std::ostringstream oss;
+        oss << "Handshake complete: " << get_handshake_kind_name(get_handshake_kind())
+            << ", rtt " << handshake_rtt.count() << "us, server think time "
+            << server_think_time.count() << "us";
+        sink_(oss.str());
+    }
+}
+
+template <typename Sink>
+void TLSAnalyzer<Sink>::reset() {
     state_machine_.reset();
+    tls13_state_machine_.reset();
     client_buffer_.reset();
     server_buffer_.reset();
+    client_handshake_.clear();
+    server_handshake_.clear();
+    certificates_.clear();
+    negotiated_version_.reset();
+    client_encrypted_ = false;
+    server_encrypted_ = false;
+    client_hello_ = TLSHelloInfo();
+    timestamps_ = TLSHandshakeTimestamps();
+    last_client_hello_ = PacketClock::time_point();
+    resumed_ = false;
+    handshake_recorded_ = false;
+    alert_.reset();
+    cipher_suite_ = 0;
+    mid_stream_ = false;
+    lost_track_ = false;
 }
+
+template class TLSAnalyzer<TLSLogSink>;
+template class TLSAnalyzer<NullTLSSink>;
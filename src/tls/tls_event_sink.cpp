@@ -0,0 +1,10 @@
+#include "tls/tls_event_sink.hpp"
+#include "log/conn_log_entry.hpp"
+
+TLSLogSink::TLSLogSink()
+    : tls_log_(&LogManager::get_instance().get_registered_log("tls.log")) {
+}
+
+void TLSLogSink::operator()(const std::string& msg) const {
+    tls_log_->log(std::make_shared<ConnLogEntry>(*key_, msg));
+}
@@ -0,0 +1,122 @@
+#include "tls/tls_hello_parser.hpp"
+#include "misc/fnv1a.hpp"
+#include <cstring>
+
+namespace {
+
+uint16_t read_u16(const uint8_t* p) {
+    return static_cast<uint16_t>((p[0] << 8) | p[1]);
+}
+
+} // namespace
+
+bool TLSHelloParser::parse_client_hello(const uint8_t* data, size_t len, TLSHelloInfo& info) {
+    // legacy_version(2) + random(32) + session_id(1 + n)
+    size_t pos = 2 + TLS_RANDOM_LEN;
+    if (len < pos + 1) return false;
+    info.legacy_version = read_u16(data);
+    info.max_offered_version = info.legacy_version;
+
+    if (!parse_session_id(data, len, pos, info)) return false;
+    pos += 1 + data[pos];
+
+    // cipher_suites(2 + n)
+    if (len < pos + 2) return false;
+    pos += 2 + read_u16(data + pos);
+
+    // compression_methods(1 + n)
+    if (len < pos + 1) return false;
+    pos += 1 + data[pos];
+
+    // Extensions are optional before TLS 1.3
+    if (len < pos + 2) return len >= pos;
+    size_t ext_len = read_u16(data + pos);
+    pos += 2;
+    if (len < pos + ext_len) return false;
+
+    return parse_extensions(data + pos, ext_len, true, info);
+}
+
+bool TLSHelloParser::parse_server_hello(const uint8_t* data, size_t len, TLSHelloInfo& info) {
+    // legacy_version(2) + random(32) + session_id(1 + n)
+    size_t pos = 2 + TLS_RANDOM_LEN;
+    if (len < pos + 1) return false;
+    info.legacy_version = read_u16(data);
+    info.selected_version = info.legacy_version;
+    info.hello_retry_request =
+        std::memcmp(data + 2, TLS_HELLO_RETRY_REQUEST_RANDOM, TLS_RANDOM_LEN) == 0;
+
+    if (!parse_session_id(data, len, pos, info)) return false;
+    pos += 1 + data[pos];
+
+    // cipher_suite(2) + compression_method(1)
+    if (len < pos + 3) return false;
+    info.cipher_suite = read_u16(data + pos);
+    pos += 3;
+
+    if (len < pos + 2) return len >= pos;
+    size_t ext_len = read_u16(data + pos);
+    pos += 2;
+    if (len < pos + ext_len) return false;
+
+    return parse_extensions(data + pos, ext_len, false, info);
+}
+
+bool TLSHelloParser::parse_extensions(const uint8_t* data, size_t len, bool is_client, TLSHelloInfo& info) {
+    size_t pos = 0;
+    while (pos + 4 <= len) {
+        uint16_t type = read_u16(data + pos);
+        size_t ext_len = read_u16(data + pos + 2);
+        pos += 4;
+        if (pos + ext_len > len) return false;
+
+        const uint8_t* ext = data + pos;
+        if (type == TLS_EXT_SUPPORTED_VERSIONS) {
+            if (is_client) {
+                // ClientHello: versions<2..254>, one byte length prefix
+                if (ext_len < 1 || ext[0] + 1u > ext_len) return false;
+                for (size_t i = 1; i + 1 < 1u + ext[0]; i += 2) {
+                    uint16_t version = read_u16(ext + i);
+                    if (!is_grease(version) && version > info.max_offered_version) {
+                        info.max_offered_version = version;
+                    }
+                }
+            } else {
+                // ServerHello/HelloRetryRequest: selected_version only
+                if (ext_len < 2) return false;
+                info.selected_version = read_u16(ext);
+            }
+        } else if (type == TLS_EXT_SESSION_TICKET) {
+            // An empty ClientHello ticket only asks for a new one
+            if (is_client && ext_len > 0) info.session_ticket = true;
+        } else if (type == TLS_EXT_PRE_SHARED_KEY) {
+            info.pre_shared_key = true;
+        } else if (type == TLS_EXT_EARLY_DATA && is_client) {
+            info.early_data = true;
+        } else if (type == TLS_EXT_SERVER_NAME && is_client) {
+            // server_name_list<1..2^16-1>, first entry: name_type(1) = host_name, HostName<1..2^16-1>
+            if (ext_len >= 5 && ext[2] == 0) {
+                size_t name_len = read_u16(ext + 3);
+                if (5 + name_len <= ext_len) {
+                    info.server_name_id = fnv1a_32_lower(ext + 5, name_len);
+                }
+            }
+        }
+        pos += ext_len;
+    }
+    return pos == len;
+}
+
+bool TLSHelloParser::parse_session_id(const uint8_t* data, size_t len, size_t pos, TLSHelloInfo& info) {
+    // session_id<0..32>
+    size_t id_len = data[pos];
+    if (id_len > TLS_MAX_SESSION_ID_LEN || len < pos + 1 + id_len) return false;
+    std::memcpy(info.session_id.data(), data + pos + 1, id_len);
+    info.session_id_len = static_cast<uint8_t>(id_len);
+    return true;
+}
+
+bool TLSHelloParser::is_grease(uint16_t value) {
+    // RFC 8701 reserved values: 0x0a0a, 0x1a1a, ..., 0xfafa
+    return (value & 0x0f0f) == 0x0a0a && (value >> 8) == (value & 0xff);
+}
@@ -1,19 +1,22 @@
 #include "tls/tls_recorder.hpp"
-#include "log/conn_log_entry.hpp"
+#include "tls/tls_event_sink.hpp"
+#include "log/log_entry.hpp"
 #include <algorithm>
 #include <iostream>
 #include <iomanip>
 
-TLSRecorder::TLSRecorder(std::function<void(const std::string&)> log_helper)
-    : log_helper_(std::move(log_helper)) {
+template <typename Sink>
+TLSRecorder<Sink>::TLSRecorder(Sink sink)
+    : sink_(std::move(sink)) {
 }
 
-std::optional<size_t> TLSRecorder::try_parse(const uint8_t* data, size_t len,
-    TLSContentType& type, std::vector<uint8_t>& fragment) {
-    std::ostringstream oss;
+template <typename Sink>
+std::optional<size_t> TLSRecorder<Sink>::try_parse(const uint8_t* data, size_t len,
+    TLSContentType& type, const uint8_t*& fragment, size_t& fragment_len) {
     if (!validate_header(data, len)) {
-        oss << "[TLSRecorder] Invalid header: insufficient data";
-        log_helper_(oss.str());
+        if constexpr (Sink::enabled) {
+            sink_("[TLSRecorder] Invalid header: insufficient data");
+        }
         return std::nullopt;
     }
 
@@ -24,37 +27,49 @@ std::optional<size_t> TLSRecorder::try_parse(const uint8_t* data, size_t len,
 
     // Validate version and length
     if (!check_version(version) || !check_length(length)) {
-        oss << "[TLSRecorder] Invalid version or length: version = " 
-            << std::hex << version << ", length = " << length << std::endl;
-        oss << "[TLSRecorder] Raw header bytes with len " << std::dec << len << ":" << std::endl;
-        oss << LogEntry::get_formatted_buffer(data, len);
-        log_helper_(oss.str());
+        if constexpr (Sink::enabled) {
+            std::ostringstream oss;
+            oss << "[TLSRecorder] Invalid version or length: version = " 
+                << std::hex << version << ", length = " << length << std::endl;
+            oss << "[TLSRecorder] Raw header bytes with len " << std::dec << len << ":" << std::endl;
+            oss << LogEntry::get_formatted_buffer(data, len);
+            sink_(oss.str());
+        }
         return std::nullopt;
     }
 
     // Check if we have the complete record
     size_t total_length = TLS_RECORD_HEADER_LEN + length;
     if (len < total_length) {
-        oss << "[TLSRecorder] Incomplete record: need " << total_length << " bytes, have " << len;
-        log_helper_(oss.str());
+        if constexpr (Sink::enabled) {
+            std::ostringstream oss;
+            oss << "[TLSRecorder] Incomplete record: need " << total_length << " bytes, have " << len;
+            sink_(oss.str());
+        }
         return std::nullopt;
     }
 
-    // Extract fragment
-    fragment.assign(data + TLS_RECORD_HEADER_LEN, data + total_length);
-    oss << "[TLSRecorder] Fragment bytes with len " << fragment.size() << ":" << std::endl;
-    oss << LogEntry::get_formatted_buffer(fragment.data(), fragment.size()) << std::endl;
-    oss << "[TLSRecorder] Successfully parsed record: type = " << static_cast<int>(type)
-        << " (" << get_tls_content_type_name(type) << "), length: " << fragment.size();
-    log_helper_(oss.str());
+    // The fragment is left in place
+    fragment = data + TLS_RECORD_HEADER_LEN;
+    fragment_len = length;
+    if constexpr (Sink::enabled) {
+        std::ostringstream oss;
+        oss << "[TLSRecorder] Fragment bytes with len " << fragment_len << ":" << std::endl;
+        oss << LogEntry::get_formatted_buffer(fragment, fragment_len) << std::endl;
+        oss << "[TLSRecorder] Successfully parsed record: type = " << static_cast<int>(type)
+            << " (" << get_tls_content_type_name(type) << "), length: " << fragment_len;
+        sink_(oss.str());
+    }
     return total_length;
 }
 
-bool TLSRecorder::validate_header(const uint8_t* data, size_t len) {
+template <typename Sink>
+bool TLSRecorder<Sink>::validate_header(const uint8_t* data, size_t len) {
     return len >= TLS_RECORD_HEADER_LEN;
 }
 
-bool TLSRecorder::check_version(uint16_t version) {
+template <typename Sink>
+bool TLSRecorder<Sink>::check_version(uint16_t version) {
     // Accept all known TLS versions
     switch (version) {
         case static_cast<uint16_t>(TLSVersion::TLS_1_0):
@@ -67,29 +82,121 @@ bool TLSRecorder::check_version(uint16_t version) {
     }
 }
 
-bool TLSRecorder::check_length(uint16_t length) {
+template <typename Sink>
+bool TLSRecorder<Sink>::check_length(uint16_t length) {
     return length <= TLS_MAX_RECORD_LEN;
 }
 
-void TLSRecorder::add_data(const uint8_t* data, size_t len) {
+template <typename Sink>
+bool TLSRecorder<Sink>::plausible_header(const uint8_t* data) {
+    uint8_t type = data[0];
+    uint16_t version = (data[1] << 8) | data[2];
+    uint16_t length = (data[3] << 8) | data[4];
+    return type >= static_cast<uint8_t>(TLSContentType::CHANGE_CIPHER_SPEC) &&
+           type <= static_cast<uint8_t>(TLSContentType::APPLICATION_DATA) &&
+           check_version(version) && length > 0 && check_length(length);
+}
+
+template <typename Sink>
+bool TLSRecorder<Sink>::find_boundary() {
+    size_t offset = pos_;
+    bool found = false;
+    while (buffer_.size() - offset >= TLS_RECORD_HEADER_LEN) {
+        const uint8_t* header = buffer_.data() + offset;
+        if (!plausible_header(header)) {
+            ++offset;
+            continue;
+        }
+        // Confirm the candidate by what follows the record it announces
+        size_t next = offset + TLS_RECORD_HEADER_LEN + ((header[3] << 8) | header[4]);
+        if (next == buffer_.size()) {
+            found = true;
+        } else if (next + TLS_RECORD_HEADER_LEN <= buffer_.size()) {
+            if (!plausible_header(buffer_.data() + next)) {
+                ++offset;
+                continue;
+            }
+            found = true;
+        }
+        // Otherwise wait for the data that confirms or refutes it
+        break;
+    }
+
+    resync_skipped_ += offset - pos_;
+    pos_ = offset;
+    if (found) {
+        resyncing_ = false;
+        if constexpr (Sink::enabled) {
+            sink_("[TLSRecorder] Resynced on a record boundary after skipping " +
+                  std::to_string(resync_skipped_) + " bytes");
+        }
+    }
+    return found;
+}
+
+template <typename Sink>
+void TLSRecorder<Sink>::resync() {
+    resyncing_ = true;
+    resync_skipped_ = 0;
+}
+
+template <typename Sink>
+void TLSRecorder<Sink>::add_data(const uint8_t* data, size_t len) {
+    // Compact once per call rather than once per record
+    if (pos_ == buffer_.size()) {
+        buffer_.clear();
+    } else if (pos_ > 0) {
+        buffer_.erase(buffer_.begin(), buffer_.begin() + pos_);
+    }
+    pos_ = 0;
     buffer_.insert(buffer_.end(), data, data + len);
 }
 
-bool TLSRecorder::try_extract_record(TLSContentType& type, std::vector<uint8_t>& fragment) {
-    if (buffer_.empty()) {
+template <typename Sink>
+bool TLSRecorder<Sink>::try_extract_record(TLSContentType& type, const uint8_t*& fragment,
+    size_t& fragment_len) {
+    if (pos_ == buffer_.size()) {
+        return false;
+    }
+    if (resyncing_ && !find_boundary()) {
         return false;
     }
 
-    auto result = try_parse(buffer_.data(), buffer_.size(), type, fragment);
+    auto result = try_parse(buffer_.data() + pos_, buffer_.size() - pos_, type, fragment, fragment_len);
     if (!result) {
         return false;
     }
 
-    // Remove the processed record from the buffer
-    buffer_.erase(buffer_.begin(), buffer_.begin() + *result);
+    // Step past the record; add_data() drops it from the buffer
+    pos_ += *result;
     return true;
 }
 
-void TLSRecorder::reset() {
+template <typename Sink>
+size_t TLSRecorder<Sink>::bytes_needed() const {
+    // Any amount of data may be needed to find a boundary
+    if (resyncing_) {
+        return 0;
+    }
+    size_t available = buffer_.size() - pos_;
+    if (available < TLS_RECORD_HEADER_LEN) {
+        return TLS_RECORD_HEADER_LEN - available;
+    }
+    uint16_t length = (buffer_[pos_ + 3] << 8) | buffer_[pos_ + 4];
+    if (length > TLS_MAX_RECORD_LEN) {
+        return 0;
+    }
+    size_t total_length = TLS_RECORD_HEADER_LEN + length;
+    return total_length > available ? total_length - available : 0;
+}
+
+template <typename Sink>
+void TLSRecorder<Sink>::reset() {
     buffer_.clear();
+    pos_ = 0;
+    resyncing_ = false;
+    resync_skipped_ = 0;
 }
+
+template class TLSRecorder<TLSLogSink>;
+template class TLSRecorder<NullTLSSink>;
@@ -0,0 +1,276 @@
+#include "tls/x509_parser.hpp"
+#include <cstring>
+
+namespace {
+
+// DER tags used by X.509
+constexpr uint8_t DER_INTEGER = 0x02;
+constexpr uint8_t DER_OCTET_STRING = 0x04;
+constexpr uint8_t DER_OID = 0x06;
+constexpr uint8_t DER_UTC_TIME = 0x17;
+constexpr uint8_t DER_GENERALIZED_TIME = 0x18;
+constexpr uint8_t DER_SEQUENCE = 0x30;
+constexpr uint8_t DER_SET = 0x31;
+constexpr uint8_t DER_CONTEXT_0 = 0xa0;      // [0] EXPLICIT version
+constexpr uint8_t DER_CONTEXT_3 = 0xa3;      // [3] EXPLICIT extensions
+constexpr uint8_t SAN_DNS_NAME = 0x82;       // [2] IMPLICIT IA5String
+constexpr uint8_t SAN_IP_ADDRESS = 0x87;     // [7] IMPLICIT OCTET STRING
+
+// 2.5.29.17 subjectAltName
+constexpr uint8_t OID_SUBJECT_ALT_NAME[] = {0x55, 0x1d, 0x11};
+
+// Walks consecutive TLV elements of a DER buffer
+class DerReader {
+public:
+    DerReader(const uint8_t* data, size_t len) : data_(data), len_(len), pos_(0) {}
+
+    bool next(uint8_t& tag, const uint8_t*& value, size_t& value_len) {
+        if (pos_ + 2 > len_) return false;
+        tag = data_[pos_++];
+        size_t length = data_[pos_++];
+        if (length & 0x80) {
+            size_t bytes = length & 0x7f;
+            if (bytes == 0 || bytes > 4 || pos_ + bytes > len_) return false;
+            length = 0;
+            for (size_t i = 0; i < bytes; ++i) {
+                length = (length << 8) | data_[pos_++];
+            }
+        }
+        if (length > len_ - pos_) return false;
+        value = data_ + pos_;
+        value_len = length;
+        pos_ += length;
+        return true;
+    }
+
+    bool expect(uint8_t expected, const uint8_t*& value, size_t& value_len) {
+        uint8_t tag;
+        return next(tag, value, value_len) && tag == expected;
+    }
+
+    uint8_t peek() const { return pos_ < len_ ? data_[pos_] : 0; }
+    bool done() const { return pos_ >= len_; }
+
+private:
+    const uint8_t* data_;
+    size_t len_;
+    size_t pos_;
+};
+
+const char* attribute_name(const uint8_t* oid, size_t len) {
+    // 2.5.4.x attribute types
+    if (len == 3 && oid[0] == 0x55 && oid[1] == 0x04) {
+        switch (oid[2]) {
+            case 0x03: return "CN";
+            case 0x06: return "C";
+            case 0x07: return "L";
+            case 0x08: return "ST";
+            case 0x0a: return "O";
+            case 0x0b: return "OU";
+            default: break;
+        }
+    }
+    return nullptr;
+}
+
+std::string oid_to_string(const uint8_t* oid, size_t len) {
+    if (len == 0) return "";
+    std::string out = std::to_string(oid[0] / 40) + "." + std::to_string(oid[0] % 40);
+    uint64_t value = 0;
+    for (size_t i = 1; i < len; ++i) {
+        value = (value << 7) | (oid[i] & 0x7f);
+        if (!(oid[i] & 0x80)) {
+            out += "." + std::to_string(value);
+            value = 0;
+        }
+    }
+    return out;
+}
+
+int two_digits(const uint8_t* p) {
+    return (p[0] - '0') * 10 + (p[1] - '0');
+}
+
+// Days since 1970-01-01 for a proleptic Gregorian date
+int64_t days_from_civil(int64_t y, unsigned m, unsigned d) {
+    y -= m <= 2;
+    const int64_t era = (y >= 0 ? y : y - 399) / 400;
+    const unsigned yoe = static_cast<unsigned>(y - era * 400);
+    const unsigned doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + static_cast<int64_t>(doe) - 719468;
+}
+
+} // namespace
+
+bool X509Parser::parse(const uint8_t* der, size_t len, CertificateInfo& info) {
+    const uint8_t* cert;
+    size_t cert_len;
+    DerReader outer(der, len);
+    if (!outer.expect(DER_SEQUENCE, cert, cert_len)) return false;
+
+    const uint8_t* tbs;
+    size_t tbs_len;
+    DerReader cert_reader(cert, cert_len);
+    if (!cert_reader.expect(DER_SEQUENCE, tbs, tbs_len)) return false;
+
+    DerReader reader(tbs, tbs_len);
+    uint8_t tag;
+    const uint8_t* value;
+    size_t value_len;
+
+    // [0] EXPLICIT version OPTIONAL
+    if (reader.peek() == DER_CONTEXT_0 && !reader.next(tag, value, value_len)) return false;
+
+    // serialNumber
+    if (!reader.expect(DER_INTEGER, value, value_len)) return false;
+    static const char* hex = "0123456789abcdef";
+    info.serial.clear();
+    for (size_t i = 0; i < value_len; ++i) {
+        info.serial.push_back(hex[value[i] >> 4]);
+        info.serial.push_back(hex[value[i] & 0x0f]);
+    }
+
+    // signature AlgorithmIdentifier
+    if (!reader.expect(DER_SEQUENCE, value, value_len)) return false;
+
+    // issuer
+    if (!reader.expect(DER_SEQUENCE, value, value_len) || !parse_name(value, value_len, info.issuer)) return false;
+
+    // validity
+    if (!reader.expect(DER_SEQUENCE, value, value_len)) return false;
+    DerReader validity(value, value_len);
+    const uint8_t* time_value;
+    size_t time_len;
+    if (!validity.next(tag, time_value, time_len) || !parse_time(tag, time_value, time_len, info.not_before)) return false;
+    if (!validity.next(tag, time_value, time_len) || !parse_time(tag, time_value, time_len, info.not_after)) return false;
+
+    // subject
+    if (!reader.expect(DER_SEQUENCE, value, value_len) || !parse_name(value, value_len, info.subject)) return false;
+
+    // subjectPublicKeyInfo
+    if (!reader.expect(DER_SEQUENCE, value, value_len)) return false;
+
+    // Optional unique IDs, then [3] EXPLICIT extensions
+    while (!reader.done()) {
+        if (!reader.next(tag, value, value_len)) return false;
+        if (tag == DER_CONTEXT_3) {
+            const uint8_t* exts;
+            size_t exts_len;
+            DerReader wrapper(value, value_len);
+            if (!wrapper.expect(DER_SEQUENCE, exts, exts_len)) return false;
+            return parse_extensions(exts, exts_len, info);
+        }
+    }
+    return true;
+}
+
+bool X509Parser::parse_name(const uint8_t* data, size_t len, std::string& out) {
+    out.clear();
+    DerReader rdns(data, len);
+    while (!rdns.done()) {
+        const uint8_t* rdn;
+        size_t rdn_len;
+        if (!rdns.expect(DER_SET, rdn, rdn_len)) return false;
+
+        DerReader attributes(rdn, rdn_len);
+        while (!attributes.done()) {
+            const uint8_t* attr;
+            size_t attr_len;
+            if (!attributes.expect(DER_SEQUENCE, attr, attr_len)) return false;
+
+            DerReader fields(attr, attr_len);
+            const uint8_t* oid;
+            size_t oid_len;
+            uint8_t tag;
+            const uint8_t* value;
+            size_t value_len;
+            if (!fields.expect(DER_OID, oid, oid_len) || !fields.next(tag, value, value_len)) return false;
+
+            if (!out.empty()) out += ",";
+            const char* name = attribute_name(oid, oid_len);
+            out += name ? name : oid_to_string(oid, oid_len);
+            out += "=";
+            out.append(reinterpret_cast<const char*>(value), value_len);
+        }
+    }
+    return true;
+}
+
+bool X509Parser::parse_time(uint8_t tag, const uint8_t* data, size_t len, time_t& out) {
+    // UTCTime YYMMDDHHMMSSZ or GeneralizedTime YYYYMMDDHHMMSSZ
+    int64_t year;
+    if (tag == DER_UTC_TIME && len == 13) {
+        year = two_digits(data);
+        year += (year < 50) ? 2000 : 1900;  // RFC 5280 Section 4.1.2.5.1
+        data += 2;
+    } else if (tag == DER_GENERALIZED_TIME && len == 15) {
+        year = two_digits(data) * 100 + two_digits(data + 2);
+        data += 4;
+    } else {
+        return false;
+    }
+
+    for (size_t i = 0; i < 10; ++i) {
+        if (data[i] < '0' || data[i] > '9') return false;
+    }
+    unsigned month = two_digits(data);
+    unsigned day = two_digits(data + 2);
+    if (month < 1 || month > 12 || day < 1 || day > 31) return false;
+
+    int64_t days = days_from_civil(year, month, day);
+    out = static_cast<time_t>(days * 86400 + two_digits(data + 4) * 3600 +
+        two_digits(data + 6) * 60 + two_digits(data + 8));
+    return true;
+}
+
+bool X509Parser::parse_extensions(const uint8_t* data, size_t len, CertificateInfo& info) {
+    DerReader extensions(data, len);
+    while (!extensions.done()) {
+        const uint8_t* ext;
+        size_t ext_len;
+        if (!extensions.expect(DER_SEQUENCE, ext, ext_len)) return false;
+
+        DerReader fields(ext, ext_len);
+        const uint8_t* oid;
+        size_t oid_len;
+        if (!fields.expect(DER_OID, oid, oid_len)) return false;
+        if (oid_len != sizeof(OID_SUBJECT_ALT_NAME) ||
+            std::memcmp(oid, OID_SUBJECT_ALT_NAME, oid_len) != 0) {
+            continue;
+        }
+
+        // critical BOOLEAN DEFAULT FALSE, then extnValue
+        uint8_t tag;
+        const uint8_t* value;
+        size_t value_len;
+        do {
+            if (!fields.next(tag, value, value_len)) return false;
+        } while (tag != DER_OCTET_STRING);
+
+        const uint8_t* names;
+        size_t names_len;
+        DerReader wrapper(value, value_len);
+        if (!wrapper.expect(DER_SEQUENCE, names, names_len)) return false;
+        return parse_san(names, names_len, info.san);
+    }
+    return true;
+}
+
+bool X509Parser::parse_san(const uint8_t* data, size_t len, std::vector<std::string>& out) {
+    DerReader names(data, len);
+    while (!names.done()) {
+        uint8_t tag;
+        const uint8_t* value;
+        size_t value_len;
+        if (!names.next(tag, value, value_len)) return false;
+
+        if (tag == SAN_DNS_NAME) {
+            out.emplace_back(reinterpret_cast<const char*>(value), value_len);
+        } else if (tag == SAN_IP_ADDRESS && value_len == 4) {
+            out.push_back(std::to_string(value[0]) + "." + std::to_string(value[1]) + "." +
+                std::to_string(value[2]) + "." + std::to_string(value[3]));
+        }
+    }
+    return true;
+}
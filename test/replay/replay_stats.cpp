@@ -0,0 +1,35 @@
+// Linked into tcp_tracker_replay only: counts heap allocations and prints
+// them with the peak RSS when the process exits, for replay_test.sh
+#include <sys/resource.h>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+std::atomic<unsigned long long> allocations{0};
+
+void* counted_alloc(size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* ptr = std::malloc(size ? size : 1)) return ptr;
+    throw std::bad_alloc();
+}
+
+struct ReplayStats {
+    ~ReplayStats() {
+        rusage usage{};
+        getrusage(RUSAGE_SELF, &usage);
+        std::fprintf(stderr, "replay_stats allocations=%llu peak_rss_kb=%ld\n",
+                     allocations.load(std::memory_order_relaxed), usage.ru_maxrss);
+    }
+} replay_stats;
+
+} // namespace
+
+void* operator new(size_t size) { return counted_alloc(size); }
+void* operator new[](size_t size) { return counted_alloc(size); }
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { std::free(ptr); }
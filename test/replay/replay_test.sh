@@ -0,0 +1,130 @@
+#!/bin/bash
+# Replays a generated pcap through tcp_tracker_replay.
+#
+#   replay_test.sh golden NAME TRACKER GEN GOLDEN_DIR [TRACKER_ARGS...] -- GEN_ARGS...
+#     Runs TRACKER -d TRACKER_ARGS and diffs tcp.log and tls.log, timestamps
+#     stripped, and the final *_total counters of the metrics snapshot
+#     against GOLDEN_DIR/NAME.{tcp,tls,counters}.log.
+#   replay_test.sh perf NAME TRACKER GEN BASELINE TOLERANCE -- GEN_ARGS...
+#     Fails when peak RSS or allocations grow by more than TOLERANCE percent
+#     against the BASELINE line of NAME. With REPLAY_PERF_TIMING=1 it also
+#     fails when wall time grows or packets/s drops by as much; wall time is
+#     then the best of PERF_RUNS runs to keep scheduling noise out.
+#
+# With REPLAY_UPDATE=1 the golden files or the baseline line are rewritten.
+
+set -u
+mode=$1 name=$2 tracker=$3 gen=$4 reference=$5
+if [ "$mode" = perf ]; then
+    tolerance=$6
+    shift 6
+else
+    shift 5
+fi
+tracker_args=()
+while [ $# -gt 0 ] && [ "$1" != -- ]; do
+    tracker_args+=("$1")
+    shift
+done
+[ "${1:-}" = -- ] && shift
+
+work=$(mktemp -d "${TMPDIR:-/tmp}/replay_${name}.XXXXXX")
+trap 'rm -rf "$work"' EXIT
+cd "$work" || exit 1
+
+packets=$("$gen" -o replay.pcap "$@" | sed -n 's/^Wrote \([0-9]*\) packets.*/\1/p')
+if [ -z "$packets" ]; then
+    echo "FAIL $name: tcp_tracker_gen failed"
+    exit 1
+fi
+
+timing=${REPLAY_PERF_TIMING:-0}
+# Allocations and RSS do not vary between runs; timing takes the best of three
+PERF_RUNS=1
+[ "$timing" = 1 ] || [ "${REPLAY_UPDATE:-0}" = 1 ] && PERF_RUNS=3
+
+# run_tracker ARGS...: sets wall_ms
+run_tracker() {
+    local start end status
+    start=$(date +%s%N)
+    "$tracker" -r replay.pcap "$@" >tracker.out 2>tracker.err
+    status=$?
+    end=$(date +%s%N)
+    if [ $status -ne 0 ]; then
+        echo "FAIL $name: tcp_tracker exited with $status"
+        tail -20 tracker.err
+        exit 1
+    fi
+    wall_ms=$(( (end - start) / 1000000 ))
+}
+
+if [ "$mode" = golden ]; then
+    run_tracker -d -m metrics.prom "${tracker_args[@]}"
+    sed 's/^\[[^]]*\]//' tcp.log >tcp.normalized
+    sed 's/^\[[^]]*\]//' tls.log >tls.normalized
+    # Gauges and stage latencies vary from run to run, counters do not
+    grep '^tcp_tracker_[a-z_]*_total ' metrics.prom >counters.normalized
+    failed=0
+    for log in tcp tls counters; do
+        golden="$reference/$name.$log.log"
+        if [ "${REPLAY_UPDATE:-0}" = 1 ]; then
+            cp "$log.normalized" "$golden"
+            echo "Updated $golden"
+        elif ! diff -u "$golden" "$log.normalized" >"$log.diff"; then
+            echo "FAIL $name: $log differs from $golden"
+            head -40 "$log.diff"
+            failed=1
+        fi
+    done
+    exit $failed
+fi
+
+best_ms=
+for _ in $(seq $PERF_RUNS); do
+    run_tracker
+    if [ -z "$best_ms" ] || [ $wall_ms -lt $best_ms ]; then
+        best_ms=$wall_ms
+    fi
+done
+wall_ms=$best_ms
+[ $wall_ms -gt 0 ] || wall_ms=1
+pps=$(( packets * 1000 / wall_ms ))
+read -r allocations rss_kb < <(sed -n 's/^replay_stats allocations=\([0-9]*\) peak_rss_kb=\([0-9]*\)$/\1 \2/p' tracker.err)
+if [ -z "${allocations:-}" ]; then
+    echo "FAIL $name: no replay_stats line from the tracker"
+    exit 1
+fi
+echo "$name: packets=$packets wall_ms=$wall_ms packets_per_s=$pps peak_rss_kb=$rss_kb allocations=$allocations"
+
+if [ "${REPLAY_UPDATE:-0}" = 1 ]; then
+    grep -v "^$name " "$reference" >baseline.new 2>/dev/null
+    echo "$name $wall_ms $pps $rss_kb $allocations" >>baseline.new
+    cp baseline.new "$reference"
+    echo "Updated $reference"
+    exit 0
+fi
+
+read -r _ base_wall base_pps base_rss base_allocs < <(grep "^$name " "$reference")
+if [ -z "${base_wall:-}" ]; then
+    echo "FAIL $name: no baseline in $reference; run with REPLAY_UPDATE=1"
+    exit 1
+fi
+
+failed=0
+# grows METRIC VALUE BASELINE: fails if VALUE exceeds BASELINE by more than tolerance
+grows() {
+    if [ $(( $2 * 100 )) -gt $(( $3 * (100 + tolerance) )) ]; then
+        echo "FAIL $name: $1 $2 exceeds baseline $3 by more than $tolerance%"
+        failed=1
+    fi
+}
+grows peak_rss_kb "$rss_kb" "$base_rss"
+grows allocations "$allocations" "$base_allocs"
+if [ "$timing" = 1 ]; then
+    grows wall_ms "$wall_ms" "$base_wall"
+    if [ $(( pps * 100 )) -lt $(( base_pps * (100 - tolerance) )) ]; then
+        echo "FAIL $name: packets_per_s $pps below baseline $base_pps by more than $tolerance%"
+        failed=1
+    fi
+fi
+exit $failed
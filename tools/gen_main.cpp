@@ -0,0 +1,129 @@
+#include "traffic_gen.hpp"
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+namespace {
+
+void print_usage(const char* program) {
+    std::cerr << "Usage: " << program << " -o FILE [options]\n"
+        "  -s SEED            Workload seed (1)\n"
+        "  -n FLOWS           Total connections (1000)\n"
+        "  -c CONCURRENT      Connections open at once, at most (100)\n"
+        "  -r RATE            New connections per second (1000)\n"
+        "  -q REQUESTS        Request/response pairs per connection (1)\n"
+        "  --request MIN:MAX  Request payload bytes (64:512)\n"
+        "  --response MIN:MAX Response payload bytes (256:16384)\n"
+        "  --mix T12,T13,HTTP Weights of TLS 1.2, TLS 1.3 and HTTP connections (40,40,20)\n"
+        "  --loss P --reorder P --dup P --overlap P\n"
+        "                     Percent of data segments dropped, swapped with the next,\n"
+        "                     sent twice or resent with the previous segment's tail (0)\n"
+        "  --rst P            Percent of connections ended by a server RST (0)\n"
+        "  --half-open P      Percent of connections never completing the handshake (0)\n"
+        "  --early-server P   Percent of TLS connections whose first server record header\n"
+        "                     is captured ahead of the ClientHello (0)\n"
+        "  --early-data P     Percent of TLS 1.3 connections resumed with 0-RTT data,\n"
+        "                     some of it sent after the server flight (0)\n"
+        "  --skip N           Leave out the first N packets, as a capture started\n"
+        "                     mid-traffic does (0)"
+        << std::endl;
+}
+
+bool parse_range(const char* text, size_t& min, size_t& max) {
+    char* end = nullptr;
+    min = std::strtoul(text, &end, 10);
+    if (*end != ':') return false;
+    max = std::strtoul(end + 1, &end, 10);
+    return *end == '\0' && min <= max;
+}
+
+bool parse_mix(const char* text, GenOptions& options) {
+    char* end = nullptr;
+    options.tls12 = std::strtoul(text, &end, 10);
+    if (*end != ',') return false;
+    options.tls13 = std::strtoul(end + 1, &end, 10);
+    if (*end != ',') return false;
+    options.http = std::strtoul(end + 1, &end, 10);
+    return *end == '\0';
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    GenOptions options;
+    std::string output;
+
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (!value) {
+            print_usage(argv[0]);
+            return 1;
+        }
+        ++i;
+        bool ok = true;
+        if (strcmp(arg, "-o") == 0) {
+            output = value;
+        } else if (strcmp(arg, "-s") == 0) {
+            options.seed = std::strtoull(value, nullptr, 10);
+        } else if (strcmp(arg, "-n") == 0) {
+            options.flows = std::strtoul(value, nullptr, 10);
+        } else if (strcmp(arg, "-c") == 0) {
+            options.concurrency = std::strtoul(value, nullptr, 10);
+        } else if (strcmp(arg, "-r") == 0) {
+            options.rate = std::atof(value);
+        } else if (strcmp(arg, "-q") == 0) {
+            options.requests = std::strtoul(value, nullptr, 10);
+        } else if (strcmp(arg, "--request") == 0) {
+            ok = parse_range(value, options.request_min, options.request_max);
+        } else if (strcmp(arg, "--response") == 0) {
+            ok = parse_range(value, options.response_min, options.response_max);
+        } else if (strcmp(arg, "--mix") == 0) {
+            ok = parse_mix(value, options);
+        } else if (strcmp(arg, "--loss") == 0) {
+            options.loss = std::atof(value);
+        } else if (strcmp(arg, "--reorder") == 0) {
+            options.reorder = std::atof(value);
+        } else if (strcmp(arg, "--dup") == 0) {
+            options.duplicate = std::atof(value);
+        } else if (strcmp(arg, "--overlap") == 0) {
+            options.overlap = std::atof(value);
+        } else if (strcmp(arg, "--rst") == 0) {
+            options.rst = std::atof(value);
+        } else if (strcmp(arg, "--half-open") == 0) {
+            options.half_open = std::atof(value);
+        } else if (strcmp(arg, "--early-server") == 0) {
+            options.early_server = std::atof(value);
+        } else if (strcmp(arg, "--early-data") == 0) {
+            options.early_data = std::atof(value);
+        } else if (strcmp(arg, "--skip") == 0) {
+            options.skip = std::strtoul(value, nullptr, 10);
+        } else {
+            ok = false;
+        }
+        if (!ok) {
+            std::cerr << "Error: bad option " << arg << " " << value << std::endl;
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+    if (output.empty()) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    TrafficGen generator(options);
+    if (!generator.write(output)) {
+        return 1;
+    }
+
+    const GenStats& stats = generator.stats();
+    std::cout << "Wrote " << stats.packets << " packets, " << stats.bytes << " bytes to " << output << "\n"
+              << "Connections: " << stats.flows[0] << " TLS 1.2, " << stats.flows[1] << " TLS 1.3, "
+              << stats.flows[2] << " HTTP; " << stats.rst_flows << " reset, "
+              << stats.half_open_flows << " half-open, " << stats.early_server_flows << " server first, "
+              << stats.early_data_flows << " 0-RTT\n"
+              << "Segments: " << stats.lost << " lost, " << stats.reordered << " reordered, "
+              << stats.duplicated << " duplicated, " << stats.overlapped << " overlapped" << std::endl;
+    return 0;
+}
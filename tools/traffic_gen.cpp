@@ -0,0 +1,642 @@
+#include "traffic_gen.hpp"
+#include "definitions/packet_key.hpp"
+#include "definitions/tls_types.hpp"
+#include <arpa/inet.h>
+#include <netinet/tcp.h>
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <queue>
+
+namespace {
+
+constexpr uint64_t BASE_TIME_S = 1700000000;  // Fixed, so files only depend on the options
+constexpr size_t MSS = 1460;
+constexpr size_t ETHER_HEADER_LEN = 14;
+constexpr size_t SYN_OPTIONS_LEN = 8;         // MSS, NOP, window scale
+constexpr uint64_t SEGMENT_GAP_US = 20;       // Between segments of one flight
+constexpr uint64_t SYN_ACK_RETRY_US = 1000000;
+constexpr size_t CERT_POOL = 8;
+constexpr uint16_t TLS12_VERSION = static_cast<uint16_t>(TLSVersion::TLS_1_2);
+constexpr uint16_t TLS13_VERSION = static_cast<uint16_t>(TLSVersion::TLS_1_3);
+
+struct ScriptPacket {
+    uint64_t time_us;
+    bool from_client;
+    uint8_t flags;
+    uint32_t seq;
+    uint32_t ack;
+    uint32_t offset;  // Into the stream of the sender
+    uint32_t len;
+};
+
+void put16(std::vector<uint8_t>& out, uint16_t value) {
+    out.push_back(static_cast<uint8_t>(value >> 8));
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+void put24(std::vector<uint8_t>& out, uint32_t value) {
+    out.push_back(static_cast<uint8_t>(value >> 16));
+    put16(out, static_cast<uint16_t>(value));
+}
+
+void put_random(std::vector<uint8_t>& out, GenRandom& rng, size_t len) {
+    size_t at = out.size();
+    out.resize(at + len);
+    rng.fill(out.data() + at, len);
+}
+
+void put_handshake(std::vector<uint8_t>& out, TLSHandshakeType type, const std::vector<uint8_t>& body) {
+    out.push_back(static_cast<uint8_t>(type));
+    put24(out, static_cast<uint32_t>(body.size()));
+    out.insert(out.end(), body.begin(), body.end());
+}
+
+// Splits body into records of at most TLS_MAX_RECORD_LEN bytes
+void put_records(std::vector<uint8_t>& out, TLSContentType type, const std::vector<uint8_t>& body) {
+    size_t offset = 0;
+    do {
+        size_t len = std::min(body.size() - offset, TLS_MAX_RECORD_LEN);
+        out.push_back(static_cast<uint8_t>(type));
+        put16(out, TLS12_VERSION);
+        put16(out, static_cast<uint16_t>(len));
+        out.insert(out.end(), body.begin() + offset, body.begin() + offset + len);
+        offset += len;
+    } while (offset < body.size());
+}
+
+void put_opaque_records(std::vector<uint8_t>& out, TLSContentType type, GenRandom& rng, size_t len) {
+    std::vector<uint8_t> body;
+    put_random(body, rng, std::max<size_t>(len, 1));
+    put_records(out, type, body);
+}
+
+void put_change_cipher_spec(std::vector<uint8_t>& out) {
+    put_records(out, TLSContentType::CHANGE_CIPHER_SPEC, {0x01});
+}
+
+std::vector<uint8_t> client_hello(GenRandom& rng, bool tls13, const std::string& host, bool early_data) {
+    std::vector<uint8_t> body;
+    put16(body, TLS12_VERSION);
+    put_random(body, rng, 32);
+    body.push_back(32);  // Session ID, the TLS 1.3 middlebox compatibility form
+    put_random(body, rng, 32);
+    std::vector<uint16_t> suites = tls13 ? std::vector<uint16_t>{0x1301, 0x1302, 0x1303, 0xc02f}
+                                         : std::vector<uint16_t>{0xc02f, 0xc030, 0xcca8, 0x009c};
+    put16(body, static_cast<uint16_t>(suites.size() * 2));
+    for (uint16_t suite : suites) put16(body, suite);
+    body.push_back(1);
+    body.push_back(0);  // null compression
+
+    std::vector<uint8_t> extensions;
+    put16(extensions, 0x0000);  // server_name
+    put16(extensions, static_cast<uint16_t>(host.size() + 5));
+    put16(extensions, static_cast<uint16_t>(host.size() + 3));
+    extensions.push_back(0);    // host_name
+    put16(extensions, static_cast<uint16_t>(host.size()));
+    extensions.insert(extensions.end(), host.begin(), host.end());
+    if (tls13) {
+        put16(extensions, 0x002b);  // supported_versions
+        put16(extensions, 5);
+        extensions.push_back(4);
+        put16(extensions, TLS13_VERSION);
+        put16(extensions, TLS12_VERSION);
+        put16(extensions, 0x0033);  // key_share, one x25519 share
+        put16(extensions, 38);
+        put16(extensions, 36);
+        put16(extensions, 0x001d);
+        put16(extensions, 32);
+        put_random(extensions, rng, 32);
+    }
+    if (early_data) {
+        put16(extensions, 0x002d);  // psk_key_exchange_modes, psk_dhe_ke
+        put16(extensions, 2);
+        extensions.push_back(1);
+        extensions.push_back(1);
+        put16(extensions, 0x002a);  // early_data
+        put16(extensions, 0);
+        put16(extensions, 0x0029);  // pre_shared_key, last; one ticket and its binder
+        put16(extensions, 75);
+        put16(extensions, 38);
+        put16(extensions, 32);
+        put_random(extensions, rng, 32 + 4);  // Ticket, obfuscated_ticket_age
+        put16(extensions, 33);
+        extensions.push_back(32);
+        put_random(extensions, rng, 32);
+    }
+    put16(body, static_cast<uint16_t>(extensions.size()));
+    body.insert(body.end(), extensions.begin(), extensions.end());
+
+    std::vector<uint8_t> message;
+    put_handshake(message, TLSHandshakeType::CLIENT_HELLO, body);
+    return message;
+}
+
+std::vector<uint8_t> server_hello(GenRandom& rng, bool tls13, bool psk) {
+    std::vector<uint8_t> body;
+    put16(body, TLS12_VERSION);
+    put_random(body, rng, 32);
+    body.push_back(32);
+    put_random(body, rng, 32);
+    put16(body, tls13 ? 0x1301 : 0xc02f);
+    body.push_back(0);
+
+    std::vector<uint8_t> extensions;
+    if (tls13) {
+        put16(extensions, 0x002b);
+        put16(extensions, 2);
+        put16(extensions, TLS13_VERSION);
+        put16(extensions, 0x0033);
+        put16(extensions, 36);
+        put16(extensions, 0x001d);
+        put16(extensions, 32);
+        put_random(extensions, rng, 32);
+        if (psk) {
+            put16(extensions, 0x0029);  // pre_shared_key, selected_identity 0
+            put16(extensions, 2);
+            put16(extensions, 0);
+        }
+    } else {
+        put16(extensions, 0x0017);  // extended_master_secret
+        put16(extensions, 0);
+    }
+    put16(body, static_cast<uint16_t>(extensions.size()));
+    body.insert(body.end(), extensions.begin(), extensions.end());
+
+    std::vector<uint8_t> message;
+    put_handshake(message, TLSHandshakeType::SERVER_HELLO, body);
+    return message;
+}
+
+// DER-shaped but undecodable certificates; a small pool so the
+// certificate cache sees repeats
+const std::vector<uint8_t>& pool_certificate(uint64_t seed, size_t index) {
+    static std::vector<std::vector<uint8_t>> pool;
+    if (pool.empty()) {
+        GenRandom rng(seed ^ 0xce27);
+        for (size_t i = 0; i < CERT_POOL; ++i) {
+            size_t len = rng.uniform(600, 1400);
+            std::vector<uint8_t> cert = {0x30, 0x82, static_cast<uint8_t>(len >> 8), static_cast<uint8_t>(len)};
+            put_random(cert, rng, len);
+            pool.push_back(std::move(cert));
+        }
+    }
+    return pool[index % CERT_POOL];
+}
+
+// Builds the packets of one connection in time order
+class FlowScripter {
+public:
+    FlowScripter(const GenOptions& options, GenStats& stats, GenRandom& rng, uint64_t start_us,
+                 std::vector<uint8_t> (&streams)[2], std::vector<ScriptPacket>& packets)
+        : options_(options), stats_(stats), rng_(rng), time_us_(start_us), streams_(streams), packets_(packets) {
+        isn_[0] = static_cast<uint32_t>(rng_.next());
+        isn_[1] = static_cast<uint32_t>(rng_.next());
+        rtt_us_ = rng_.uniform(2000, 40000);
+    }
+
+    void handshake() {
+        control(true, TH_SYN);
+        wait_half_rtt();
+        control(false, TH_SYN | TH_ACK);
+        wait_half_rtt();
+        control(true, TH_ACK);
+    }
+
+    // Server answers, the client never completes the handshake
+    void half_open() {
+        control(true, TH_SYN);
+        wait_half_rtt();
+        control(false, TH_SYN | TH_ACK);
+        time_us_ += SYN_ACK_RETRY_US;
+        control(false, TH_SYN | TH_ACK);
+    }
+
+    // One flight of application bytes, acknowledged by the peer
+    void flight(bool from_client, const std::vector<uint8_t>& data) {
+        send(from_client, data);
+        wait_half_rtt();
+        control(!from_client, TH_ACK);
+    }
+
+    void close() {
+        control(true, TH_FIN | TH_ACK);
+        fin_[0] = true;
+        wait_half_rtt();
+        control(false, TH_FIN | TH_ACK);
+        fin_[1] = true;
+        wait_half_rtt();
+        control(true, TH_ACK);
+    }
+
+    void reset() {
+        control(false, TH_RST | TH_ACK);
+    }
+
+    // Moves the first len bytes of the sender's stream, at packet index
+    // from, into a segment of their own captured just before packet index
+    // to. False when that segment was lost or is too short.
+    bool capture_early(size_t from, size_t to, uint32_t len) {
+        if (to >= from || from >= packets_.size()) return false;
+        ScriptPacket head = packets_[from];
+        if (head.offset != 0 || head.len <= len) return false;
+        head.len = len;
+        head.time_us = packets_[to].time_us;
+        head.ack = packets_[to].seq;  // Nothing of the peer's flight acknowledged yet
+        packets_[from].seq += len;
+        packets_[from].offset += len;
+        packets_[from].len -= len;
+        packets_.insert(packets_.begin() + to, head);
+        return true;
+    }
+
+    size_t packet_count() const { return packets_.size(); }
+
+    void wait_half_rtt() { time_us_ += rtt_us_ / 2; }
+
+private:
+    struct Segment {
+        uint32_t offset;
+        uint32_t len;
+    };
+
+    uint32_t next_seq(int side) const {
+        return isn_[side] + 1 + static_cast<uint32_t>(streams_[side].size()) + (fin_[side] ? 1 : 0);
+    }
+
+    void control(bool from_client, uint8_t flags) {
+        int side = from_client ? 0 : 1;
+        bool syn = flags & TH_SYN;
+        uint32_t seq = syn ? isn_[side] : next_seq(side);
+        uint32_t ack = (flags & TH_ACK) ? next_seq(1 - side) : 0;
+        packets_.push_back({time_us_, from_client, flags, seq, ack, 0, 0});
+        time_us_ += SEGMENT_GAP_US;
+    }
+
+    void send(bool from_client, const std::vector<uint8_t>& data) {
+        int side = from_client ? 0 : 1;
+        auto& stream = streams_[side];
+        uint32_t base = static_cast<uint32_t>(stream.size());
+        stream.insert(stream.end(), data.begin(), data.end());
+
+        std::vector<Segment> segments;
+        for (uint32_t offset = 0; offset < data.size(); offset += MSS) {
+            segments.push_back({base + offset, static_cast<uint32_t>(std::min<size_t>(MSS, data.size() - offset))});
+        }
+
+        std::vector<Segment> sent;
+        for (size_t i = 0; i < segments.size(); ++i) {
+            Segment segment = segments[i];
+            if (rng_.chance(options_.loss)) {
+                ++stats_.lost;
+                continue;
+            }
+            if (i > 0 && rng_.chance(options_.overlap)) {
+                // Resent together with the tail of the previous segment
+                uint32_t back = static_cast<uint32_t>(rng_.uniform(1, segments[i - 1].len));
+                segment.offset -= back;
+                segment.len += back;
+                ++stats_.overlapped;
+            }
+            sent.push_back(segment);
+            if (rng_.chance(options_.duplicate)) {
+                sent.push_back(segment);
+                ++stats_.duplicated;
+            }
+        }
+        for (size_t i = 0; i + 1 < sent.size(); ++i) {
+            if (rng_.chance(options_.reorder)) {
+                std::swap(sent[i], sent[i + 1]);
+                ++stats_.reordered;
+                ++i;
+            }
+        }
+
+        uint32_t ack = next_seq(1 - side);
+        for (const auto& segment : sent) {
+            packets_.push_back({time_us_, from_client, static_cast<uint8_t>(TH_ACK | TH_PUSH),
+                                isn_[side] + 1 + segment.offset, ack, segment.offset, segment.len});
+            time_us_ += SEGMENT_GAP_US;
+        }
+    }
+
+    const GenOptions& options_;
+    GenStats& stats_;
+    GenRandom& rng_;
+    uint64_t time_us_;
+    uint64_t rtt_us_;
+    uint32_t isn_[2];
+    bool fin_[2] = {false, false};
+    std::vector<uint8_t> (&streams_)[2];
+    std::vector<ScriptPacket>& packets_;
+};
+
+std::vector<uint8_t> http_request(GenRandom& rng, size_t size, const std::string& host) {
+    std::string head = "GET /object/" + std::to_string(rng.uniform(1, 99999)) + " HTTP/1.1\r\n"
+                       "Host: " + host + "\r\n"
+                       "User-Agent: tcp_tracker_gen\r\n";
+    // Padding header brings the request to size
+    std::string pad = "X-Pad: ";
+    size_t fixed = head.size() + pad.size() + 4;
+    pad.append(size > fixed ? size - fixed : 1, 'p');
+    std::string request = head + pad + "\r\n\r\n";
+    return std::vector<uint8_t>(request.begin(), request.end());
+}
+
+std::vector<uint8_t> http_response(GenRandom& rng, size_t size) {
+    std::string head = "HTTP/1.1 200 OK\r\nContent-Type: application/octet-stream\r\nContent-Length: ";
+    size_t body_len = size > head.size() + 16 ? size - head.size() - 16 : 1;
+    head += std::to_string(body_len) + "\r\n\r\n";
+    std::vector<uint8_t> response(head.begin(), head.end());
+    put_random(response, rng, body_len);
+    return response;
+}
+
+uint16_t checksum(const uint8_t* data, size_t len, uint32_t sum = 0) {
+    for (size_t i = 0; i + 1 < len; i += 2) {
+        sum += (data[i] << 8) | data[i + 1];
+    }
+    if (len & 1) sum += data[len - 1] << 8;
+    while (sum >> 16) sum = (sum & 0xffff) + (sum >> 16);
+    return static_cast<uint16_t>(~sum);
+}
+
+} // namespace
+
+struct TrafficGen::Flow {
+    size_t index;
+    GenApp app;
+    uint32_t client_ip;
+    uint32_t server_ip;
+    uint16_t client_port;
+    uint16_t server_port;
+    std::vector<uint8_t> streams[2];  // Client, server application bytes
+    std::vector<ScriptPacket> packets;
+    size_t next = 0;
+};
+
+std::unique_ptr<TrafficGen::Flow> TrafficGen::script_flow(size_t index, uint64_t start_us) {
+    GenRandom rng(options_.seed * 0x100000001b3ULL + index);
+    auto flow = std::make_unique<Flow>();
+    flow->index = index;
+
+    unsigned total = options_.tls12 + options_.tls13 + options_.http;
+    uint64_t pick = rng.uniform(0, total - 1);
+    flow->app = pick < options_.tls12 ? GenApp::TLS12
+              : pick < options_.tls12 + options_.tls13 ? GenApp::TLS13 : GenApp::HTTP;
+    ++stats_.flows[static_cast<size_t>(flow->app)];
+
+    flow->client_ip = 0x0a000000 | static_cast<uint32_t>(1 + index % 0xfffffe);  // 10.0.0.0/8
+    flow->server_ip = 0xc0a80001 + static_cast<uint32_t>(rng.uniform(0, 15));     // 192.168.0.1-16
+    flow->client_port = static_cast<uint16_t>(rng.uniform(32768, 60999));
+    flow->server_port = flow->app == GenApp::HTTP ? 80 : 443;
+    std::string host = "host" + std::to_string(flow->server_ip & 0xff) + ".example";
+
+    FlowScripter script(options_, stats_, rng, start_us, flow->streams, flow->packets);
+    if (rng.chance(options_.half_open)) {
+        ++stats_.half_open_flows;
+        script.half_open();
+        return flow;
+    }
+    script.handshake();
+
+    bool tls = flow->app != GenApp::HTTP;
+    if (tls) {
+        bool tls13 = flow->app == GenApp::TLS13;
+        bool early_server = rng.chance(options_.early_server);
+        bool early_data = tls13 && rng.chance(options_.early_data);
+        size_t client_hello_packet = script.packet_count();
+        std::vector<uint8_t> data;
+        put_records(data, TLSContentType::HANDSHAKE, client_hello(rng, tls13, host, early_data));
+        if (early_data) {
+            // The first 0-RTT records go right behind the ClientHello
+            ++stats_.early_data_flows;
+            put_change_cipher_spec(data);
+            put_opaque_records(data, TLSContentType::APPLICATION_DATA, rng,
+                               rng.uniform(options_.request_min, options_.request_max));
+        }
+        script.flight(true, data);
+        size_t server_hello_packet = script.packet_count();
+
+        data.clear();
+        if (tls13) {
+            // ServerHello, then EncryptedExtensions..Finished as opaque records
+            put_records(data, TLSContentType::HANDSHAKE, server_hello(rng, true, early_data));
+            put_change_cipher_spec(data);
+            put_opaque_records(data, TLSContentType::APPLICATION_DATA, rng, rng.uniform(1500, 5000));
+            script.flight(false, data);
+            data.clear();
+            if (early_data) {
+                // More 0-RTT data behind the server flight, then EndOfEarlyData
+                put_opaque_records(data, TLSContentType::APPLICATION_DATA, rng,
+                                   rng.uniform(options_.request_min, options_.request_max));
+                put_opaque_records(data, TLSContentType::APPLICATION_DATA, rng, 21);
+            } else {
+                put_change_cipher_spec(data);
+            }
+            put_opaque_records(data, TLSContentType::APPLICATION_DATA, rng, 53);  // Finished
+            script.flight(true, data);
+        } else {
+            std::vector<uint8_t> messages = server_hello(rng, false, false);
+            // Leaf by server, one shared intermediate
+            std::vector<uint8_t> chain;
+            for (size_t cert : {static_cast<size_t>(flow->server_ip & 0xf), CERT_POOL - 1}) {
+                const auto& der = pool_certificate(options_.seed, cert);
+                put24(chain, static_cast<uint32_t>(der.size()));
+                chain.insert(chain.end(), der.begin(), der.end());
+            }
+            std::vector<uint8_t> certificates;
+            put24(certificates, static_cast<uint32_t>(chain.size()));
+            certificates.insert(certificates.end(), chain.begin(), chain.end());
+            put_handshake(messages, TLSHandshakeType::CERTIFICATE, certificates);
+            std::vector<uint8_t> key_exchange = {0x03, 0x00, 0x1d, 0x20};  // named_curve x25519
+            put_random(key_exchange, rng, 32);
+            put16(key_exchange, 0x0401);
+            put16(key_exchange, 256);
+            put_random(key_exchange, rng, 256);
+            put_handshake(messages, TLSHandshakeType::SERVER_KEY_EXCHANGE, key_exchange);
+            put_handshake(messages, TLSHandshakeType::SERVER_HELLO_DONE, {});
+            put_records(data, TLSContentType::HANDSHAKE, messages);
+            script.flight(false, data);
+
+            data.clear();
+            std::vector<uint8_t> client_key = {0x20};
+            put_random(client_key, rng, 32);
+            messages.clear();
+            put_handshake(messages, TLSHandshakeType::CLIENT_KEY_EXCHANGE, client_key);
+            put_records(data, TLSContentType::HANDSHAKE, messages);
+            put_change_cipher_spec(data);
+            put_opaque_records(data, TLSContentType::HANDSHAKE, rng, 40);  // Encrypted Finished
+            script.flight(true, data);
+
+            data.clear();
+            put_change_cipher_spec(data);
+            put_opaque_records(data, TLSContentType::HANDSHAKE, rng, 40);
+            script.flight(false, data);
+        }
+        if (early_server && script.capture_early(server_hello_packet, client_hello_packet,
+                                                 TLS_RECORD_HEADER_LEN)) {
+            ++stats_.early_server_flows;
+        }
+    }
+
+    bool rst = rng.chance(options_.rst);
+    size_t rst_after = rst ? rng.uniform(0, options_.requests) : options_.requests;
+    for (size_t i = 0; i < rst_after; ++i) {
+        size_t request = rng.uniform(options_.request_min, options_.request_max);
+        size_t response = rng.uniform(options_.response_min, options_.response_max);
+        std::vector<uint8_t> data;
+        if (tls) {
+            put_opaque_records(data, TLSContentType::APPLICATION_DATA, rng, request);
+        } else {
+            data = http_request(rng, request, host);
+        }
+        script.flight(true, data);
+
+        data.clear();
+        if (tls) {
+            put_opaque_records(data, TLSContentType::APPLICATION_DATA, rng, response);
+        } else {
+            data = http_response(rng, response);
+        }
+        script.flight(false, data);
+        script.wait_half_rtt();
+    }
+
+    if (rst) {
+        ++stats_.rst_flows;
+        script.reset();
+    } else {
+        script.close();
+    }
+    return flow;
+}
+
+void TrafficGen::emit(pcap_dumper_t* dumper, const Flow& flow, size_t index) {
+    const ScriptPacket& packet = flow.packets[index];
+    bool syn = packet.flags & TH_SYN;
+    size_t tcp_len = sizeof(TCPHeader) + (syn ? SYN_OPTIONS_LEN : 0);
+    size_t ip_len = sizeof(IPHeader) + tcp_len + packet.len;
+    frame_.assign(ETHER_HEADER_LEN + ip_len, 0);
+
+    uint8_t* ether = frame_.data();
+    static const uint8_t client_mac[6] = {0x02, 0, 0, 0, 0, 0x01};
+    static const uint8_t server_mac[6] = {0x02, 0, 0, 0, 0, 0x02};
+    std::memcpy(ether, packet.from_client ? server_mac : client_mac, 6);
+    std::memcpy(ether + 6, packet.from_client ? client_mac : server_mac, 6);
+    ether[12] = 0x08;  // IPv4
+
+    auto* ip = reinterpret_cast<IPHeader*>(ether + ETHER_HEADER_LEN);
+    ip->iph_ver = 4;
+    ip->iph_ihl = sizeof(IPHeader) / 4;
+    ip->iph_len = htons(static_cast<uint16_t>(ip_len));
+    ip->iph_ident = htons(static_cast<uint16_t>(index));
+    ip->iph_ttl = 64;
+    ip->iph_protocol = IPPROTO_TCP;
+    ip->iph_source = htonl(packet.from_client ? flow.client_ip : flow.server_ip);
+    ip->iph_dest = htonl(packet.from_client ? flow.server_ip : flow.client_ip);
+    ip->iph_chksum = htons(checksum(reinterpret_cast<uint8_t*>(ip), sizeof(IPHeader)));
+
+    auto* tcp = reinterpret_cast<TCPHeader*>(ether + ETHER_HEADER_LEN + sizeof(IPHeader));
+    tcp->th_sport = htons(packet.from_client ? flow.client_port : flow.server_port);
+    tcp->th_dport = htons(packet.from_client ? flow.server_port : flow.client_port);
+    tcp->th_seq = htonl(packet.seq);
+    tcp->th_ack = htonl(packet.ack);
+    tcp->th_off = static_cast<uint8_t>(tcp_len / 4);
+    tcp->th_flags = packet.flags;
+    tcp->th_win = htons(syn ? 65535 : 2048);
+    uint8_t* options = reinterpret_cast<uint8_t*>(tcp) + sizeof(TCPHeader);
+    if (syn) {
+        const uint8_t syn_options[SYN_OPTIONS_LEN] = {2, 4, MSS >> 8, MSS & 0xff, 1, 3, 3, 7};
+        std::memcpy(options, syn_options, SYN_OPTIONS_LEN);
+    }
+    if (packet.len > 0) {
+        const auto& stream = flow.streams[packet.from_client ? 0 : 1];
+        std::memcpy(options + (syn ? SYN_OPTIONS_LEN : 0), stream.data() + packet.offset, packet.len);
+    }
+
+    // Pseudo header sum, then the segment
+    uint32_t sum = (flow.client_ip >> 16) + (flow.client_ip & 0xffff) +
+                   (flow.server_ip >> 16) + (flow.server_ip & 0xffff) +
+                   IPPROTO_TCP + static_cast<uint32_t>(tcp_len + packet.len);
+    tcp->th_sum = htons(checksum(reinterpret_cast<uint8_t*>(tcp), tcp_len + packet.len, sum));
+
+    pcap_pkthdr header{};
+    header.ts.tv_sec = static_cast<time_t>(BASE_TIME_S + packet.time_us / 1000000);
+    header.ts.tv_usec = static_cast<suseconds_t>(packet.time_us % 1000000);
+    header.caplen = header.len = static_cast<bpf_u_int32>(frame_.size());
+    pcap_dump(reinterpret_cast<u_char*>(dumper), &header, frame_.data());
+    ++stats_.packets;
+    stats_.bytes += frame_.size();
+}
+
+bool TrafficGen::write(const std::string& path) {
+    if (options_.tls12 + options_.tls13 + options_.http == 0 || options_.concurrency == 0 ||
+        options_.rate <= 0 || options_.request_min > options_.request_max ||
+        options_.response_min > options_.response_max) {
+        std::cerr << "Invalid workload options" << std::endl;
+        return false;
+    }
+
+    pcap_t* dead = pcap_open_dead(DLT_EN10MB, 65535);
+    pcap_dumper_t* dumper = dead ? pcap_dump_open(dead, path.c_str()) : nullptr;
+    if (!dumper) {
+        std::cerr << "Failed to open " << path << (dead ? ": " + std::string(pcap_geterr(dead)) : "") << std::endl;
+        if (dead) pcap_close(dead);
+        return false;
+    }
+
+    // Earliest pending packet first; the slot breaks ties so the order
+    // never depends on the heap implementation
+    using Pending = std::pair<uint64_t, size_t>;
+    std::priority_queue<Pending, std::vector<Pending>, std::greater<Pending>> pending;
+    std::vector<std::unique_ptr<Flow>> active;  // By slot
+    std::vector<size_t> free_slots;
+    size_t started = 0;
+    size_t open = 0;
+    size_t skipped = 0;
+    uint64_t now_us = 0;
+
+    while (started < options_.flows || !pending.empty()) {
+        uint64_t scheduled = static_cast<uint64_t>(started * 1e6 / options_.rate);
+        uint64_t start_us = std::max(scheduled, now_us);
+        bool can_start = started < options_.flows && open < options_.concurrency;
+        if (can_start && (pending.empty() || start_us <= pending.top().first)) {
+            auto flow = script_flow(started++, start_us);
+            size_t slot;
+            if (free_slots.empty()) {
+                slot = active.size();
+                active.push_back(nullptr);
+            } else {
+                slot = free_slots.back();
+                free_slots.pop_back();
+            }
+            pending.push({flow->packets.front().time_us, slot});
+            active[slot] = std::move(flow);
+            ++open;
+            continue;
+        }
+
+        auto [time_us, slot] = pending.top();
+        pending.pop();
+        now_us = time_us;
+        Flow& flow = *active[slot];
+        size_t index = flow.next++;
+        if (skipped < options_.skip) {
+            ++skipped;
+        } else {
+            emit(dumper, flow, index);
+        }
+        if (flow.next < flow.packets.size()) {
+            pending.push({flow.packets[flow.next].time_us, slot});
+        } else {
+            active[slot].reset();
+            free_slots.push_back(slot);
+            --open;
+        }
+    }
+
+    pcap_dump_close(dumper);
+    pcap_close(dead);
+    return true;
+}
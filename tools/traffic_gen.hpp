@@ -0,0 +1,93 @@
+#ifndef TRAFFIC_GEN_HPP
+#define TRAFFIC_GEN_HPP
+
+#include <pcap.h>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Workload of tcp_tracker_gen. Percentages are 0..100.
+struct GenOptions {
+    uint64_t seed = 1;
+    size_t flows = 1000;             // Total connections
+    size_t concurrency = 100;        // Connections open at once, at most
+    double rate = 1000.0;            // New connections per second
+    size_t requests = 1;             // Request/response pairs per connection
+    size_t request_min = 64, request_max = 512;      // Application payload bytes
+    size_t response_min = 256, response_max = 16384;
+    // Application mix, relative weights
+    unsigned tls12 = 40, tls13 = 40, http = 20;
+    // Per data segment
+    double loss = 0, reorder = 0, duplicate = 0, overlap = 0;
+    // Per connection
+    double rst = 0, half_open = 0;
+    // Per TLS connection: the server's first record header is captured
+    // ahead of the ClientHello, as a capture merged from two taps can be
+    double early_server = 0;
+    // Per TLS 1.3 connection: resumed with 0-RTT data, part of it still
+    // arriving after the server's flight has begun
+    double early_data = 0;
+    // Packets left out at the start, as by a capture started mid-traffic
+    size_t skip = 0;
+};
+
+// Counts of what was written
+struct GenStats {
+    uint64_t packets = 0;
+    uint64_t bytes = 0;
+    uint64_t flows[3] = {};  // GenApp
+    uint64_t rst_flows = 0;
+    uint64_t half_open_flows = 0;
+    uint64_t early_server_flows = 0;
+    uint64_t early_data_flows = 0;
+    uint64_t lost = 0, reordered = 0, duplicated = 0, overlapped = 0;
+};
+
+// splitmix64; the same seed gives the same stream on every platform,
+// unlike the <random> distributions
+class GenRandom {
+public:
+    explicit GenRandom(uint64_t seed) : state_(seed) {}
+
+    uint64_t next() {
+        uint64_t z = (state_ += 0x9e3779b97f4a7c15ULL);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+    // Inclusive range
+    uint64_t uniform(uint64_t lo, uint64_t hi) { return lo + next() % (hi - lo + 1); }
+    bool chance(double percent) { return percent > 0 && (next() % 1000000) < percent * 10000; }
+    void fill(uint8_t* data, size_t len) {
+        for (size_t i = 0; i < len; ++i) data[i] = static_cast<uint8_t>(next());
+    }
+
+private:
+    uint64_t state_;
+};
+
+enum class GenApp : uint8_t { TLS12, TLS13, HTTP };
+
+// Writes seeded synthetic TCP traffic to a pcap file. Each connection is
+// scripted on its own random stream derived from the seed and its index,
+// then connections are interleaved in timestamp order.
+class TrafficGen {
+public:
+    explicit TrafficGen(const GenOptions& options) : options_(options) {}
+
+    bool write(const std::string& path);
+    const GenStats& stats() const { return stats_; }
+
+private:
+    struct Flow;
+
+    std::unique_ptr<Flow> script_flow(size_t index, uint64_t start_us);
+    void emit(pcap_dumper_t* dumper, const Flow& flow, size_t packet);
+
+    GenOptions options_;
+    GenStats stats_;
+    std::vector<uint8_t> frame_;
+};
+
+#endif // TRAFFIC_GEN_HPP